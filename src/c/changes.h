@@ -0,0 +1,23 @@
+#pragma once
+#include <pebble.h>
+
+/*
+ * Flags describing which inputs of the screen changed since the last update.
+ * Each layer compares them against the inputs it depends on, so that a tick
+ * only marks dirty the layers whose content actually changed
+ */
+typedef enum {
+  CHANGED_NONE      = 0,
+  CHANGED_HOURS     = 1 << 0,
+  CHANGED_MINUTES   = 1 << 1,
+  CHANGED_SECONDS   = 1 << 2,
+  CHANGED_DAY       = 1 << 3,
+  CHANGED_WEEK      = 1 << 4,
+  CHANGED_BEATS     = 1 << 5,
+  CHANGED_ALT_CLOCK = 1 << 6,
+  CHANGED_HEALTH    = 1 << 7,
+  CHANGED_BATTERY   = 1 << 8,
+  CHANGED_BLUETOOTH = 1 << 9,
+  CHANGED_WEATHER   = 1 << 10,
+  CHANGED_ALL       = 0xFFFF
+} ChangeMask;
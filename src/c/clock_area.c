@@ -2,37 +2,138 @@
 #include <pebble-fctx/fctx.h>
 #include <pebble-fctx/ffont.h>
 #include "clock_area.h"
+#include "glyph_cache.h"
+#include "glyph_sprites.h"
 #include "settings.h"
 #include "time_date.h"
+#include "profiling.h"
 
 #define ROUND_VERTICAL_PADDING 15
 
+// uncomment to blit the clock digits from sprites rasterized once per size
+// and color, instead of filling their outlines on every redraw
+// #define CLOCK_AREA_SPRITES
+
 static Layer* clock_area_layer;
 
+// a clock font, with its pre-scaled outlines and sprites
+typedef struct {
+  FFont* ffont;
+  GlyphCache* glyphs;
+#ifdef CLOCK_AREA_SPRITES
+  GlyphSprites* sprites;
+#endif
+} ClockFont;
+
 // just allocate all the fonts at startup because i don't feel like
 // dealing with allocating and deallocating things
-static FFont* hours_font;
-static FFont* minutes_font;
-static FFont* colon_font;
+static ClockFont hours_font;
+static ClockFont minutes_font;
+static ClockFont colon_font;
 
 #ifndef PBL_ROUND
 static GFont date_font;
 static GFont am_pm_font;
-#else
-static GRect screen_rect;
 #endif
 
 static uint8_t prev_clockFontId;
 
 // "private" functions
-static void update_original_clock_area_layer(Layer *l, GContext* ctx, FContext* fctx) {
-  // check layer bounds
-  GRect bounds;
 
-  #ifndef PBL_ROUND
-    bounds = layer_get_unobstructed_bounds(l);
-  #else
-    bounds = GRect(0, ROUND_VERTICAL_PADDING, screen_rect.size.w, screen_rect.size.h - ROUND_VERTICAL_PADDING * 2);
+static ClockFont clock_font_create(uint32_t resourceId) {
+  ClockFont font;
+
+  font.ffont = ffont_create_from_resource(resourceId);
+  font.glyphs = GlyphCache_create(resourceId);
+#ifdef CLOCK_AREA_SPRITES
+  font.sprites = GlyphSprites_create(font.glyphs);
+#endif
+
+  return font;
+}
+
+static void clock_font_destroy(ClockFont* font) {
+#ifdef CLOCK_AREA_SPRITES
+  GlyphSprites_destroy(font->sprites);
+#endif
+  GlyphCache_destroy(font->glyphs);
+  ffont_destroy(font->ffont);
+}
+
+// draws the string from sprites or cached outlines when they have its size, with fctx otherwise
+static void draw_string(GContext* ctx, FContext* fctx, FPoint position, const char* text,
+                        ClockFont* font, int font_size, GTextAlignment alignment, FTextAnchor anchor) {
+  // the caches are only resized with the layout, the frames of an animation
+  // of the unobstructed area are drawn at other sizes
+  bool cached = (GlyphCache_get_em_height(font->glyphs) == font_size);
+
+#ifdef CLOCK_AREA_SPRITES
+  if(cached && GlyphSprites_draw_string(font->sprites, ctx, text, position, alignment, anchor)) {
+    return;
+  }
+#endif
+
+  fctx_begin_fill(fctx);
+  fctx_set_offset(fctx, position);
+
+  if(!cached || !GlyphCache_draw_string(font->glyphs, fctx, text, alignment, anchor)) {
+    fctx_set_text_em_height(fctx, font->ffont, font_size);
+    fctx_draw_string(fctx, text, font->ffont, alignment, anchor);
+  }
+
+  fctx_end_fill(fctx);
+}
+
+// a string of the clock, with everything needed to draw it
+typedef struct {
+  const char* text;
+  ClockFont* font;
+  FPoint position;
+  int16_t emHeight;
+  GTextAlignment alignment;
+  FTextAnchor anchor;
+} ClockElement;
+
+// everything the clock area draws, computed when the settings or the
+// unobstructed area change so that redraws don't have to
+typedef struct {
+  bool antialiased;
+
+  // hours, colon and minutes, or the whole time as a single string
+  uint8_t elementCount;
+  ClockElement elements[3];
+
+#ifndef PBL_ROUND
+  GColor textColor;
+
+  // only for the horizontal sidebars
+  bool showDate;
+  GRect dateBox;
+  bool showAmPm;
+  GRect amPmBox;
+#endif
+} ClockLayout;
+
+static ClockLayout clock_layout;
+
+// the time as a single string, when it's centered
+static char centered_time[6];
+
+static void add_element(ClockLayout* layout, const char* text, ClockFont* font, int x, int y,
+                        int16_t em_height, GTextAlignment alignment, FTextAnchor anchor) {
+  ClockElement* element = &layout->elements[layout->elementCount++];
+
+  element->text = text;
+  element->font = font;
+  element->position = FPointI(x, y);
+  element->emHeight = em_height;
+  element->alignment = alignment;
+  element->anchor = anchor;
+}
+
+static void layout_original_clock(ClockLayout* layout, GRect bounds) {
+  #ifdef PBL_ROUND
+    bounds = GRect(0, ROUND_VERTICAL_PADDING, bounds.size.w, bounds.size.h - ROUND_VERTICAL_PADDING * 2);
   #endif
 
   // calculate font size
@@ -49,13 +150,6 @@ static void update_original_clock_area_layer(Layer *l, GContext* ctx, FContext*
     v_padding = bounds.size.h / 20;
     h_adjust = -4;
     v_adjust = 0;
-
-    // leco looks awful with antialiasing
-    #ifdef PBL_COLOR
-      fctx_enable_aa(false);
-  } else {
-      fctx_enable_aa(true);
-    #endif
   }
 
   // if it's a round watch, EVERYTHING CHANGES
@@ -74,31 +168,35 @@ static void update_original_clock_area_layer(Layer *l, GContext* ctx, FContext*
     }
   #endif
 
-  FPoint time_pos;
+  int h_middle = bounds.size.w / 2 + h_adjust;
 
-  // draw hours
-  time_pos.x = INT_TO_FIXED(bounds.size.w / 2 + h_adjust);
-  time_pos.y = INT_TO_FIXED(v_padding + v_adjust);
-  fctx_begin_fill(fctx);
-  fctx_set_offset(fctx, time_pos);
-  fctx_set_text_em_height(fctx, hours_font, font_size);
-  fctx_draw_string(fctx, time_date_hours, hours_font, GTextAlignmentCenter, FTextAnchorTop);
-  fctx_end_fill(fctx);
+  add_element(layout, time_date_hours, &hours_font, h_middle, v_padding + v_adjust,
+              font_size, GTextAlignmentCenter, FTextAnchorTop);
+  add_element(layout, time_date_minutes, &minutes_font, h_middle, bounds.size.h - v_padding + v_adjust,
+              font_size, GTextAlignmentCenter, FTextAnchorBaseline);
+}
 
-  //draw minutes
-  time_pos.y = INT_TO_FIXED(bounds.size.h - v_padding + v_adjust);
-  fctx_begin_fill(fctx);
-  fctx_set_offset(fctx, time_pos);
-  fctx_set_text_em_height(fctx, minutes_font, font_size);
-  fctx_draw_string(fctx, time_date_minutes, minutes_font, GTextAlignmentCenter, FTextAnchorBaseline);
-  fctx_end_fill(fctx);
+// hours, colon and minutes on one line, with a single font or with the fonts of each part
+static void layout_one_line_time(ClockLayout* layout, int h_middle, int h_adjust, int y,
+                                 int16_t font_size, FTextAnchor anchor) {
+  int h_colon_margin = 7;
+
+  if(globalSettings.centerTime == false || globalSettings.clockFontId == FONT_SETTING_BOLD_H || globalSettings.clockFontId == FONT_SETTING_BOLD_M) {
+    add_element(layout, time_date_hours, &hours_font, h_middle - h_colon_margin + h_adjust, y,
+                font_size, GTextAlignmentRight, anchor);
+    add_element(layout, ":", &colon_font, h_middle - 1, y,
+                font_size, GTextAlignmentCenter, anchor);
+    add_element(layout, time_date_minutes, &minutes_font, h_middle + h_colon_margin + h_adjust, y,
+                font_size, GTextAlignmentLeft, anchor);
+  } else {
+    // if only one font center all
+    add_element(layout, centered_time, &colon_font, h_middle - 2, y,
+                font_size, GTextAlignmentCenter, anchor);
+  }
 }
 
 #ifndef PBL_ROUND
-static void update_clock_and_date_area_layer(Layer *l, GContext* ctx, FContext* fctx) {
-  // check layer bounds
-  GRect fullscreen_bounds = layer_get_bounds(l);
-
+static void layout_clock_and_date(ClockLayout* layout, GRect fullscreen_bounds, GRect unobstructed_bounds) {
   // calculate font size
   int font_size = fullscreen_bounds.size.h / 3;
 
@@ -112,20 +210,12 @@ static void update_clock_and_date_area_layer(Layer *l, GContext* ctx, FContext*
     v_padding = fullscreen_bounds.size.h / 20;
     h_adjust = -3;
     v_adjust = 0;
-
-    // leco looks awful with antialiasing
-    #ifdef PBL_COLOR
-      fctx_enable_aa(false);
-  } else {
-      fctx_enable_aa(true);
-    #endif
   }
 
   // for rectangular watches, adjust X position based on sidebar position
   if(globalSettings.sidebarLocation == BOTTOM) {
     v_adjust -= 3;
   } else {
-    GRect unobstructed_bounds = layer_get_unobstructed_bounds(l);
     int16_t obstruction_height = fullscreen_bounds.size.h - unobstructed_bounds.size.h;
     v_adjust += FIXED_WIDGET_HEIGHT - obstruction_height - 3;
   }
@@ -133,186 +223,146 @@ static void update_clock_and_date_area_layer(Layer *l, GContext* ctx, FContext*
   int h_middle = fullscreen_bounds.size.w / 2;
   int h_colon_margin = 7;
 
-  FPoint time_pos;
+  layout->showAmPm = !clock_is_24h_style();
+  layout->amPmBox = GRect(0, v_padding / 2 + v_adjust, fullscreen_bounds.size.w - h_colon_margin + h_adjust, 20);
 
-#ifndef PBL_COLOR
-  if(globalSettings.timeColor.argb == GColorLightGrayARGB8 && globalSettings.timeBgColor.argb == GColorWhiteARGB8) {
-    graphics_context_set_text_color(ctx, GColorBlack);
-  } else {
-#endif
-    graphics_context_set_text_color(ctx, globalSettings.timeColor);
-#ifndef PBL_COLOR
+  layout_one_line_time(layout, h_middle, h_adjust, 3 * v_padding + v_adjust, font_size, FTextAnchorTop);
+
+  layout->showDate = true;
+  layout->dateBox = GRect(0, fullscreen_bounds.size.h / 2 - 11 + v_adjust, fullscreen_bounds.size.w, 30);
+}
+
+#else
+
+static void layout_one_line_clock(ClockLayout* layout, GRect fullscreen_bounds) {
+  // calculate font size
+  int font_size = fullscreen_bounds.size.h / 3 + 7;
+
+  // avenir + avenir bold metrics
+  int h_adjust = -2;
+
+  // alternate metrics for LECO
+  if(globalSettings.clockFontId == FONT_SETTING_LECO) {
+    h_adjust = -3;
   }
+
+  layout_one_line_time(layout, fullscreen_bounds.size.w / 2, h_adjust, fullscreen_bounds.size.h / 2,
+                       font_size, FTextAnchorMiddle);
+}
 #endif
 
-  if(!clock_is_24h_style()) {
-    // draw am/pm
-    graphics_draw_text(ctx,
-                       time_date_isAmHour ? "AM" : "PM",
-                       am_pm_font,
-                       GRect(0, v_padding / 2 + v_adjust, fullscreen_bounds.size.w - h_colon_margin + h_adjust, 20),
-                       GTextOverflowModeFill,
-                       GTextAlignmentRight,
-                       NULL);
+static void compute_layout(ClockLayout* layout, GRect fullscreen_bounds, GRect unobstructed_bounds) {
+  memset(layout, 0, sizeof(ClockLayout));
+
+  // leco looks awful with antialiasing
+  layout->antialiased = (globalSettings.clockFontId != FONT_SETTING_LECO);
+
+#ifndef PBL_ROUND
+  layout->textColor = globalSettings.timeColor;
+
+#ifndef PBL_COLOR
+  if(globalSettings.timeColor.argb == GColorLightGrayARGB8 && globalSettings.timeBgColor.argb == GColorWhiteARGB8) {
+    layout->textColor = GColorBlack;
   }
+#endif
+#endif
 
-  if(globalSettings.centerTime == false || globalSettings.clockFontId == FONT_SETTING_BOLD_H || globalSettings.clockFontId == FONT_SETTING_BOLD_M) {
-    // draw hours
-    time_pos.x = INT_TO_FIXED(h_middle - h_colon_margin + h_adjust);
-    time_pos.y = INT_TO_FIXED(3 * v_padding + v_adjust);
-    fctx_begin_fill(fctx);
-    fctx_set_offset(fctx, time_pos);
-    fctx_set_text_em_height(fctx, hours_font, font_size);
-    fctx_draw_string(fctx, time_date_hours, hours_font, GTextAlignmentRight, FTextAnchorTop);
-    fctx_end_fill(fctx);
-
-    //draw ":"
-    time_pos.x = INT_TO_FIXED(h_middle - 1);
-    fctx_begin_fill(fctx);
-    fctx_set_offset(fctx, time_pos);
-    fctx_set_text_em_height(fctx, colon_font, font_size);
-    fctx_draw_string(fctx, ":", colon_font, GTextAlignmentCenter, FTextAnchorTop);
-    fctx_end_fill(fctx);
-
-    //draw minutes
-    time_pos.x = INT_TO_FIXED(h_middle + h_colon_margin + h_adjust);
-    fctx_begin_fill(fctx);
-    fctx_set_offset(fctx, time_pos);
-    fctx_set_text_em_height(fctx, minutes_font, font_size);
-    fctx_draw_string(fctx, time_date_minutes, minutes_font, GTextAlignmentLeft, FTextAnchorTop);
-    fctx_end_fill(fctx);
+  if(globalSettings.sidebarLocation == BOTTOM || globalSettings.sidebarLocation == TOP) {
+#ifdef PBL_ROUND
+    layout_one_line_clock(layout, fullscreen_bounds);
+#else
+    layout_clock_and_date(layout, fullscreen_bounds, unobstructed_bounds);
+#endif // PBL_ROUND
   } else {
-    // if only one font center all
-    char time[6];
-
-    strncpy(time, time_date_hours, sizeof(time_date_hours));
-    strncat(time, ":" , 2);
-    strncat(time, time_date_minutes, sizeof(time_date_minutes));
-
-    time_pos.x = INT_TO_FIXED(h_middle - 2);
-    time_pos.y = INT_TO_FIXED(3 * v_padding + v_adjust);
-    fctx_begin_fill(fctx);
-    fctx_set_offset(fctx, time_pos);
-    fctx_set_text_em_height(fctx, colon_font, font_size);
-    fctx_draw_string(fctx, time, colon_font, GTextAlignmentCenter, FTextAnchorTop);
-    fctx_end_fill(fctx);
+    layout_original_clock(layout, unobstructed_bounds);
   }
+}
 
-  char time_date_currentDate[21];
+// builds the outlines (and drops the sprites) of the fonts at the sizes of the layout
+static void resize_glyphs(const ClockLayout* layout) {
+  for(int i = 0; i < layout->elementCount; i++) {
+    const ClockElement* element = &layout->elements[i];
 
-  strncpy(time_date_currentDate, globalSettings.languageDayNames[time_date_currentDayName], sizeof(globalSettings.languageDayNames[time_date_currentDayName]));
-  strncat(time_date_currentDate, " " , 2);
-  strncat(time_date_currentDate, time_date_currentDayNum, sizeof(time_date_currentDayNum));
-  strncat(time_date_currentDate, " " , 2);
-  strncat(time_date_currentDate, globalSettings.languageMonthNames[time_date_currentMonth], sizeof(globalSettings.languageMonthNames[time_date_currentMonth]));
+    GlyphCache_set_em_height(element->font->glyphs, element->emHeight);
+#ifdef CLOCK_AREA_SPRITES
+    GlyphSprites_set_style(element->font->sprites, element->emHeight, globalSettings.timeColor,
+                           globalSettings.timeBgColor);
+#endif
+  }
+}
 
-  // draw date
+#ifndef PBL_ROUND
+static void draw_date(GContext* ctx) {
   graphics_draw_text(ctx,
                      time_date_currentDate,
                      date_font,
-                     GRect(0, fullscreen_bounds.size.h / 2 - 11 + v_adjust, fullscreen_bounds.size.w, 30),
+                     clock_layout.dateBox,
                      GTextOverflowModeFill,
                      GTextAlignmentCenter,
                      NULL);
 }
+#endif
 
-#else
+static void update_clock_area_layer(Layer *l, GContext* ctx) {
+  // initialize FCTX, the fancy 3rd party drawing library that all the cool kids use
+  FContext fctx;
 
-static void update_one_line_clock_area_layer(Layer *l, GContext* ctx, FContext* fctx) {
-  // check layer bounds
-  GRect fullscreen_bounds = layer_get_bounds(l);
+  Profiling_renderStart(PROFILE_LAYER_CLOCK);
 
-  // calculate font size
-  int font_size = fullscreen_bounds.size.h / 3 + 7;
+  fctx_init_context(&fctx, ctx);
+  fctx_set_fill_color(&fctx, globalSettings.timeColor);
 
-  // avenir + avenir bold metrics
-  int h_adjust = -2;
+#ifdef PBL_COLOR
+  fctx_enable_aa(clock_layout.antialiased);
+#endif
 
-  // alternate metrics for LECO
-  if(globalSettings.clockFontId == FONT_SETTING_LECO) {
-    h_adjust = -3;
+#ifdef CLOCK_AREA_SPRITES
+  // the glyphs missing a sprite (after a change of the layout, or the first
+  // time a digit is shown) are rasterized before anything is drawn over them
+  for(int i = 0; i < clock_layout.elementCount; i++) {
+    ClockElement* element = &clock_layout.elements[i];
 
-    // leco looks awful with antialiasing
-    #ifdef PBL_COLOR
-      fctx_enable_aa(false);
-  } else {
-      fctx_enable_aa(true);
-    #endif
+    if(GlyphCache_get_em_height(element->font->glyphs) == element->emHeight) {
+      GlyphSprites_rasterize_string(element->font->sprites, l, ctx, &fctx, element->text, element->position,
+                                    element->alignment, element->anchor);
+    }
   }
+#endif
 
-  int h_middle = fullscreen_bounds.size.w / 2;
-  int h_colon_margin = 7;
-
-  FPoint time_pos;
+#ifndef PBL_ROUND
+  graphics_context_set_text_color(ctx, clock_layout.textColor);
 
-  if(globalSettings.centerTime == false || globalSettings.clockFontId == FONT_SETTING_BOLD_H || globalSettings.clockFontId == FONT_SETTING_BOLD_M) {
-    // draw hours
-    time_pos.x = INT_TO_FIXED(h_middle - h_colon_margin + h_adjust);
-    time_pos.y = INT_TO_FIXED(fullscreen_bounds.size.h / 2);
-    fctx_begin_fill(fctx);
-    fctx_set_offset(fctx, time_pos);
-    fctx_set_text_em_height(fctx, hours_font, font_size);
-    fctx_draw_string(fctx, time_date_hours, hours_font, GTextAlignmentRight, FTextAnchorMiddle);
-    fctx_end_fill(fctx);
-
-    //draw ":"
-    time_pos.x = INT_TO_FIXED(h_middle - 1);
-    fctx_begin_fill(fctx);
-    fctx_set_offset(fctx, time_pos);
-    fctx_set_text_em_height(fctx, colon_font, font_size);
-    fctx_draw_string(fctx, ":", colon_font, GTextAlignmentCenter, FTextAnchorMiddle);
-    fctx_end_fill(fctx);
-
-    //draw minutes
-    time_pos.x = INT_TO_FIXED(h_middle + h_colon_margin + h_adjust);
-    fctx_begin_fill(fctx);
-    fctx_set_offset(fctx, time_pos);
-    fctx_set_text_em_height(fctx, minutes_font, font_size);
-    fctx_draw_string(fctx, time_date_minutes, minutes_font, GTextAlignmentLeft, FTextAnchorMiddle);
-    fctx_end_fill(fctx);
-  } else {
-    // if only one font center all
-    char time[6];
-
-    strncpy(time, time_date_hours, sizeof(time_date_hours));
-    strncat(time, ":" , 2);
-    strncat(time, time_date_minutes, sizeof(time_date_minutes));
-
-    time_pos.x = INT_TO_FIXED(h_middle - 2);
-    time_pos.y = INT_TO_FIXED(fullscreen_bounds.size.h / 2);
-    fctx_begin_fill(fctx);
-    fctx_set_offset(fctx, time_pos);
-    fctx_set_text_em_height(fctx, colon_font, font_size);
-    fctx_draw_string(fctx, time, colon_font, GTextAlignmentCenter, FTextAnchorMiddle);
-    fctx_end_fill(fctx);
+  if(clock_layout.showAmPm) {
+    graphics_draw_text(ctx,
+                       time_date_isAmHour ? "AM" : "PM",
+                       am_pm_font,
+                       clock_layout.amPmBox,
+                       GTextOverflowModeFill,
+                       GTextAlignmentRight,
+                       NULL);
   }
-}
 #endif
 
-static void update_clock_area_layer(Layer *l, GContext* ctx) {
-  // initialize FCTX, the fancy 3rd party drawing library that all the cool kids use
-  FContext fctx;
+  for(int i = 0; i < clock_layout.elementCount; i++) {
+    ClockElement* element = &clock_layout.elements[i];
 
-  fctx_init_context(&fctx, ctx);
-  fctx_set_fill_color(&fctx, globalSettings.timeColor);
+    draw_string(ctx, &fctx, element->position, element->text, element->font, element->emHeight,
+                element->alignment, element->anchor);
+  }
 
-  if(globalSettings.sidebarLocation == BOTTOM || globalSettings.sidebarLocation == TOP) {
-#ifdef PBL_ROUND
-      update_one_line_clock_area_layer(l, ctx, &fctx);
-#else
-      update_clock_and_date_area_layer(l, ctx, &fctx);
-#endif // PBL_ROUND
-  } else {
-      update_original_clock_area_layer(l, ctx, &fctx);
+#ifndef PBL_ROUND
+  if(clock_layout.showDate) {
+    draw_date(ctx);
   }
+#endif
 
   fctx_deinit_context(&fctx);
+
+  Profiling_renderEnd(PROFILE_LAYER_CLOCK);
 }
 
 void ClockArea_init(Window* window) {
-#ifndef PBL_ROUND
   GRect screen_rect;
-#endif
 
   // record the screen size, since we NEVER GET IT AGAIN
   screen_rect = layer_get_bounds(window_get_root_layer(window));
@@ -329,9 +379,9 @@ void ClockArea_init(Window* window) {
 }
 
 void ClockArea_ffont_destroy(void) {
-  ffont_destroy(hours_font);
+  clock_font_destroy(&hours_font);
   if(prev_clockFontId == FONT_SETTING_BOLD_H || prev_clockFontId == FONT_SETTING_BOLD_M) {
-    ffont_destroy(minutes_font);
+    clock_font_destroy(&minutes_font);
   }
 }
 
@@ -345,6 +395,37 @@ void ClockArea_redraw(void) {
   layer_mark_dirty(clock_area_layer);
 }
 
+void ClockArea_redraw_changes(uint16_t changes) {
+  uint16_t dependencies = CHANGED_HOURS | CHANGED_MINUTES;
+
+  if(changes & (CHANGED_HOURS | CHANGED_MINUTES)) {
+    strncpy(centered_time, time_date_hours, sizeof(time_date_hours));
+    strncat(centered_time, ":" , 2);
+    strncat(centered_time, time_date_minutes, sizeof(time_date_minutes));
+  }
+
+#ifndef PBL_ROUND
+  // the horizontal layout also displays the date
+  if(globalSettings.sidebarLocation == BOTTOM || globalSettings.sidebarLocation == TOP) {
+    dependencies |= CHANGED_DAY;
+  }
+#endif
+
+  if(changes & dependencies) {
+    layer_mark_dirty(clock_area_layer);
+  }
+}
+
+void ClockArea_update_layout(bool animating) {
+  compute_layout(&clock_layout, layer_get_bounds(clock_area_layer), layer_get_unobstructed_bounds(clock_area_layer));
+
+  if(!animating) {
+    resize_glyphs(&clock_layout);
+  }
+
+  layer_mark_dirty(clock_area_layer);
+}
+
 void ClockArea_update_fonts(void) {
 #ifndef PBL_ROUND
   if(globalSettings.sidebarLocation == BOTTOM || globalSettings.sidebarLocation == TOP) {
@@ -360,43 +441,43 @@ void ClockArea_update_fonts(void) {
       ClockArea_ffont_destroy();
     }
 
-    FFont* avenir;
-    FFont* avenir_bold;
-    FFont* leco;
+    ClockFont avenir;
+    ClockFont avenir_bold;
+    ClockFont leco;
 
     switch(globalSettings.clockFontId) {
       case FONT_SETTING_DEFAULT:
-          avenir = ffont_create_from_resource(RESOURCE_ID_AVENIR_REGULAR_FFONT);
+          avenir = clock_font_create(RESOURCE_ID_AVENIR_REGULAR_FFONT);
 
           hours_font = avenir;
           minutes_font = avenir;
           colon_font = avenir;
         break;
       case FONT_SETTING_BOLD:
-          avenir_bold = ffont_create_from_resource(RESOURCE_ID_AVENIR_BOLD_FFONT);
+          avenir_bold = clock_font_create(RESOURCE_ID_AVENIR_BOLD_FFONT);
 
           hours_font = avenir_bold;
           minutes_font = avenir_bold;
           colon_font = avenir_bold;
         break;
       case FONT_SETTING_BOLD_H:
-          avenir =      ffont_create_from_resource(RESOURCE_ID_AVENIR_REGULAR_FFONT);
-          avenir_bold = ffont_create_from_resource(RESOURCE_ID_AVENIR_BOLD_FFONT);
+          avenir =      clock_font_create(RESOURCE_ID_AVENIR_REGULAR_FFONT);
+          avenir_bold = clock_font_create(RESOURCE_ID_AVENIR_BOLD_FFONT);
 
           hours_font = avenir_bold;
           minutes_font = avenir;
           colon_font = avenir;
         break;
       case FONT_SETTING_BOLD_M:
-          avenir =      ffont_create_from_resource(RESOURCE_ID_AVENIR_REGULAR_FFONT);
-          avenir_bold = ffont_create_from_resource(RESOURCE_ID_AVENIR_BOLD_FFONT);
+          avenir =      clock_font_create(RESOURCE_ID_AVENIR_REGULAR_FFONT);
+          avenir_bold = clock_font_create(RESOURCE_ID_AVENIR_BOLD_FFONT);
 
           hours_font = avenir;
           minutes_font = avenir_bold;
           colon_font = avenir;
         break;
       case FONT_SETTING_LECO:
-          leco = ffont_create_from_resource(RESOURCE_ID_LECO_REGULAR_FFONT);
+          leco = clock_font_create(RESOURCE_ID_LECO_REGULAR_FFONT);
 
           hours_font = leco;
           minutes_font = leco;
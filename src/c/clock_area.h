@@ -1,5 +1,6 @@
 #pragma once
 #include <pebble.h>
+#include "changes.h"
 
 #define FONT_SETTING_DEFAULT 0
 #define FONT_SETTING_LECO    1
@@ -12,4 +13,12 @@
 void ClockArea_init(Window* window);
 void ClockArea_deinit(void);
 void ClockArea_redraw(void);
+void ClockArea_redraw_changes(uint16_t changes);
 void ClockArea_update_fonts(void);
+
+/*
+ * Recomputes where the clock is drawn, after a change of the settings or of
+ * the unobstructed area. While the unobstructed area is animating, the glyph
+ * caches keep their size and the clock is drawn by fctx until the layout settles
+ */
+void ClockArea_update_layout(bool animating);
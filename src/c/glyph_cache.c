@@ -0,0 +1,568 @@
+#include <pebble.h>
+#include <pebble-fctx/fctx.h>
+#include "glyph_cache.h"
+
+// the cached glyphs: digits, colon and space
+#define GLYPH_COUNT GLYPH_CACHE_SIZE
+#define GLYPH_COLON 10
+#define GLYPH_SPACE 11
+
+// layout of the ffont resources generated by fctx-compiler:
+// a header, the code point ranges, the glyph table and the path data
+typedef struct __attribute__((__packed__)) {
+  uint16_t unitsPerEm;
+  int16_t ascent;
+  int16_t descent;
+  int16_t capHeight;
+  uint16_t rangeCount;
+  uint16_t glyphCount;
+} FontFileHeader;
+
+typedef struct __attribute__((__packed__)) {
+  uint16_t start;
+  uint16_t end;
+} FontFileRange;
+
+typedef struct __attribute__((__packed__)) {
+  uint16_t pathDataOffset;
+  uint16_t pathDataLength;
+  int16_t horizAdvX;
+} FontFileGlyph;
+
+// the path data is a list of svg-like absolute commands: a 16 bit command
+// code followed by its 16 bit coordinates, in font units with y going up
+#define PATH_MOVE_TO    'M'
+#define PATH_LINE_TO    'L'
+#define PATH_HLINE_TO   'H'
+#define PATH_VLINE_TO   'V'
+#define PATH_QUAD_TO    'Q'
+#define PATH_SMOOTH_TO  'T'
+#define PATH_CLOSE      'Z'
+
+// the curves are split in lines which stray at most this far from them, in fixed point pixels
+#define CURVE_TOLERANCE (FIXED_POINT_SCALE / 4)
+#define MAX_CURVE_SEGMENTS 16
+
+// cached coordinates are fixed point pixels, relative to the glyph origin
+typedef struct {
+  int16_t x;
+  int16_t y;
+} CachedPoint;
+
+typedef struct {
+  bool present;
+  uint16_t firstOp;
+  uint16_t opCount;
+  uint16_t firstPoint;
+  fixed_t advance;
+
+  // bounding box of the outline points, which also contains the curves
+  int16_t minX;
+  int16_t minY;
+  int16_t maxX;
+  int16_t maxY;
+} CachedGlyph;
+
+struct GlyphCache {
+  uint32_t resourceId;
+  int16_t emHeight;
+  bool valid;
+
+  // scaled font metrics, used to anchor the strings
+  fixed_t ascent;
+  fixed_t descent;
+  fixed_t capHeight;
+
+  CachedGlyph glyphs[GLYPH_COUNT];
+
+  // only move, line and close commands are left once the outlines are cached,
+  // so that drawing them doesn't split the curves again every frame
+  uint8_t* ops;
+  CachedPoint* points;
+};
+
+int GlyphCache_glyph_index(char c) {
+  if(c >= '0' && c <= '9') {
+    return c - '0';
+  } else if(c == ':') {
+    return GLYPH_COLON;
+  } else if(c == ' ') {
+    return GLYPH_SPACE;
+  }
+
+  return -1;
+}
+
+static char glyph_char(int index) {
+  if(index == GLYPH_COLON) {
+    return ':';
+  } else if(index == GLYPH_SPACE) {
+    return ' ';
+  }
+
+  return '0' + index;
+}
+
+static fixed_t scale(const GlyphCache* cache, int32_t units, uint16_t unitsPerEm) {
+  return units * cache->emHeight * FIXED_POINT_SCALE / unitsPerEm;
+}
+
+static int16_t read_int16(const uint8_t* data) {
+  return (int16_t)(data[0] | (data[1] << 8));
+}
+
+/*
+ * Finds the glyph table entry of the code point, or NULL if the font doesn't have it
+ */
+static const FontFileGlyph* find_glyph(const uint8_t* data, uint16_t codePoint) {
+  const FontFileHeader* header = (const FontFileHeader*)data;
+  const FontFileRange* ranges = (const FontFileRange*)(data + sizeof(FontFileHeader));
+  const FontFileGlyph* glyphs = (const FontFileGlyph*)(ranges + header->rangeCount);
+  int glyphIndex = 0;
+
+  for(int i = 0; i < header->rangeCount; i++) {
+    if(codePoint >= ranges[i].start && codePoint < ranges[i].end) {
+      glyphIndex += codePoint - ranges[i].start;
+
+      if(glyphIndex >= header->glyphCount) {
+        return NULL;
+      }
+
+      return &glyphs[glyphIndex];
+    }
+
+    glyphIndex += ranges[i].end - ranges[i].start;
+  }
+
+  return NULL;
+}
+
+static void add_to_bounds(CachedGlyph* glyph, const CachedPoint* point, bool first) {
+  if(first) {
+    glyph->minX = glyph->maxX = point->x;
+    glyph->minY = glyph->maxY = point->y;
+  } else {
+    glyph->minX = point->x < glyph->minX ? point->x : glyph->minX;
+    glyph->minY = point->y < glyph->minY ? point->y : glyph->minY;
+    glyph->maxX = point->x > glyph->maxX ? point->x : glyph->maxX;
+    glyph->maxY = point->y > glyph->maxY ? point->y : glyph->maxY;
+  }
+}
+
+static int32_t isqrt(int32_t value) {
+  int32_t root = 0;
+
+  while((root + 1) * (root + 1) <= value) {
+    root++;
+  }
+
+  return root;
+}
+
+/*
+ * Number of lines a quadratic curve is split in: the distance between a curve
+ * and the chords of n equal steps is at most |p0 - 2 cp + p| / (4 n^2)
+ */
+static int curve_segments(CachedPoint p0, CachedPoint cp, CachedPoint p) {
+  int32_t dx = p0.x - 2 * cp.x + p.x;
+  int32_t dy = p0.y - 2 * cp.y + p.y;
+  int32_t deviation = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+  int segments = isqrt(deviation / (4 * CURVE_TOLERANCE)) + 1;
+
+  return segments < MAX_CURVE_SEGMENTS ? segments : MAX_CURVE_SEGMENTS;
+}
+
+static CachedPoint scale_point(const GlyphCache* cache, int16_t x, int16_t y, uint16_t unitsPerEm) {
+  // font units have y going up
+  return (CachedPoint) { scale(cache, x, unitsPerEm), -scale(cache, y, unitsPerEm) };
+}
+
+/*
+ * Walks the path data of every cached glyph, resolving the horizontal,
+ * vertical and smooth commands and splitting the curves into plain lines.
+ * When ops and points are NULL, only counts them
+ */
+static bool walk_glyphs(GlyphCache* cache, const uint8_t* data, size_t size,
+                        uint16_t* opCount, uint16_t* pointCount) {
+  const FontFileHeader* header = (const FontFileHeader*)data;
+  const uint8_t* pathData = data + sizeof(FontFileHeader)
+                                 + header->rangeCount * sizeof(FontFileRange)
+                                 + header->glyphCount * sizeof(FontFileGlyph);
+
+  *opCount = 0;
+  *pointCount = 0;
+
+  for(int i = 0; i < GLYPH_COUNT; i++) {
+    CachedGlyph* cached = &cache->glyphs[i];
+    const FontFileGlyph* glyph = find_glyph(data, glyph_char(i));
+
+    cached->present = (glyph != NULL);
+    cached->firstOp = *opCount;
+    cached->firstPoint = *pointCount;
+    cached->opCount = 0;
+    cached->minX = cached->minY = cached->maxX = cached->maxY = 0;
+
+    if(!glyph) {
+      continue;
+    }
+
+    cached->advance = scale(cache, glyph->horizAdvX, header->unitsPerEm);
+
+    const uint8_t* cmd = pathData + glyph->pathDataOffset;
+    const uint8_t* end = cmd + glyph->pathDataLength;
+
+    if(end > data + size) {
+      return false;
+    }
+
+    // current point and control point of the previous curve, in font units
+    int16_t x = 0, y = 0;
+    int16_t cx = 0, cy = 0;
+    bool previousWasCurve = false;
+
+    // current point, scaled
+    CachedPoint previousPoint = { 0, 0 };
+
+    while(cmd < end) {
+      uint16_t code = (uint16_t)read_int16(cmd);
+      int16_t points[4];
+      int argCount;
+      uint8_t op;
+      bool isCurve = false;
+
+      cmd += 2;
+
+      switch(code) {
+        case PATH_MOVE_TO:
+        case PATH_LINE_TO:
+        case PATH_SMOOTH_TO:
+          argCount = 2;
+          break;
+        case PATH_HLINE_TO:
+        case PATH_VLINE_TO:
+          argCount = 1;
+          break;
+        case PATH_QUAD_TO:
+          argCount = 4;
+          break;
+        case PATH_CLOSE:
+          argCount = 0;
+          break;
+        default:
+          // unknown command, let fctx draw this font
+          return false;
+      }
+
+      if(cmd + argCount * 2 > end) {
+        return false;
+      }
+
+      for(int a = 0; a < argCount; a++) {
+        points[a] = read_int16(cmd + a * 2);
+      }
+      cmd += argCount * 2;
+
+      bool hasPoint;
+
+      switch(code) {
+        case PATH_MOVE_TO:
+        case PATH_LINE_TO:
+          op = code;
+          x = points[0];
+          y = points[1];
+          hasPoint = true;
+          break;
+        case PATH_HLINE_TO:
+          op = PATH_LINE_TO;
+          x = points[0];
+          hasPoint = true;
+          break;
+        case PATH_VLINE_TO:
+          op = PATH_LINE_TO;
+          y = points[0];
+          hasPoint = true;
+          break;
+        case PATH_QUAD_TO:
+          op = PATH_LINE_TO;
+          cx = points[0];
+          cy = points[1];
+          x = points[2];
+          y = points[3];
+          hasPoint = true;
+          isCurve = true;
+          break;
+        case PATH_SMOOTH_TO:
+          // the control point is the reflection of the previous one
+          op = PATH_LINE_TO;
+          if(previousWasCurve) {
+            cx = 2 * x - cx;
+            cy = 2 * y - cy;
+          } else {
+            cx = x;
+            cy = y;
+          }
+          x = points[0];
+          y = points[1];
+          hasPoint = true;
+          isCurve = true;
+          break;
+        default: // PATH_CLOSE
+          op = PATH_CLOSE;
+          hasPoint = false;
+          break;
+      }
+
+      previousWasCurve = isCurve;
+
+      // curves are split in lines, from the current point
+      CachedPoint target = scale_point(cache, x, y, header->unitsPerEm);
+      int segments = 1;
+      CachedPoint start = previousPoint;
+      CachedPoint control = start;
+
+      if(isCurve) {
+        control = scale_point(cache, cx, cy, header->unitsPerEm);
+        segments = curve_segments(start, control, target);
+      }
+
+      for(int i = 1; i <= segments; i++) {
+        if(cache->ops) {
+          cache->ops[*opCount] = op;
+
+          if(hasPoint) {
+            CachedPoint* point = &cache->points[*pointCount];
+
+            if(isCurve) {
+              int32_t t = i, u = segments - i, n = segments * segments;
+
+              point->x = (u * u * start.x + 2 * u * t * control.x + t * t * target.x) / n;
+              point->y = (u * u * start.y + 2 * u * t * control.y + t * t * target.y) / n;
+            } else {
+              *point = target;
+            }
+
+            add_to_bounds(cached, point, *pointCount == cached->firstPoint);
+          }
+        }
+
+        (*opCount)++;
+        *pointCount += hasPoint ? 1 : 0;
+        cached->opCount++;
+      }
+
+      if(hasPoint) {
+        previousPoint = target;
+      }
+    }
+  }
+
+  return true;
+}
+
+static void free_outlines(GlyphCache* cache) {
+  free(cache->ops);
+  free(cache->points);
+  cache->ops = NULL;
+  cache->points = NULL;
+  cache->valid = false;
+}
+
+static bool build_outlines(GlyphCache* cache) {
+  ResHandle handle = resource_get_handle(cache->resourceId);
+  size_t size = resource_size(handle);
+
+  if(size < sizeof(FontFileHeader)) {
+    return false;
+  }
+
+  uint8_t* data = malloc(size);
+
+  if(!data) {
+    return false;
+  }
+
+  resource_load(handle, data, size);
+
+  const FontFileHeader* header = (const FontFileHeader*)data;
+  size_t tablesSize = sizeof(FontFileHeader)
+                    + header->rangeCount * sizeof(FontFileRange)
+                    + header->glyphCount * sizeof(FontFileGlyph);
+  bool success = false;
+
+  if(tablesSize <= size && header->unitsPerEm > 0) {
+    uint16_t opCount, pointCount;
+
+    // first count the commands, then store them
+    if(walk_glyphs(cache, data, size, &opCount, &pointCount)) {
+      cache->ops = malloc(opCount);
+      cache->points = malloc(pointCount * sizeof(CachedPoint));
+
+      if(cache->ops && cache->points) {
+        success = walk_glyphs(cache, data, size, &opCount, &pointCount);
+
+        cache->ascent = scale(cache, header->ascent, header->unitsPerEm);
+        cache->descent = scale(cache, header->descent, header->unitsPerEm);
+        cache->capHeight = scale(cache, header->capHeight, header->unitsPerEm);
+      }
+    }
+  }
+
+  free(data);
+
+  return success;
+}
+
+GlyphCache* GlyphCache_create(uint32_t resourceId) {
+  GlyphCache* cache = malloc(sizeof(GlyphCache));
+
+  if(cache) {
+    memset(cache, 0, sizeof(GlyphCache));
+    cache->resourceId = resourceId;
+  }
+
+  return cache;
+}
+
+void GlyphCache_destroy(GlyphCache* cache) {
+  if(cache) {
+    free_outlines(cache);
+    free(cache);
+  }
+}
+
+void GlyphCache_set_em_height(GlyphCache* cache, int16_t emHeight) {
+  if(!cache || cache->emHeight == emHeight) {
+    return;
+  }
+
+  free_outlines(cache);
+  cache->emHeight = emHeight;
+
+  if(build_outlines(cache)) {
+    cache->valid = true;
+  } else {
+    // not enough memory or unexpected font data: fctx will draw this font
+    free_outlines(cache);
+  }
+}
+
+int16_t GlyphCache_get_em_height(GlyphCache* cache) {
+  return (cache && cache->valid) ? cache->emHeight : 0;
+}
+
+static void draw_glyph(const GlyphCache* cache, FContext* fctx, const CachedGlyph* glyph, FPoint origin) {
+  const CachedPoint* point = &cache->points[glyph->firstPoint];
+
+  for(int i = glyph->firstOp; i < glyph->firstOp + glyph->opCount; i++) {
+    switch(cache->ops[i]) {
+      case PATH_MOVE_TO:
+        fctx_move_to(fctx, FPoint(origin.x + point->x, origin.y + point->y));
+        point++;
+        break;
+      case PATH_LINE_TO:
+        fctx_line_to(fctx, FPoint(origin.x + point->x, origin.y + point->y));
+        point++;
+        break;
+      default: // PATH_CLOSE
+        fctx_close_path(fctx);
+        break;
+    }
+  }
+}
+
+bool GlyphCache_layout_string(GlyphCache* cache, const char* text, GTextAlignment alignment, FTextAnchor anchor,
+                              FPoint* origin) {
+  if(!cache || !cache->valid) {
+    return false;
+  }
+
+  // measure the string, and make sure all its glyphs are cached
+  fixed_t width = 0;
+
+  for(const char* c = text; *c != '\0'; c++) {
+    int index = GlyphCache_glyph_index(*c);
+
+    if(index < 0 || !cache->glyphs[index].present) {
+      return false;
+    }
+
+    width += cache->glyphs[index].advance;
+  }
+
+  *origin = FPointZero;
+
+  if(alignment == GTextAlignmentCenter) {
+    origin->x = -width / 2;
+  } else if(alignment == GTextAlignmentRight) {
+    origin->x = -width;
+  }
+
+  switch(anchor) {
+    case FTextAnchorTop:
+      origin->y = cache->ascent;
+      break;
+    case FTextAnchorMiddle:
+      origin->y = (cache->ascent + cache->descent) / 2;
+      break;
+    case FTextAnchorBottom:
+      origin->y = cache->descent;
+      break;
+    case FTextAnchorCapTop:
+      origin->y = cache->capHeight;
+      break;
+    case FTextAnchorCapMiddle:
+      origin->y = cache->capHeight / 2;
+      break;
+    default: // FTextAnchorBaseline
+      break;
+  }
+
+  return true;
+}
+
+fixed_t GlyphCache_get_advance(GlyphCache* cache, char c) {
+  return cache->glyphs[GlyphCache_glyph_index(c)].advance;
+}
+
+// rounds towards negative and positive infinity, for negative coordinates too
+static int16_t fixed_floor(int16_t value) {
+  return value >= 0 ? value / FIXED_POINT_SCALE : -((-value + FIXED_POINT_SCALE - 1) / FIXED_POINT_SCALE);
+}
+
+static int16_t fixed_ceil(int16_t value) {
+  return -fixed_floor(-value);
+}
+
+GRect GlyphCache_get_bounds(GlyphCache* cache, char c) {
+  const CachedGlyph* glyph = &cache->glyphs[GlyphCache_glyph_index(c)];
+  int16_t left = fixed_floor(glyph->minX);
+  int16_t top = fixed_floor(glyph->minY);
+
+  return GRect(left, top, fixed_ceil(glyph->maxX) - left, fixed_ceil(glyph->maxY) - top);
+}
+
+void GlyphCache_draw_glyph(GlyphCache* cache, FContext* fctx, char c, FPoint origin) {
+  fctx_set_scale(fctx, FPointI(1, 1), FPointI(1, 1));
+  draw_glyph(cache, fctx, &cache->glyphs[GlyphCache_glyph_index(c)], origin);
+}
+
+bool GlyphCache_draw_string(GlyphCache* cache, FContext* fctx, const char* text, GTextAlignment alignment, FTextAnchor anchor) {
+  FPoint origin;
+
+  if(!GlyphCache_layout_string(cache, text, alignment, anchor, &origin)) {
+    return false;
+  }
+
+  // the outlines are already scaled and flattened, fctx still transforms each
+  // point but with a scale of one
+  fctx_set_scale(fctx, FPointI(1, 1), FPointI(1, 1));
+
+  for(const char* c = text; *c != '\0'; c++) {
+    const CachedGlyph* glyph = &cache->glyphs[GlyphCache_glyph_index(*c)];
+
+    draw_glyph(cache, fctx, glyph, origin);
+    origin.x += glyph->advance;
+  }
+
+  return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <pebble.h>
+#include <pebble-fctx/fctx.h>
+
+/*
+ * A GlyphCache holds the outlines of the clock glyphs (digits, colon and space)
+ * of an ffont resource, already scaled to fixed point pixels for one em height
+ * and with their curves split in lines, so that drawing them doesn't need to
+ * walk the font data and flatten the curves every frame
+ */
+typedef struct GlyphCache GlyphCache;
+
+// number of cached glyphs, see GlyphCache_glyph_index()
+#define GLYPH_CACHE_SIZE 12
+
+/*
+ * Creates an empty cache for the ffont resource, the outlines are built by
+ * the first call to GlyphCache_set_em_height()
+ */
+GlyphCache* GlyphCache_create(uint32_t resourceId);
+void GlyphCache_destroy(GlyphCache* cache);
+
+/*
+ * Rebuilds the scaled outlines if the em height differs from the cached one
+ */
+void GlyphCache_set_em_height(GlyphCache* cache, int16_t emHeight);
+
+/*
+ * Em height of the cached outlines, or 0 if there are none
+ */
+int16_t GlyphCache_get_em_height(GlyphCache* cache);
+
+/*
+ * Fills the outlines of the string in the current fctx fill, at the current
+ * fctx offset. Returns false without drawing anything if one of the characters
+ * is not cached, in which case the caller should draw it with fctx_draw_string()
+ */
+bool GlyphCache_draw_string(GlyphCache* cache, FContext* fctx, const char* text, GTextAlignment alignment, FTextAnchor anchor);
+
+/*
+ * Index of the character among the cached glyphs, or -1 if it isn't one of them
+ */
+int GlyphCache_glyph_index(char c);
+
+/*
+ * Computes the origin of the first glyph of the string, relative to the point
+ * the string is anchored to. Returns false if one of the characters is not cached.
+ * The following glyphs are each placed GlyphCache_get_advance() further right
+ */
+bool GlyphCache_layout_string(GlyphCache* cache, const char* text, GTextAlignment alignment, FTextAnchor anchor,
+                              FPoint* origin);
+
+/*
+ * Metrics of a cached character, which must be in a string accepted by
+ * GlyphCache_layout_string(). The bounds are in pixels, relative to the glyph
+ * origin, and contain every pixel the outline touches
+ */
+fixed_t GlyphCache_get_advance(GlyphCache* cache, char c);
+GRect GlyphCache_get_bounds(GlyphCache* cache, char c);
+
+/*
+ * Fills the outline of one cached character in the current fctx fill
+ */
+void GlyphCache_draw_glyph(GlyphCache* cache, FContext* fctx, char c, FPoint origin);
@@ -0,0 +1,266 @@
+#include <pebble.h>
+#include <pebble-fctx/fctx.h>
+#include "glyph_sprites.h"
+
+// the sprites use the same pixel format as the frame buffer, minus the round layout
+#define SPRITE_FORMAT PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit)
+
+// heap left for everything else (messages, weather icons...) after allocating a sprite
+#define SPRITE_HEAP_RESERVE 4096
+
+struct GlyphSprites {
+  GlyphCache* glyphs;
+
+  // what the sprites were rasterized with
+  int16_t emHeight;
+  GColor textColor;
+  GColor bgColor;
+
+  // set when a sprite didn't fit in the heap or couldn't be copied from the
+  // screen, until the style changes
+  bool rasterizeFailed;
+
+  GBitmap* sprites[GLYPH_CACHE_SIZE];
+};
+
+static void drop_sprites(GlyphSprites* sprites) {
+  for(int i = 0; i < GLYPH_CACHE_SIZE; i++) {
+    if(sprites->sprites[i]) {
+      gbitmap_destroy(sprites->sprites[i]);
+      sprites->sprites[i] = NULL;
+    }
+  }
+
+  sprites->rasterizeFailed = false;
+}
+
+GlyphSprites* GlyphSprites_create(GlyphCache* glyphs) {
+  GlyphSprites* sprites = malloc(sizeof(GlyphSprites));
+
+  if(sprites) {
+    memset(sprites, 0, sizeof(GlyphSprites));
+    sprites->glyphs = glyphs;
+  }
+
+  return sprites;
+}
+
+void GlyphSprites_destroy(GlyphSprites* sprites) {
+  if(sprites) {
+    drop_sprites(sprites);
+    free(sprites);
+  }
+}
+
+void GlyphSprites_set_style(GlyphSprites* sprites, int16_t emHeight, GColor textColor, GColor bgColor) {
+  if(!sprites) {
+    return;
+  }
+
+  if(sprites->emHeight != emHeight || !gcolor_equal(sprites->textColor, textColor) ||
+     !gcolor_equal(sprites->bgColor, bgColor)) {
+    drop_sprites(sprites);
+
+    sprites->emHeight = emHeight;
+    sprites->textColor = textColor;
+    sprites->bgColor = bgColor;
+  }
+}
+
+static size_t sprite_size(GSize size) {
+#ifdef PBL_COLOR
+  return size.w * size.h;
+#else
+  // 1 bit rows are padded to 32 bits
+  return ((size.w + 31) / 32) * 4 * size.h;
+#endif
+}
+
+/*
+ * Copies the pixels of the sprite from the frame buffer, returns false if some
+ * of them are outside of the screen (or outside of the round display). On color
+ * watches the background pixels become transparent, so that the sprite doesn't
+ * erase the antialiased edges of its neighbours
+ */
+static bool copy_from_frame_buffer(GBitmap* frameBuffer, GBitmap* sprite, GPoint screenOrigin, GColor bgColor) {
+  GRect screenBounds = gbitmap_get_bounds(frameBuffer);
+  GSize size = gbitmap_get_bounds(sprite).size;
+  uint8_t* spriteData = gbitmap_get_data(sprite);
+  uint16_t spriteRowSize = gbitmap_get_bytes_per_row(sprite);
+
+  if(screenOrigin.y < 0 || screenOrigin.y + size.h > screenBounds.size.h) {
+    return false;
+  }
+
+  for(int y = 0; y < size.h; y++) {
+    GBitmapDataRowInfo row = gbitmap_get_data_row_info(frameBuffer, screenOrigin.y + y);
+    uint8_t* dest = spriteData + y * spriteRowSize;
+
+    if(screenOrigin.x < row.min_x || screenOrigin.x + size.w - 1 > row.max_x) {
+      return false;
+    }
+
+#ifdef PBL_COLOR
+    for(int x = 0; x < size.w; x++) {
+      uint8_t pixel = row.data[screenOrigin.x + x];
+
+      dest[x] = (pixel == bgColor.argb) ? GColorClearARGB8 : pixel;
+    }
+#else
+    for(int x = 0; x < size.w; x++) {
+      int source = screenOrigin.x + x;
+
+      if(row.data[source / 8] & (1 << (source % 8))) {
+        dest[x / 8] |= 1 << (x % 8);
+      } else {
+        dest[x / 8] &= ~(1 << (x % 8));
+      }
+    }
+#endif
+  }
+
+  return true;
+}
+
+static GBitmap* capture_sprite(GlyphSprites* sprites, Layer* layer, GContext* ctx, GRect bounds) {
+  // keep the heap for the rest of the watchface, vectors will do if it's too low
+  if(heap_bytes_free() < sprite_size(bounds.size) + SPRITE_HEAP_RESERVE) {
+    sprites->rasterizeFailed = true;
+    return NULL;
+  }
+
+  GBitmap* sprite = gbitmap_create_blank(bounds.size, SPRITE_FORMAT);
+
+  if(!sprite) {
+    sprites->rasterizeFailed = true;
+    return NULL;
+  }
+
+  GBitmap* frameBuffer = graphics_capture_frame_buffer(ctx);
+  bool copied = false;
+
+  if(frameBuffer) {
+    copied = copy_from_frame_buffer(frameBuffer, sprite, layer_convert_point_to_screen(layer, bounds.origin),
+                                    sprites->bgColor);
+    graphics_release_frame_buffer(ctx, frameBuffer);
+  }
+
+  if(!copied) {
+    sprites->rasterizeFailed = true;
+    gbitmap_destroy(sprite);
+    return NULL;
+  }
+
+  return sprite;
+}
+
+/*
+ * Fills the glyph alone over the background, where it belongs on screen,
+ * then keeps a copy of the result as its sprite
+ */
+static void rasterize_glyph(GlyphSprites* sprites, Layer* layer, GContext* ctx, FContext* fctx,
+                            char c, GPoint origin, GRect bounds) {
+  graphics_context_set_fill_color(ctx, sprites->bgColor);
+  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+
+  fctx_begin_fill(fctx);
+  fctx_set_offset(fctx, FPointZero);
+  GlyphCache_draw_glyph(sprites->glyphs, fctx, c, FPointI(origin.x, origin.y));
+  fctx_end_fill(fctx);
+
+  sprites->sprites[GlyphCache_glyph_index(c)] = capture_sprite(sprites, layer, ctx, bounds);
+}
+
+/*
+ * Calls back with each glyph of the string which has something to draw, and its
+ * bounds in the layer, snapped to whole pixels. Returns false if the glyph
+ * cache can't draw the string
+ */
+typedef void (*GlyphCallback)(GlyphSprites* sprites, char c, GPoint origin, GRect bounds, void* context);
+
+static bool for_each_glyph(GlyphSprites* sprites, const char* text, FPoint position, GTextAlignment alignment,
+                           FTextAnchor anchor, GlyphCallback callback, void* context) {
+  FPoint origin;
+
+  if(!sprites || !GlyphCache_layout_string(sprites->glyphs, text, alignment, anchor, &origin)) {
+    return false;
+  }
+
+  origin.x += position.x;
+  origin.y += position.y;
+
+  for(const char* c = text; *c != '\0'; c++) {
+    // sprites can only be reused at whole pixel positions
+    GPoint glyphOrigin = GPoint(FIXED_TO_INT(origin.x + FIXED_POINT_SCALE / 2),
+                                FIXED_TO_INT(origin.y + FIXED_POINT_SCALE / 2));
+    GRect bounds = GlyphCache_get_bounds(sprites->glyphs, *c);
+
+    bounds.origin.x += glyphOrigin.x;
+    bounds.origin.y += glyphOrigin.y;
+
+    // spaces have nothing to draw
+    if(bounds.size.w > 0 && bounds.size.h > 0) {
+      callback(sprites, *c, glyphOrigin, bounds, context);
+    }
+
+    origin.x += GlyphCache_get_advance(sprites->glyphs, *c);
+  }
+
+  return true;
+}
+
+// what rasterize_missing_glyph() needs besides the sprites
+typedef struct {
+  Layer* layer;
+  GContext* ctx;
+  FContext* fctx;
+} RasterizeContext;
+
+static void rasterize_missing_glyph(GlyphSprites* sprites, char c, GPoint origin, GRect bounds, void* context) {
+  RasterizeContext* rasterize = context;
+
+  if(!sprites->rasterizeFailed && !sprites->sprites[GlyphCache_glyph_index(c)]) {
+    rasterize_glyph(sprites, rasterize->layer, rasterize->ctx, rasterize->fctx, c, origin, bounds);
+  }
+}
+
+void GlyphSprites_rasterize_string(GlyphSprites* sprites, Layer* layer, GContext* ctx, FContext* fctx,
+                                   const char* text, FPoint position, GTextAlignment alignment, FTextAnchor anchor) {
+  RasterizeContext context = { layer, ctx, fctx };
+
+  for_each_glyph(sprites, text, position, alignment, anchor, rasterize_missing_glyph, &context);
+}
+
+// set when a glyph of the string has no sprite
+static void find_missing_glyph(GlyphSprites* sprites, char c, GPoint origin, GRect bounds, void* context) {
+  if(!sprites->sprites[GlyphCache_glyph_index(c)]) {
+    *(bool*)context = true;
+  }
+}
+
+static void blit_glyph(GlyphSprites* sprites, char c, GPoint origin, GRect bounds, void* context) {
+  graphics_draw_bitmap_in_rect((GContext*)context, sprites->sprites[GlyphCache_glyph_index(c)], bounds);
+}
+
+bool GlyphSprites_draw_string(GlyphSprites* sprites, GContext* ctx, const char* text, FPoint position,
+                              GTextAlignment alignment, FTextAnchor anchor) {
+  bool missing = false;
+
+  if(!for_each_glyph(sprites, text, position, alignment, anchor, find_missing_glyph, &missing) || missing) {
+    return false;
+  }
+
+#ifdef PBL_COLOR
+  // only the pixels of the glyph are drawn, the background is transparent
+  graphics_context_set_compositing_mode(ctx, GCompOpSet);
+#else
+  // without antialiasing, only the pixels of the text color are drawn
+  graphics_context_set_compositing_mode(ctx, gcolor_equal(sprites->textColor, GColorWhite) ? GCompOpOr : GCompOpAnd);
+#endif
+
+  for_each_glyph(sprites, text, position, alignment, anchor, blit_glyph, ctx);
+
+  graphics_context_set_compositing_mode(ctx, GCompOpAssign);
+
+  return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <pebble.h>
+#include <pebble-fctx/fctx.h>
+#include "glyph_cache.h"
+
+/*
+ * GlyphSprites keep a bitmap of each glyph of a GlyphCache, rasterized once at
+ * the current size and colors, so that redrawing a string is only a few blits.
+ * Glyphs are rasterized the first time a string needs them, and the sprites
+ * are dropped whenever the em height or the colors change
+ */
+typedef struct GlyphSprites GlyphSprites;
+
+GlyphSprites* GlyphSprites_create(GlyphCache* glyphs);
+void GlyphSprites_destroy(GlyphSprites* sprites);
+
+/*
+ * Sets the em height and colors of the sprites, dropping them if they differ
+ * from the ones they were rasterized with
+ */
+void GlyphSprites_set_style(GlyphSprites* sprites, int16_t emHeight, GColor textColor, GColor bgColor);
+
+/*
+ * Fills the glyphs of the string (anchored at the position, in fixed point layer
+ * coordinates) which have no sprite yet, over the background, and copies them
+ * from the frame buffer, unless the heap is too low. This has to be done before
+ * anything else is drawn where the glyphs go, their background erases it
+ */
+void GlyphSprites_rasterize_string(GlyphSprites* sprites, Layer* layer, GContext* ctx, FContext* fctx,
+                                   const char* text, FPoint position, GTextAlignment alignment, FTextAnchor anchor);
+
+/*
+ * Draws the string anchored at the position (in fixed point layer coordinates),
+ * with the glyphs snapped to whole pixels and blitted over what is below them.
+ * Returns false without drawing anything if one of the glyphs has no sprite
+ */
+bool GlyphSprites_draw_string(GlyphSprites* sprites, GContext* ctx, const char* text, FPoint position,
+                              GTextAlignment alignment, FTextAnchor anchor);
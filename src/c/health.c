@@ -1,12 +1,17 @@
 #ifdef PBL_HEALTH
 #include <pebble.h>
 #include "health.h"
+#include "scheduler.h"
 
 #define SECONDS_AFTER_WAKE_UP 1800 // Half hour
 
 static bool s_sleeping;
 static bool s_restfulSleeping;
 static time_t s_endSleepTime;
+static bool s_sleepDisplayed;
+
+// ends the display of the sleep, a while after waking up
+static SchedulerJob s_wakeUpJob;
 static HealthValue s_sleep_seconds;
 static HealthValue s_restful_sleep_seconds;
 static HealthValue s_distance_walked;
@@ -27,30 +32,61 @@ static inline HealthValue get_health_value_sum_today(HealthMetric metric) {
     return is_health_metric_accessible(metric, start, end) ? health_service_sum_today(metric) : 0;
 }
 
-void Health_update(void) {
+// stores the new value, and reports if it was different
+static inline bool update_value(HealthValue *value, HealthValue new_value) {
+    if(*value == new_value) {
+        return false;
+    }
+
+    *value = new_value;
+    return true;
+}
+
+static uint16_t wake_up_job(time_t now) {
+    s_sleepDisplayed = s_sleeping;
+
+    return CHANGED_HEALTH;
+}
+
+uint16_t Health_update(void) {
     HealthActivityMask mask = health_service_peek_current_activities();
+    bool changed = false;
+    bool sleepWasDisplayed = s_sleepDisplayed;
+    bool wasSleeping = s_sleeping;
+    bool wasRestfulSleeping = s_restfulSleeping;
 
     // Sleep
     s_sleeping = (mask & HealthActivitySleep) || (mask & HealthActivityRestfulSleep);
     s_restfulSleeping = (mask & HealthActivityRestfulSleep);
-    s_sleep_seconds = get_health_value_sum_today(HealthMetricSleepSeconds);
-    s_restful_sleep_seconds = get_health_value_sum_today(HealthMetricSleepRestfulSeconds);
+    changed |= update_value(&s_sleep_seconds, get_health_value_sum_today(HealthMetricSleepSeconds));
+    changed |= update_value(&s_restful_sleep_seconds, get_health_value_sum_today(HealthMetricSleepRestfulSeconds));
 
     if(s_sleeping) {
         s_endSleepTime = time(NULL);
+        Scheduler_cancel(&s_wakeUpJob);
+    } else if(wasSleeping) {
+        // Sleep should be display during an half hour after wake up
+        Scheduler_schedule(&s_wakeUpJob, wake_up_job, s_endSleepTime + SECONDS_AFTER_WAKE_UP, 0);
     }
 
+    s_sleepDisplayed = s_sleeping || s_wakeUpJob.scheduled;
+
+    changed |= (sleepWasDisplayed != s_sleepDisplayed);
+    changed |= (wasRestfulSleeping != s_restfulSleeping);
+
     // Steps
-    s_distance_walked = get_health_value_sum_today(HealthMetricWalkedDistanceMeters);
-    s_steps = get_health_value_sum_today(HealthMetricStepCount);
-    s_active_seconds = get_health_value_sum_today(HealthMetricActiveSeconds);
-    s_active_kCalories = get_health_value_sum_today(HealthMetricActiveKCalories);
+    changed |= update_value(&s_distance_walked, get_health_value_sum_today(HealthMetricWalkedDistanceMeters));
+    changed |= update_value(&s_steps, get_health_value_sum_today(HealthMetricStepCount));
+    changed |= update_value(&s_active_seconds, get_health_value_sum_today(HealthMetricActiveSeconds));
+    changed |= update_value(&s_active_kCalories, get_health_value_sum_today(HealthMetricActiveKCalories));
 
     // Heart rate
     time_t now = time(NULL);
     if (is_health_metric_accessible(HealthMetricHeartRateBPM, now, now)) {
-        s_heart_rate = health_service_peek_current_value(HealthMetricHeartRateBPM);
+        changed |= update_value(&s_heart_rate, health_service_peek_current_value(HealthMetricHeartRateBPM));
     }
+
+    return changed ? CHANGED_HEALTH : CHANGED_NONE;
 }
 
 bool Health_isUserSleeping(void) {
@@ -62,8 +98,7 @@ bool Health_isUserRestfulSleeping(void) {
 }
 
 bool Health_sleepingToBeDisplayed(void) {
-    // Sleep should be display during an half hour after wake up
-    return s_sleeping || (s_endSleepTime + SECONDS_AFTER_WAKE_UP > time(NULL));
+    return s_sleepDisplayed;
 }
 
 HealthValue Health_getSleepSeconds(void) {
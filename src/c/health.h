@@ -1,7 +1,8 @@
 #pragma once
 #include <pebble.h>
+#include "changes.h"
 
-void Health_update(void);
+uint16_t Health_update(void);
 bool Health_isUserSleeping(void);
 bool Health_isUserRestfulSleeping(void);
 bool Health_sleepingToBeDisplayed(void);
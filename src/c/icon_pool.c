@@ -0,0 +1,124 @@
+#include <pebble.h>
+#include "icon_pool.h"
+
+typedef struct {
+  PaletteImage* img;
+  uint32_t resourceId;
+  uint16_t size;
+  uint16_t lastUse;
+  uint8_t refCount;
+} IconPoolEntry;
+
+static IconPoolEntry entries[ICON_POOL_SIZE];
+static uint16_t usedBytes;
+static uint16_t useCounter;
+
+static void freeEntry(IconPoolEntry* entry) {
+  util_image_destroy(entry->img);
+  usedBytes -= entry->size;
+
+  entry->img = NULL;
+  entry->refCount = 0;
+}
+
+static IconPoolEntry* findFreeEntry(void) {
+  for(int i = 0; i < ICON_POOL_SIZE; i++) {
+    if(!entries[i].img) {
+      return &entries[i];
+    }
+  }
+
+  return NULL;
+}
+
+// frees the least recently used icon nobody holds, returns false if there is none
+static bool evictOldest(void) {
+  IconPoolEntry* oldest = NULL;
+
+  for(int i = 0; i < ICON_POOL_SIZE; i++) {
+    IconPoolEntry* entry = &entries[i];
+
+    // the use counter wraps, so the ages are compared rather than the counts
+    if(entry->img && entry->refCount == 0 &&
+       (!oldest || (uint16_t)(useCounter - entry->lastUse) > (uint16_t)(useCounter - oldest->lastUse))) {
+      oldest = entry;
+    }
+  }
+
+  if(!oldest) {
+    return false;
+  }
+
+  freeEntry(oldest);
+
+  return true;
+}
+
+PaletteImage* IconPool_acquire(uint32_t resourceId) {
+  for(int i = 0; i < ICON_POOL_SIZE; i++) {
+    IconPoolEntry* entry = &entries[i];
+
+    if(entry->img && entry->resourceId == resourceId) {
+      entry->refCount++;
+      entry->lastUse = ++useCounter;
+
+      return entry->img;
+    }
+  }
+
+  // the icons are about as large on the heap as their resource
+  uint16_t size = resource_size(resource_get_handle(resourceId));
+
+  // the held icons are never evicted, even over the budget
+  while(usedBytes + size > ICON_POOL_BUDGET && evictOldest());
+
+  IconPoolEntry* entry = findFreeEntry();
+
+  if(!entry && evictOldest()) {
+    entry = findFreeEntry();
+  }
+
+  PaletteImage* img = util_image_create(resourceId);
+
+  // if every entry holds an icon in use, it's loaded outside the pool
+  if(!img || !entry) {
+    return img;
+  }
+
+  entry->img = img;
+  entry->resourceId = resourceId;
+  entry->size = size;
+  entry->refCount = 1;
+  entry->lastUse = ++useCounter;
+  usedBytes += size;
+
+  return img;
+}
+
+void IconPool_release(PaletteImage* img) {
+  if(!img) {
+    return;
+  }
+
+  for(int i = 0; i < ICON_POOL_SIZE; i++) {
+    if(entries[i].img == img) {
+      // stays loaded, in case it's needed again
+      if(entries[i].refCount > 0) {
+        entries[i].refCount--;
+      }
+
+      return;
+    }
+  }
+
+  // it was loaded outside the pool
+  util_image_destroy(img);
+}
+
+void IconPool_deinit(void) {
+  for(int i = 0; i < ICON_POOL_SIZE; i++) {
+    if(entries[i].img && entries[i].refCount == 0) {
+      freeEntry(&entries[i]);
+    }
+  }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <pebble.h>
+#include "util.h"
+
+// the heap the loaded icons may use, in bytes. The icons nobody holds stay
+// loaded until the budget is exceeded, then the least recently used go first
+#define ICON_POOL_BUDGET 2048
+
+// the number of icons which can be loaded at once
+#define ICON_POOL_SIZE 12
+
+/*
+ * Returns the icon of the resource, shared with the other holders of the same
+ * resource ID. Returns NULL if it can't be loaded
+ */
+PaletteImage* IconPool_acquire(uint32_t resourceId);
+
+/*
+ * Releases an icon returned by IconPool_acquire, NULL is ignored
+ */
+void IconPool_release(PaletteImage* img);
+
+/*
+ * Frees the icons nobody holds anymore
+ */
+void IconPool_deinit(void);
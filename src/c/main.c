@@ -9,6 +9,11 @@
 #include "health.h"
 #endif
 #include "time_date.h"
+#include "changes.h"
+#include "profiling.h"
+#include "scheduler.h"
+#include "icon_pool.h"
+#include "storage.h"
 
 // windows and layers
 static Window* mainWindow;
@@ -20,50 +25,104 @@ static bool isPhoneConnected;
 // current time service subscription
 static bool updatingEverySecond;
 
-// try to randomize when watches call the weather API
-static uint8_t weatherRefreshMinute;
-
-static void update_screen(void) {
-  time_date_update();
+// the beats change every 86.4 seconds, which isn't a tick unit
+static AppTimer* beatsTimer;
 
+// the jobs run by the minute ticks
+static SchedulerJob vibeJob;
 #ifdef PBL_HEALTH
-  Health_update();
+static SchedulerJob healthJob;
 #endif
 
+// marks dirty only the layers depending on the inputs that changed
+static void redraw_changes(uint16_t changes) {
   // update the sidebar
   if(globalSettings.sidebarLocation != NONE) {
-    Sidebar_redraw();
+    Sidebar_redraw_changes(changes);
   }
 
-  ClockArea_redraw();
+  ClockArea_redraw_changes(changes);
+}
+
+static void update_screen(const struct tm* time_info, TimeUnits units_changed, uint16_t changes) {
+  changes |= time_date_update(time_info, units_changed);
 
-  //APP_LOG(APP_LOG_LEVEL_DEBUG,"Avail RAM: %d", heap_bytes_free());
+  redraw_changes(changes);
 }
 
-static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-  // every 30 minutes, request new weather data
-  if(!globalSettings.disableWeather) {
-    if(tick_time->tm_min == weatherRefreshMinute && tick_time->tm_sec == 0) {
-      messaging_requestNewWeatherData();
+// every hour or half hour, if requested, vibrate
+static uint16_t vibe_job(time_t now) {
+  if(!quiet_time_is_active()) {
+    if(localtime(&now)->tm_min == 0) {
+      vibes_double_pulse();
+    } else {
+      vibes_short_pulse();
     }
   }
 
-  // every hour, if requested, vibrate
-  if(!quiet_time_is_active() && tick_time->tm_sec == 0) {
-    if(globalSettings.hourlyVibe == VIBE_EVERY_HOUR) { // hourly vibes only
-      if(tick_time->tm_min == 0) {
-        vibes_double_pulse();
-      }
-    } else if(globalSettings.hourlyVibe == VIBE_EVERY_HALF_HOUR) {  // hourly and half-hourly
-      if(tick_time->tm_min == 0) {
-        vibes_double_pulse();
-      } else if(tick_time->tm_min == 30) {
-        vibes_short_pulse();
-      }
+  return CHANGED_NONE;
+}
+
+#ifdef PBL_HEALTH
+static uint16_t health_job(time_t now) {
+  return Health_update();
+}
+#endif
+
+// (re)schedules the jobs needed by the current settings
+static void schedule_jobs(void) {
+  time_t now = time(NULL);
+
+  Weather_enableRefresh(!globalSettings.disableWeather);
+
+  if(globalSettings.hourlyVibe == VIBE_EVERY_HOUR) {
+    Scheduler_schedule(&vibeJob, vibe_job, Scheduler_nextLocalTime(now, SECONDS_PER_HOUR, 0), SECONDS_PER_HOUR);
+  } else if(globalSettings.hourlyVibe == VIBE_EVERY_HALF_HOUR) {
+    Scheduler_schedule(&vibeJob, vibe_job, Scheduler_nextLocalTime(now, SECONDS_PER_HOUR / 2, 0), SECONDS_PER_HOUR / 2);
+  } else {
+    Scheduler_cancel(&vibeJob);
+  }
+
+#ifdef PBL_HEALTH
+  if(globalSettings.enableHealth) {
+    if(!healthJob.scheduled) {
+      Scheduler_schedule(&healthJob, health_job, Scheduler_nextLocalTime(now, SECONDS_PER_MINUTE, 0), SECONDS_PER_MINUTE);
     }
+
+    // the screen is about to be redrawn, with fresh values
+    Health_update();
+  } else {
+    Scheduler_cancel(&healthJob);
   }
+#endif
+}
+
+static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
+  Profiling_tick(units_changed);
 
-  update_screen();
+  // within a minute, only the seconds widget changes
+  if(!(units_changed & MINUTE_UNIT)) {
+    redraw_changes(time_date_update(tick_time, units_changed));
+    return;
+  }
+
+  // the jobs due this minute, only the first one is checked otherwise
+  update_screen(tick_time, units_changed, Scheduler_run(time(NULL)));
+}
+
+static void beats_timer_callback(void *data);
+
+static void schedule_beats_timer(void) {
+  time_t now;
+  uint16_t ms = time_ms(&now, NULL);
+
+  beatsTimer = app_timer_register(time_date_ms_until_next_beat(now, ms), beats_timer_callback, NULL);
+}
+
+static void beats_timer_callback(void *data) {
+  // if the timer fired a bit early, the beat is refreshed by the next one
+  redraw_changes(time_date_update_beats(time(NULL)));
+  schedule_beats_timer();
 }
 
 #ifndef PBL_ROUND
@@ -76,12 +135,25 @@ static void unobstructed_area_will_change_handler(GRect final_unobstructed_scree
   }
 }
 
+static void unobstructed_area_change_handler(AnimationProgress progress, void *context) {
+  // the left and right sidebar widgets are spread over the unobstructed height
+  if(globalSettings.sidebarLocation == LEFT || globalSettings.sidebarLocation == RIGHT) {
+    Sidebar_update_layout();
+  }
+
+  ClockArea_update_layout(true);
+}
+
 static void unobstructed_area_did_change_handler(void *context) {
   int obstruction_height = get_obstruction_height(windowLayer);
 
   if (obstruction_height == 0 && globalSettings.sidebarLocation == TOP) {
     Sidebar_set_hidden(false);
+  } else if(globalSettings.sidebarLocation == LEFT || globalSettings.sidebarLocation == RIGHT) {
+    Sidebar_update_layout();
   }
+
+  ClockArea_update_layout(false);
 }
 #endif
 
@@ -101,19 +173,32 @@ static void redrawScreen() {
     }
   }
 
+  // start or stop the beats timer
+  if(beatsTimer) {
+    app_timer_cancel(beatsTimer);
+    beatsTimer = NULL;
+  }
+
+  if(globalSettings.enableBeats) {
+    time_date_update_beats(time(NULL));
+    schedule_beats_timer();
+  }
+
 #ifndef PBL_ROUND
+  // the clock layout follows the unobstructed area whatever the sidebar location
   unobstructed_area_service_unsubscribe();
 
-  if(globalSettings.sidebarLocation == TOP) {
-    UnobstructedAreaHandlers unobstructed_area_handlers = {
-      .will_change = unobstructed_area_will_change_handler,
-      .did_change = unobstructed_area_did_change_handler
-    };
+  UnobstructedAreaHandlers unobstructed_area_handlers = {
+    .will_change = unobstructed_area_will_change_handler,
+    .change = unobstructed_area_change_handler,
+    .did_change = unobstructed_area_did_change_handler
+  };
 
-    unobstructed_area_service_subscribe(unobstructed_area_handlers, NULL);
-  }
+  unobstructed_area_service_subscribe(unobstructed_area_handlers, NULL);
 #endif
 
+  schedule_jobs();
+
   window_set_background_color(mainWindow, globalSettings.timeBgColor);
 
   // maybe sidebar changed!
@@ -121,9 +206,22 @@ static void redrawScreen() {
 
   // check if the fonts need to be switched
   ClockArea_update_fonts();
+  ClockArea_update_layout(false);
 
   // Make sure display is refreshed from the start
-  update_screen();
+  time_t now = time(NULL);
+  update_screen(localtime(&now), TIME_DATE_ALL_UNITS, CHANGED_ALL);
+}
+
+static void messageProcessed(uint8_t updates) {
+  if(updates & MESSAGE_UPDATED_SETTINGS) {
+    redrawScreen();
+  } else if(updates & MESSAGE_UPDATED_WEATHER) {
+    // the next refresh is a TTL after the new data
+    Weather_enableRefresh(!globalSettings.disableWeather);
+
+    redraw_changes(CHANGED_WEATHER);
+  }
 }
 
 static void main_window_load(Window *window) {
@@ -155,14 +253,16 @@ static void bluetoothStateChanged(bool newConnectionState) {
 
   // if the phone was disconnected and isn't anymore, update the data
   if(!globalSettings.disableWeather && !isPhoneConnected && newConnectionState) {
-    messaging_requestNewWeatherData();
+    Weather_refreshSoon();
   }
 
   isPhoneConnected = newConnectionState;
 
-  if(globalSettings.sidebarLocation != NONE) {
-    Sidebar_redraw();
-  }
+  redraw_changes(CHANGED_BLUETOOTH);
+}
+
+static void batteryStateChanged(BatteryChargeState chargeState) {
+  redraw_changes(CHANGED_BATTERY);
 }
 
 // fixes for disappearing elements after notifications
@@ -183,10 +283,9 @@ static void app_focus_changed(bool focused) {
 static void init(void) {
   setlocale(LC_ALL, "");
 
+  // try to randomize when watches call the weather API
   srand(time(NULL));
 
-  weatherRefreshMinute = rand() % 60;
-
   // init settings
   Settings_init();
 
@@ -194,7 +293,10 @@ static void init(void) {
   Weather_init();
 
   // init the messaging thing
-  messaging_init(redrawScreen);
+  messaging_init(messageProcessed);
+
+  // record what the watchface costs, when enabled in profiling.h
+  Profiling_init();
 
   // Create main Window element and assign to pointer
   mainWindow = window_create();
@@ -223,6 +325,8 @@ static void init(void) {
   bluetoothStateChanged(connected);
   bluetooth_connection_service_subscribe(bluetoothStateChanged);
 
+  battery_state_service_subscribe(batteryStateChanged);
+
   // set up focus change handlers
   app_focus_service_subscribe_handlers((AppFocusHandlers){
     .did_focus = app_focus_changed,
@@ -236,14 +340,28 @@ static void deinit(void) {
 
   // unload weather stuff
   Weather_deinit();
+
+  // free the icons left in the cache
+  IconPool_deinit();
+
   Settings_deinit();
 
+  // write what changed since the last write
+  Storage_deinit();
+
   tick_timer_service_unsubscribe();
+
+  if(beatsTimer) {
+    app_timer_cancel(beatsTimer);
+  }
+
   bluetooth_connection_service_unsubscribe();
+  battery_state_service_unsubscribe();
 #ifndef PBL_ROUND
   unobstructed_area_service_unsubscribe();
 #endif
   app_focus_service_unsubscribe();
+  Profiling_deinit();
 }
 
 int main(void) {
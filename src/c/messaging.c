@@ -1,216 +1,364 @@
 #include <pebble.h>
+#include <stddef.h>
 #include "weather.h"
 #include "settings.h"
 #include "messaging.h"
+#include "profiling.h"
+
+// the first delay before sending a resync request again, doubled after each
+// failure up to the maximum, in milliseconds
+#define RESYNC_RETRY_DELAY 2000
+#define MAX_RESYNC_RETRY_DELAY 64000
 
 static MessageProcessedCallback message_processed_callback;
 
-static void inbox_received_callback(DictionaryIterator *iterator, void *context) {
-  // does this message contain current weather conditions?
-  Tuple *weatherTemp_tuple = dict_find(iterator, MESSAGE_KEY_WeatherTemperature);
-  Tuple *weatherConditions_tuple = dict_find(iterator, MESSAGE_KEY_WeatherCondition);
+// the phone already took the config it has to send again, so the request
+// is kept until it leaves the watch
+static bool resyncPending;
+static bool resyncSending;
+static AppTimer* resyncTimer;
+static uint32_t resyncRetryDelay = RESYNC_RETRY_DELAY;
 
-  if(weatherTemp_tuple != NULL && weatherConditions_tuple != NULL) {
-    // now set the weather conditions properly
-    Weather_weatherInfo.currentTemp = (int)weatherTemp_tuple->value->int32;
+// decodes the packed weather sent by the phone, and saves it at once
+static void receive_weather(const uint8_t* data, uint16_t length) {
+  WeatherPayload payload;
 
-    Weather_setCurrentCondition(weatherConditions_tuple->value->int32);
+  // the payloads of other versions are ignored, until the watch is updated too
+  if(length < sizeof(WeatherPayload) || data[0] != WEATHER_PAYLOAD_VERSION) {
+    return;
+  }
 
-    Weather_saveData();
+  memcpy(&payload, data, sizeof(WeatherPayload));
+
+  if(payload.flags & WEATHER_PAYLOAD_CURRENT) {
+    Weather_weatherInfo.currentTemp = payload.currentTemp;
+    Weather_setCurrentCondition(payload.currentCondition, payload.time);
   }
 
-  // does this message contain weather forecast information?
-  Tuple *weatherForecastCondition_tuple = dict_find(iterator, MESSAGE_KEY_WeatherForecastCondition);
-  Tuple *weatherForecastHigh_tuple = dict_find(iterator, MESSAGE_KEY_WeatherForecastHighTemp);
-  Tuple *weatherForecastLow_tuple = dict_find(iterator, MESSAGE_KEY_WeatherForecastLowTemp);
+  if(payload.flags & WEATHER_PAYLOAD_FORECAST) {
+    Weather_weatherForecast.highTemp = payload.highTemp;
+    Weather_weatherForecast.lowTemp = payload.lowTemp;
+    Weather_setForecastCondition(payload.forecastCondition);
+  }
 
-  if(weatherForecastCondition_tuple != NULL && weatherForecastHigh_tuple != NULL
-     && weatherForecastLow_tuple != NULL) {
+  if(payload.slotCount > 0) {
+    uint16_t slotsLength = payload.slotCount * sizeof(WeatherSlot);
 
-    Weather_weatherForecast.highTemp = (int)weatherForecastHigh_tuple->value->int32;
-    Weather_weatherForecast.lowTemp = (int)weatherForecastLow_tuple->value->int32;
-    Weather_setForecastCondition(weatherForecastCondition_tuple->value->int32);
+    if(slotsLength > length - sizeof(WeatherPayload)) {
+      slotsLength = length - sizeof(WeatherPayload);
+    }
 
-    Weather_saveData();
+    Weather_setForecastSlots(data + sizeof(WeatherPayload), slotsLength);
   }
 
-  // does this message contain new config information?
-  Tuple *timeColor_tuple = dict_find(iterator, MESSAGE_KEY_SettingColorTime);
-  Tuple *bgColor_tuple = dict_find(iterator, MESSAGE_KEY_SettingColorBG);
-  Tuple *sidebarColor_tuple = dict_find(iterator, MESSAGE_KEY_SettingColorSidebar);
-  Tuple *sidebarPos_tuple = dict_find(iterator, MESSAGE_KEY_SettingSidebarPosition);
-  Tuple *sidebarTextColor_tuple = dict_find(iterator, MESSAGE_KEY_SettingSidebarTextColor);
-  Tuple *useMetric_tuple = dict_find(iterator, MESSAGE_KEY_SettingUseMetric);
-  Tuple *btVibe_tuple = dict_find(iterator, MESSAGE_KEY_SettingBluetoothVibe);
-  Tuple *language_tuple = dict_find(iterator, MESSAGE_KEY_SettingLanguageID);
-  Tuple *leadingZero_tuple = dict_find(iterator, MESSAGE_KEY_SettingShowLeadingZero);
-  Tuple *centerTime_tuple = dict_find(iterator, MESSAGE_KEY_SettingCenterTime);
-  Tuple *batteryPct_tuple = dict_find(iterator, MESSAGE_KEY_SettingShowBatteryPct);
-  Tuple *disableWeather_tuple = dict_find(iterator, MESSAGE_KEY_SettingDisableWeather);
-  Tuple *clockFont_tuple = dict_find(iterator, MESSAGE_KEY_SettingClockFontId);
-  Tuple *hourlyVibe_tuple = dict_find(iterator, MESSAGE_KEY_SettingHourlyVibe);
-  Tuple *useLargeFonts_tuple = dict_find(iterator, MESSAGE_KEY_SettingUseLargeFonts);
+  Weather_saveData();
+}
 
-  Tuple *widget0Id_tuple = dict_find(iterator, MESSAGE_KEY_SettingWidget0ID);
-  Tuple *widget1Id_tuple = dict_find(iterator, MESSAGE_KEY_SettingWidget1ID);
-  Tuple *widget2Id_tuple = dict_find(iterator, MESSAGE_KEY_SettingWidget2ID);
-  Tuple *widget3Id_tuple = dict_find(iterator, MESSAGE_KEY_SettingWidget3ID);
+// what the handlers of one message share
+typedef struct {
+  // the settings before the message, restored if it doesn't apply to them
+  Settings previousSettings;
+  bool settingsChanged;
+
+  uint32_t configHash;
+  uint32_t configBase;
+  bool hasConfigHash;
+  bool hasConfigBase;
+} InboxState;
+
+// handles a tuple, and returns the MessageUpdates of what it changed
+typedef uint8_t (*TupleHandler)(const Tuple* tuple, InboxState* state);
+
+typedef enum {
+  FIELD_HANDLER = 0,
+  FIELD_INT     = 1,
+  FIELD_COLOR   = 2,
+  FIELD_STRING  = 3
+} FieldType;
+
+// a message key is either handled by a function, or copied to a field of globalSettings
+typedef struct {
+  TupleHandler handler;
+  uint16_t offset;
+  uint8_t size;
+  FieldType type:8;
+} MessageKeyEntry;
+
+#define HANDLER(function) { .handler = function, .type = FIELD_HANDLER }
+#define SETTING(field, fieldType) \
+  { .offset = offsetof(Settings, field), .size = sizeof(((Settings*)0)->field), .type = fieldType }
+
+// the tuples only change the settings once the whole message is known to apply to them
+static void begin_settings_change(InboxState* state) {
+  if(!state->settingsChanged) {
+    state->previousSettings = globalSettings;
+    state->settingsChanged = true;
+  }
+}
 
-  Tuple *altclockName_tuple = dict_find(iterator, MESSAGE_KEY_SettingAltClockName);
-  Tuple *altclockOffset_tuple = dict_find(iterator, MESSAGE_KEY_SettingAltClockOffset);
+// the integer of a tuple, whatever its size. The phone sends the characters
+// as strings, their first byte is used
+static int32_t tuple_int(const Tuple* tuple) {
+  if(tuple->type == TUPLE_CSTRING) {
+    return (char)tuple->value->uint8;
+  }
 
-  Tuple *decimalSeparator_tuple = dict_find(iterator, MESSAGE_KEY_SettingDecimalSep);
-  Tuple *healthActivityDisplay_tuple = dict_find(iterator, MESSAGE_KEY_SettingHealthActivityDisplay);
-  Tuple *healthUseRestfulSleep_tuple = dict_find(iterator, MESSAGE_KEY_SettingHealthUseRestfulSleep);
+  switch(tuple->length) {
+    case 1:
+      return (tuple->type == TUPLE_INT) ? tuple->value->int8 : tuple->value->uint8;
+    case 2:
+      return (tuple->type == TUPLE_INT) ? tuple->value->int16 : tuple->value->uint16;
+    default:
+      return tuple->value->int32;
+  }
+}
 
-  Tuple *autobattery_tuple = dict_find(iterator, MESSAGE_KEY_SettingDisableAutobattery);
+static uint8_t receive_weather_tuple(const Tuple* tuple, InboxState* state) {
+  receive_weather(tuple->value->data, tuple->length);
 
-  Tuple *activateDisconnectIcon_tuple = dict_find(iterator, MESSAGE_KEY_SettingDisconnectIcon);
+  return MESSAGE_UPDATED_WEATHER;
+}
 
+static uint8_t receive_config_hash(const Tuple* tuple, InboxState* state) {
+  state->configHash = tuple->value->uint32;
+  state->hasConfigHash = true;
 
-  if(timeColor_tuple != NULL) {
-    globalSettings.timeColor = GColorFromHEX(timeColor_tuple->value->int32);
-  }
+  return MESSAGE_UPDATED_SETTINGS;
+}
 
-  if(bgColor_tuple != NULL) {
-    globalSettings.timeBgColor = GColorFromHEX(bgColor_tuple->value->int32);
-  }
+static uint8_t receive_config_base(const Tuple* tuple, InboxState* state) {
+  state->configBase = tuple->value->uint32;
+  state->hasConfigBase = true;
 
-  if(sidebarColor_tuple != NULL) {
-    globalSettings.sidebarColor = GColorFromHEX(sidebarColor_tuple->value->int32);
-  }
+  return MESSAGE_UPDATED_SETTINGS;
+}
 
-  if(sidebarTextColor_tuple != NULL) {
-    // text can only be black or white, so we'll enforce that here
-    globalSettings.sidebarTextColor = GColorFromHEX(sidebarTextColor_tuple->value->int32);
-  }
+static uint8_t receive_day_name(const Tuple* tuple, InboxState* state) {
+  char* name = globalSettings.languageDayNames[tuple->key - MESSAGE_KEY_SettingLanguageDayNames];
 
-  if(sidebarPos_tuple != NULL) {
-    globalSettings.sidebarLocation = (BarLocationType)sidebarPos_tuple->value->int8;
-  }
+  begin_settings_change(state);
+  strncpy(name, tuple->value->cstring, sizeof(globalSettings.languageDayNames[0]));
 
-  if(useMetric_tuple != NULL) {
-    globalSettings.useMetric = (bool)useMetric_tuple->value->int8;
-  }
+  return MESSAGE_UPDATED_SETTINGS;
+}
 
-  if(btVibe_tuple != NULL) {
-    globalSettings.btVibe = (bool)btVibe_tuple->value->int8;
-  }
+static uint8_t receive_month_name(const Tuple* tuple, InboxState* state) {
+  char* name = globalSettings.languageMonthNames[tuple->key - MESSAGE_KEY_SettingLanguageMonthNames];
 
-  if(leadingZero_tuple != NULL) {
-    globalSettings.showLeadingZero = (bool)leadingZero_tuple->value->int8;
-  }
+  begin_settings_change(state);
+  strncpy(name, tuple->value->cstring, sizeof(globalSettings.languageMonthNames[0]));
 
-  if(centerTime_tuple != NULL) {
-    globalSettings.centerTime = (bool)centerTime_tuple->value->int8;
-  }
+  return MESSAGE_UPDATED_SETTINGS;
+}
 
-  if(batteryPct_tuple != NULL) {
-    globalSettings.showBatteryPct = (bool)batteryPct_tuple->value->int8;
+// the SDK numbers the message keys in the order of package.json, from the
+// first one to the last one. A key outside of them doesn't compile
+#define FIRST_MESSAGE_KEY MESSAGE_KEY_SettingAltClockName
+#define LAST_MESSAGE_KEY MESSAGE_KEY_ConfigResync
+#define KEY_INDEX(key) ((key) - FIRST_MESSAGE_KEY)
+
+static const MessageKeyEntry messageKeys[KEY_INDEX(LAST_MESSAGE_KEY) + 1] = {
+  [KEY_INDEX(MESSAGE_KEY_WeatherData)]                  = HANDLER(receive_weather_tuple),
+  [KEY_INDEX(MESSAGE_KEY_SettingConfigHash)]            = HANDLER(receive_config_hash),
+  [KEY_INDEX(MESSAGE_KEY_SettingConfigBase)]            = HANDLER(receive_config_base),
+
+  [KEY_INDEX(MESSAGE_KEY_SettingColorTime)]             = SETTING(timeColor, FIELD_COLOR),
+  [KEY_INDEX(MESSAGE_KEY_SettingColorBG)]               = SETTING(timeBgColor, FIELD_COLOR),
+  [KEY_INDEX(MESSAGE_KEY_SettingColorSidebar)]          = SETTING(sidebarColor, FIELD_COLOR),
+  [KEY_INDEX(MESSAGE_KEY_SettingSidebarTextColor)]      = SETTING(sidebarTextColor, FIELD_COLOR),
+  [KEY_INDEX(MESSAGE_KEY_SettingSidebarPosition)]       = SETTING(sidebarLocation, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingUseMetric)]             = SETTING(useMetric, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingBluetoothVibe)]         = SETTING(btVibe, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingLanguageID)]            = SETTING(languageId, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingShowLeadingZero)]       = SETTING(showLeadingZero, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingCenterTime)]            = SETTING(centerTime, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingShowBatteryPct)]        = SETTING(showBatteryPct, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingDisableAutobattery)]    = SETTING(disableAutobattery, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingDisableWeather)]        = SETTING(disableWeather, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingClockFontId)]           = SETTING(clockFontId, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingUseLargeFonts)]         = SETTING(useLargeFonts, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingHourlyVibe)]            = SETTING(hourlyVibe, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingWidget0ID)]             = SETTING(widgets[0], FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingWidget1ID)]             = SETTING(widgets[1], FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingWidget2ID)]             = SETTING(widgets[2], FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingWidget3ID)]             = SETTING(widgets[3], FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingAltClockName)]          = SETTING(altclockName, FIELD_STRING),
+  [KEY_INDEX(MESSAGE_KEY_SettingAltClockOffset)]        = SETTING(altclockOffset, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingAltClockZone)]          = SETTING(altclockZone, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingWeatherTTL)]            = SETTING(weatherTTL, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingDecimalSep)]            = SETTING(decimalSeparator, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingHealthActivityDisplay)] = SETTING(healthActivityDisplay, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingHealthUseRestfulSleep)] = SETTING(healthUseRestfulSleep, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingDisconnectIcon)]        = SETTING(activateDisconnectIcon, FIELD_INT),
+  [KEY_INDEX(MESSAGE_KEY_SettingLanguageWordForWeek)]   = SETTING(languageWordForWeek, FIELD_STRING),
+
+  [KEY_INDEX(MESSAGE_KEY_SettingLanguageDayNames) ...
+   KEY_INDEX(MESSAGE_KEY_SettingLanguageDayNames + 6)]   = HANDLER(receive_day_name),
+  [KEY_INDEX(MESSAGE_KEY_SettingLanguageMonthNames) ...
+   KEY_INDEX(MESSAGE_KEY_SettingLanguageMonthNames + 11)] = HANDLER(receive_month_name),
+};
+
+static uint8_t receive_setting(const MessageKeyEntry* entry, const Tuple* tuple, InboxState* state) {
+  uint8_t* field = (uint8_t*)&globalSettings + entry->offset;
+
+  begin_settings_change(state);
+
+  if(entry->type == FIELD_STRING) {
+    strncpy((char*)field, tuple->value->cstring, entry->size);
+  } else if(entry->type == FIELD_COLOR) {
+    GColor color = GColorFromHEX(tuple->value->int32);
+    memcpy(field, &color, sizeof(GColor));
+  } else {
+    // the low bytes of the integer, the watch is little endian
+    int32_t value = tuple_int(tuple);
+    memcpy(field, &value, entry->size);
   }
 
-  if(autobattery_tuple != NULL) {
-    globalSettings.disableAutobattery = (bool)autobattery_tuple->value->int8;
-  }
+  return MESSAGE_UPDATED_SETTINGS;
+}
 
-  if(disableWeather_tuple != NULL) {
-    globalSettings.disableWeather = (bool)disableWeather_tuple->value->int8;
-  }
+static void inbox_received_callback(DictionaryIterator *iterator, void *context) {
+  Profiling_count(PROFILE_MESSAGES_IN, 1);
+  Profiling_count(PROFILE_BYTES_IN, dict_size(iterator));
 
-  if(clockFont_tuple != NULL) {
-    globalSettings.clockFontId = clockFont_tuple->value->int8;
-  }
+  InboxState state = { .settingsChanged = false, .hasConfigHash = false, .hasConfigBase = false };
+  uint8_t updates = MESSAGE_UPDATED_NONE;
 
-  if(useLargeFonts_tuple != NULL) {
-    globalSettings.useLargeFonts = (bool)useLargeFonts_tuple->value->int8;
-  }
+  // each tuple goes to the entry of its key, the unknown keys are ignored
+  for(Tuple *tuple = dict_read_first(iterator); tuple != NULL; tuple = dict_read_next(iterator)) {
+    if(tuple->key < FIRST_MESSAGE_KEY || tuple->key > LAST_MESSAGE_KEY) {
+      continue;
+    }
 
-  if(hourlyVibe_tuple != NULL) {
-    globalSettings.hourlyVibe = hourlyVibe_tuple->value->int8;
-  }
+    const MessageKeyEntry* entry = &messageKeys[KEY_INDEX(tuple->key)];
 
-  if(language_tuple != NULL) {
-    globalSettings.languageId = language_tuple->value->int8;
+    if(entry->handler) {
+      updates |= entry->handler(tuple, &state);
+    } else if(entry->size > 0) {
+      updates |= receive_setting(entry, tuple, &state);
+    }
   }
 
-  if(widget0Id_tuple != NULL) {
-    globalSettings.widgets[0] = widget0Id_tuple->value->int8;
+  if(updates & MESSAGE_UPDATED_SETTINGS) {
+    // the phone only sends the settings which changed since the config it
+    // identifies as the base, or every setting without a base
+    if(state.hasConfigBase && state.configBase != globalSettings.configHash) {
+      if(state.settingsChanged) {
+        globalSettings = state.previousSettings;
+      }
+
+      messaging_requestConfigResync();
+      updates &= ~MESSAGE_UPDATED_SETTINGS;
+    } else {
+      if(state.hasConfigHash) {
+        globalSettings.configHash = state.configHash;
+      }
+
+      Settings_updateDynamicSettings();
+
+      // save the new settings to persistent storage
+      Settings_saveToStorage();
+    }
   }
 
-  if(widget1Id_tuple != NULL) {
-    globalSettings.widgets[1] = widget1Id_tuple->value->int8;
+  // notify the main screen, of what changed
+  if(updates != MESSAGE_UPDATED_NONE) {
+    message_processed_callback(updates);
   }
+}
 
-  if(widget2Id_tuple != NULL) {
-    globalSettings.widgets[2] = widget2Id_tuple->value->int8;
+void messaging_requestNewWeatherData(void) {
+  // just send an empty message for now
+  // if the outbox is busy, the backoff of the weather asks again
+  DictionaryIterator *iter;
+  if(app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    return;
   }
 
-  if(widget3Id_tuple != NULL) {
-    globalSettings.widgets[3] = widget3Id_tuple->value->int8;
-  }
+  dict_write_uint32(iter, 0, 0);
 
-  if(altclockName_tuple != NULL) {
-    strncpy(globalSettings.altclockName, altclockName_tuple->value->cstring, sizeof(globalSettings.altclockName));
-  }
+  Profiling_count(PROFILE_MESSAGES_OUT, 1);
+  Profiling_count(PROFILE_BYTES_OUT, dict_size(iter));
 
-  if(altclockOffset_tuple != NULL) {
-    globalSettings.altclockOffset = altclockOffset_tuple->value->int8;
-  }
+  app_message_outbox_send();
+}
 
-  if(decimalSeparator_tuple != NULL) {
-    globalSettings.decimalSeparator = (char)decimalSeparator_tuple->value->int8;
-  }
+static void send_resync(void);
 
-  if(healthActivityDisplay_tuple != NULL) {
-    globalSettings.healthActivityDisplay = (ActivityDisplayType)healthActivityDisplay_tuple->value->int8;
-  }
+static void resync_timer_callback(void* data) {
+  resyncTimer = NULL;
+
+  send_resync();
+}
 
-  if(healthUseRestfulSleep_tuple != NULL) {
-    globalSettings.healthUseRestfulSleep = (bool)healthUseRestfulSleep_tuple->value->int8;
+static void schedule_resync(void) {
+  if(resyncTimer) {
+    return;
   }
 
-  if(activateDisconnectIcon_tuple != NULL) {
-    globalSettings.activateDisconnectIcon = (bool)activateDisconnectIcon_tuple->value->int8;
+  resyncTimer = app_timer_register(resyncRetryDelay, resync_timer_callback, NULL);
+
+  if(resyncRetryDelay < MAX_RESYNC_RETRY_DELAY) {
+    resyncRetryDelay *= 2;
   }
+}
 
-  // does this message contain new language information?
-  Tuple *languageDayNames_tuple = dict_find(iterator, MESSAGE_KEY_SettingLanguageDayNames);
-  Tuple *languageMonthNames_tuple = dict_find(iterator, MESSAGE_KEY_SettingLanguageMonthNames);
-  Tuple *languageWordForWeek_tuple = dict_find(iterator, MESSAGE_KEY_SettingLanguageWordForWeek);
+static void send_resync(void) {
+  DictionaryIterator *iter;
 
-  if(languageDayNames_tuple != NULL) {
-    for(int i = 0;i<7;i++){
-      strncpy(globalSettings.languageDayNames[i], languageDayNames_tuple->value->cstring, sizeof(globalSettings.languageDayNames[i]));
-      languageDayNames_tuple = dict_find(iterator, MESSAGE_KEY_SettingLanguageDayNames + i + 1);
-    }
+  if(!resyncPending || resyncSending) {
+    return;
   }
 
-  if(languageMonthNames_tuple != NULL) {
-    for(int i = 0;i<12;i++){
-      strncpy(globalSettings.languageMonthNames[i], languageMonthNames_tuple->value->cstring, sizeof(globalSettings.languageMonthNames[i]));
-      languageMonthNames_tuple = dict_find(iterator, MESSAGE_KEY_SettingLanguageMonthNames + i + 1);
-    }
+  // the outbox may hold a weather request, the sent callback or the timer tries again
+  if(app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    schedule_resync();
+    return;
   }
 
-  if(languageWordForWeek_tuple != NULL) {
-    strncpy(globalSettings.languageWordForWeek, languageWordForWeek_tuple->value->cstring, sizeof(globalSettings.languageWordForWeek));
+  dict_write_uint8(iter, MESSAGE_KEY_ConfigResync, 1);
+
+  Profiling_count(PROFILE_MESSAGES_OUT, 1);
+  Profiling_count(PROFILE_BYTES_OUT, dict_size(iter));
+
+  resyncSending = (app_message_outbox_send() == APP_MSG_OK);
+
+  if(!resyncSending) {
+    schedule_resync();
   }
+}
+
+void messaging_requestConfigResync(void) {
+  resyncPending = true;
+
+  send_resync();
+}
+
+static void outbox_sent_callback(DictionaryIterator *iterator, void *context) {
+  if(resyncSending) {
+    resyncSending = false;
+    resyncPending = false;
+    resyncRetryDelay = RESYNC_RETRY_DELAY;
 
-  Settings_updateDynamicSettings();
+    if(resyncTimer) {
+      app_timer_cancel(resyncTimer);
+      resyncTimer = NULL;
+    }
+  }
 
-  // save the new settings to persistent storage
-  Settings_saveToStorage();
+  Profiling_outboxSent();
 
-  // notify the main screen, in case something changed
-  message_processed_callback();
+  // the outbox is free for a request which found it busy
+  send_resync();
 }
 
-void messaging_requestNewWeatherData(void) {
-  // just send an empty message for now
-  DictionaryIterator *iter;
-  app_message_outbox_begin(&iter);
-  dict_write_uint32(iter, 0, 0);
-  app_message_outbox_send();
+static void outbox_failed_callback(DictionaryIterator *iterator, AppMessageResult reason, void *context) {
+  if(resyncSending) {
+    resyncSending = false;
+    schedule_resync();
+  }
+
+  Profiling_outboxFailed();
 }
 
 void messaging_init(MessageProcessedCallback processed_callback) {
@@ -219,9 +367,16 @@ void messaging_init(MessageProcessedCallback processed_callback) {
 
   // Register callbacks
   app_message_register_inbox_received(inbox_received_callback);
+  app_message_register_outbox_sent(outbox_sent_callback);
+  app_message_register_outbox_failed(outbox_failed_callback);
 
   // Open AppMessage
-  app_message_open(305, 8);
+#ifdef PROFILING
+  app_message_open(305, PROFILING_OUTBOX_SIZE);
+#else
+  // the requests to the phone hold a single small tuple
+  app_message_open(305, 16);
+#endif
 
   // APP_LOG(APP_LOG_LEVEL_DEBUG, "Watch messaging is started!");
 }
@@ -1,7 +1,18 @@
 #pragma once
 #include <pebble.h>
 
-typedef void (*MessageProcessedCallback)(void);
+// what a message from the phone updated
+typedef enum {
+  MESSAGE_UPDATED_NONE     = 0,
+  MESSAGE_UPDATED_WEATHER  = 1 << 0,
+  MESSAGE_UPDATED_SETTINGS = 1 << 1
+} MessageUpdates;
+
+// called after each message which updated something, with its MessageUpdates
+typedef void (*MessageProcessedCallback)(uint8_t updates);
 
 void messaging_requestNewWeatherData(void);
+
+// asks the phone for every setting, when its changes don't apply to the watch's
+void messaging_requestConfigResync(void);
 void messaging_init(MessageProcessedCallback callback);
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include <pebble.h>
+#include "profiling.h"
+
+#ifdef PROFILING
+
+// the recorded minutes, oldest first from firstRecord
+static ProfileRecord records[PROFILING_RECORD_COUNT];
+static uint8_t firstRecord;
+static uint8_t recordCount;
+
+// the minute being recorded
+static ProfileRecord currentRecord;
+
+// set while the oldest record is in the outbox
+static bool sending;
+
+static time_t renderStartSeconds[PROFILE_LAYER_COUNT];
+static uint16_t renderStartMs[PROFILE_LAYER_COUNT];
+
+static void sample_heap(void) {
+  uint32_t used = heap_bytes_used();
+  uint32_t free = heap_bytes_free();
+
+  if(used > currentRecord.heapUsedMax) {
+    currentRecord.heapUsedMax = used;
+  }
+
+  if(free < currentRecord.heapFreeMin) {
+    currentRecord.heapFreeMin = free;
+  }
+}
+
+static void start_record(void) {
+  memset(&currentRecord, 0, sizeof(ProfileRecord));
+
+  currentRecord.startTime = time(NULL);
+  currentRecord.heapFreeMin = UINT32_MAX;
+
+  sample_heap();
+}
+
+static void store_record(void) {
+  if(recordCount == PROFILING_RECORD_COUNT) {
+    // the oldest record may be in the outbox, then the new one is lost instead
+    if(sending) {
+      return;
+    }
+
+    firstRecord = (firstRecord + 1) % PROFILING_RECORD_COUNT;
+    recordCount--;
+  }
+
+  records[(firstRecord + recordCount) % PROFILING_RECORD_COUNT] = currentRecord;
+  recordCount++;
+}
+
+static void send_next_record(void) {
+  DictionaryIterator *iter;
+
+  sending = false;
+
+  if(recordCount == 0 || app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    return;
+  }
+
+  dict_write_data(iter, MESSAGE_KEY_ProfilingRecord, (const uint8_t*)&records[firstRecord], sizeof(ProfileRecord));
+
+  sending = (app_message_outbox_send() == APP_MSG_OK);
+}
+
+void Profiling_outboxSent(void) {
+  // the weather requests go through the same outbox
+  if(!sending) {
+    return;
+  }
+
+  firstRecord = (firstRecord + 1) % PROFILING_RECORD_COUNT;
+  recordCount--;
+
+  send_next_record();
+}
+
+void Profiling_outboxFailed(void) {
+  // the records are kept, and sent again once the buffer is full
+  sending = false;
+}
+
+void Profiling_init(void) {
+  firstRecord = 0;
+  recordCount = 0;
+  sending = false;
+
+  start_record();
+}
+
+void Profiling_deinit(void) {
+}
+
+void Profiling_renderStart(ProfileLayer layer) {
+  renderStartMs[layer] = time_ms(&renderStartSeconds[layer], NULL);
+}
+
+void Profiling_renderEnd(ProfileLayer layer) {
+  time_t seconds;
+  uint16_t ms = time_ms(&seconds, NULL);
+  uint16_t elapsed = (seconds - renderStartSeconds[layer]) * 1000 + ms - renderStartMs[layer];
+
+  currentRecord.renderCount[layer]++;
+  currentRecord.renderMs[layer] += elapsed;
+
+  if(elapsed > currentRecord.renderMaxMs[layer]) {
+    currentRecord.renderMaxMs[layer] = elapsed;
+  }
+
+  // the heap peaks while the layers are drawn
+  sample_heap();
+}
+
+void Profiling_count(ProfileCounter counter, uint32_t amount) {
+  currentRecord.counters[counter] += amount;
+}
+
+void Profiling_tick(TimeUnits units_changed) {
+  currentRecord.counters[PROFILE_TICKS]++;
+
+  if(!(units_changed & MINUTE_UNIT)) {
+    return;
+  }
+
+  sample_heap();
+  store_record();
+  start_record();
+
+  if(recordCount == PROFILING_RECORD_COUNT) {
+    Profiling_send();
+  }
+}
+
+void Profiling_send(void) {
+  if(!sending) {
+    send_next_record();
+  }
+}
+
+#endif
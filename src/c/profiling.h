@@ -0,0 +1,90 @@
+#pragma once
+#include <pebble.h>
+
+// uncomment to record the render times, the event counts and the heap usage
+// of each minute, and to send them to the phone, which logs them as CSV
+// #define PROFILING
+
+// the layers whose rendering is timed
+typedef enum {
+  PROFILE_LAYER_CLOCK   = 0,
+  PROFILE_LAYER_SIDEBAR = 1,
+  PROFILE_LAYER_WIDGETS = 2,
+  PROFILE_LAYER_COUNT
+} ProfileLayer;
+
+// the events which are counted
+typedef enum {
+  PROFILE_TICKS            = 0,
+  PROFILE_MESSAGES_IN      = 1,
+  PROFILE_BYTES_IN         = 2,
+  PROFILE_MESSAGES_OUT     = 3,
+  PROFILE_BYTES_OUT        = 4,
+  PROFILE_PERSIST_WRITES   = 5,
+  PROFILE_PERSIST_BYTES    = 6,
+  PROFILE_COUNTER_COUNT
+} ProfileCounter;
+
+#ifdef PROFILING
+
+// the number of minutes kept on the watch, they are sent when all are recorded
+#define PROFILING_RECORD_COUNT 10
+
+// the outbox must hold a whole record
+#define PROFILING_OUTBOX_SIZE 128
+
+/*
+ * What happened during one minute. The phone decodes it from a byte array,
+ * see src/pkjs/profiling.js
+ */
+typedef struct __attribute__((__packed__)) {
+  uint32_t startTime;
+  uint16_t renderCount[PROFILE_LAYER_COUNT];
+  uint16_t renderMs[PROFILE_LAYER_COUNT];
+  uint16_t renderMaxMs[PROFILE_LAYER_COUNT];
+  uint32_t counters[PROFILE_COUNTER_COUNT];
+  uint32_t heapUsedMax;
+  uint32_t heapFreeMin;
+} ProfileRecord;
+
+void Profiling_init(void);
+void Profiling_deinit(void);
+
+/*
+ * Times the update proc of a layer, calls can't be nested for the same layer
+ */
+void Profiling_renderStart(ProfileLayer layer);
+void Profiling_renderEnd(ProfileLayer layer);
+
+void Profiling_count(ProfileCounter counter, uint32_t amount);
+
+/*
+ * Counts the tick, and records the elapsed minute when the minute changes
+ */
+void Profiling_tick(TimeUnits units_changed);
+
+/*
+ * Sends the recorded minutes to the phone, one message per record
+ */
+void Profiling_send(void);
+
+/*
+ * The outbox callbacks, the messaging forwards them as it owns the outbox
+ */
+void Profiling_outboxSent(void);
+void Profiling_outboxFailed(void);
+
+#else
+
+// everything is compiled out
+#define Profiling_init()
+#define Profiling_deinit()
+#define Profiling_renderStart(layer)
+#define Profiling_renderEnd(layer)
+#define Profiling_count(counter, amount)
+#define Profiling_tick(units_changed)
+#define Profiling_send()
+#define Profiling_outboxSent()
+#define Profiling_outboxFailed()
+
+#endif
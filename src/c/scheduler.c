@@ -0,0 +1,81 @@
+#include <pebble.h>
+#include "scheduler.h"
+
+// the scheduled jobs, sorted by due time
+static SchedulerJob* firstJob;
+
+static void insert_job(SchedulerJob* job) {
+  SchedulerJob** link = &firstJob;
+
+  // jobs due at the same time run in the order they were scheduled
+  while(*link && (*link)->due <= job->due) {
+    link = &(*link)->next;
+  }
+
+  job->next = *link;
+  job->scheduled = true;
+  *link = job;
+}
+
+void Scheduler_cancel(SchedulerJob* job) {
+  if(!job->scheduled) {
+    return;
+  }
+
+  for(SchedulerJob** link = &firstJob; *link; link = &(*link)->next) {
+    if(*link == job) {
+      *link = job->next;
+      break;
+    }
+  }
+
+  job->next = NULL;
+  job->scheduled = false;
+}
+
+void Scheduler_schedule(SchedulerJob* job, SchedulerCallback callback, time_t due, uint32_t period) {
+  Scheduler_cancel(job);
+
+  job->callback = callback;
+  job->due = due;
+  job->period = period;
+
+  insert_job(job);
+}
+
+uint16_t Scheduler_run(time_t now) {
+  uint16_t changes = CHANGED_NONE;
+
+  while(firstJob && firstJob->due <= now) {
+    SchedulerJob* job = firstJob;
+
+    firstJob = job->next;
+    job->next = NULL;
+    job->scheduled = false;
+
+    if(job->period > 0) {
+      // skip the runs missed while the watchface wasn't ticking
+      do {
+        job->due += job->period;
+      } while(job->due <= now);
+
+      insert_job(job);
+    }
+
+    // the callback may schedule or cancel its own job
+    changes |= job->callback(now);
+  }
+
+  return changes;
+}
+
+time_t Scheduler_nextLocalTime(time_t now, uint32_t period, uint32_t offset) {
+  time_t midnight = time_start_of_today();
+  time_t next = midnight + offset;
+
+  if(next <= now) {
+    next += ((now - next) / period + 1) * period;
+  }
+
+  return next;
+}
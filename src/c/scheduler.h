@@ -0,0 +1,39 @@
+#pragma once
+#include <pebble.h>
+#include "changes.h"
+
+/*
+ * A job runs its callback once it is due, and returns a ChangeMask of what it
+ * changed on screen. The jobs are owned by their modules, usually as statics
+ */
+typedef uint16_t (*SchedulerCallback)(time_t now);
+
+typedef struct SchedulerJob {
+  SchedulerCallback callback;
+  time_t due;
+
+  // in seconds, zero for one-shot jobs
+  uint32_t period;
+
+  bool scheduled;
+  struct SchedulerJob* next;
+} SchedulerJob;
+
+/*
+ * Schedules the job at the given time, replacing its previous schedule.
+ * Periodic jobs are scheduled again period seconds after each run
+ */
+void Scheduler_schedule(SchedulerJob* job, SchedulerCallback callback, time_t due, uint32_t period);
+void Scheduler_cancel(SchedulerJob* job);
+
+/*
+ * Runs the jobs which are due, and returns the ChangeMask of their changes.
+ * It only compares the time with the first job when nothing is due
+ */
+uint16_t Scheduler_run(time_t now);
+
+/*
+ * Returns the first time after now which is offset seconds after a multiple
+ * of period since the local midnight, e.g. the next half hour
+ */
+time_t Scheduler_nextLocalTime(time_t now, uint32_t period, uint32_t offset);
@@ -1,9 +1,18 @@
 #include <pebble.h>
 #include "clock_area.h"
 #include "settings.h"
+#include "tz_rules.h"
+#include "storage.h"
 
 Settings globalSettings;
 
+// the settings as they are persisted, and their version
+static StoredSettings storedSettings;
+static int32_t storedSettingsVersion = CURRENT_SETTINGS_VERSION;
+
+static StorageRecord settingsRecord;
+static StorageRecord versionRecord;
+
 /*
  * Load defaults settings
  */
@@ -62,6 +71,9 @@ void Settings_loadDefaultsSettings(void) {
   globalSettings.decimalSeparator       = '.';
   strncpy(globalSettings.altclockName, "ALT", sizeof(globalSettings.altclockName));
   globalSettings.altclockOffset         = 0;
+  globalSettings.altclockZone           = TZ_ZONE_NONE;
+  globalSettings.weatherTTL             = 0;
+  globalSettings.configHash             = 0;
   globalSettings.activateDisconnectIcon = true;
   globalSettings.centerTime             = false;
 }
@@ -70,7 +82,6 @@ void Settings_loadDefaultsSettings(void) {
  * Load the saved color settings
  */
 void Settings_loadFromStorage(void) {
-  StoredSettings storedSettings;
   memset(&storedSettings,0,sizeof(StoredSettings));
   // if previous version settings are used than only first part of settings would be overwritten,
   // all the other fields will left filled with zeroes
@@ -101,13 +112,16 @@ void Settings_loadFromStorage(void) {
   globalSettings.decimalSeparator = storedSettings.decimalSeparator;
   memcpy(globalSettings.altclockName, storedSettings.altclockName, 8);
   globalSettings.altclockOffset = storedSettings.altclockOffset;
+  globalSettings.altclockZone = storedSettings.altclockZone;
+  globalSettings.weatherTTL = storedSettings.weatherTTL;
+  globalSettings.configHash = storedSettings.configHash;
   globalSettings.activateDisconnectIcon = storedSettings.activateDisconnectIcon;
   globalSettings.centerTime = storedSettings.centerTime;
 }
 
 void Settings_saveToStorage(void) {
-  // save settings to compressed structure and to persistent storage
-  StoredSettings storedSettings;
+  // save settings to compressed structure, which is written to persistent storage
+  // once the messages of the config are all in, if it changed
   // if previous version settings are used than only first part of settings would be overwrited
   // all the other fields will left filled with zeroes
   storedSettings.timeColor = globalSettings.timeColor;
@@ -135,12 +149,15 @@ void Settings_saveToStorage(void) {
   storedSettings.decimalSeparator = globalSettings.decimalSeparator;
   memcpy(storedSettings.altclockName, globalSettings.altclockName, 8);
   storedSettings.altclockOffset = globalSettings.altclockOffset;
+  storedSettings.altclockZone = globalSettings.altclockZone;
+  storedSettings.weatherTTL = globalSettings.weatherTTL;
+  storedSettings.configHash = globalSettings.configHash;
   storedSettings.sidebarLocation = globalSettings.sidebarLocation;
   storedSettings.activateDisconnectIcon = globalSettings.activateDisconnectIcon;
   storedSettings.centerTime = globalSettings.centerTime;
 
-  persist_write_data(SETTING_VERSION6_AND_HIGHER, &storedSettings, sizeof(StoredSettings));
-  persist_write_int(SETTINGS_VERSION_KEY, CURRENT_SETTINGS_VERSION);
+  Storage_markDirty(&settingsRecord);
+  Storage_markDirty(&versionRecord);
 }
 
 void Settings_updateDynamicSettings(void) {
@@ -149,6 +166,7 @@ void Settings_updateDynamicSettings(void) {
   globalSettings.enableAutoBatteryWidget = true;
   globalSettings.enableBeats = false;
   globalSettings.enableAltTimeZone = false;
+  globalSettings.enableHealth = false;
 
   for(int i = 0; i < 4; i++) {
     // if there are any weather widgets, enable weather checking
@@ -176,8 +194,17 @@ void Settings_updateDynamicSettings(void) {
     if(globalSettings.widgets[i] == ALT_TIME_ZONE) {
       globalSettings.enableAltTimeZone = true;
     }
+
+    // if any widget displays health data, poll the health service
+    if(globalSettings.widgets[i] == HEALTH || globalSettings.widgets[i] == HEARTRATE ||
+       globalSettings.widgets[i] == SLEEP || globalSettings.widgets[i] == STEP) {
+      globalSettings.enableHealth = true;
+    }
   }
 
+  GColor previousIconFillColor = globalSettings.iconFillColor;
+  GColor previousIconStrokeColor = globalSettings.iconStrokeColor;
+
   // temp: if the sidebar is black, use inverted colors for icons
   if(gcolor_equal(globalSettings.sidebarColor, GColorBlack)) {
     globalSettings.iconFillColor = GColorBlack;
@@ -186,6 +213,17 @@ void Settings_updateDynamicSettings(void) {
     globalSettings.iconFillColor = GColorWhite;
     globalSettings.iconStrokeColor = GColorBlack;
   }
+
+  // tell the icons they need to be recolored
+  if(globalSettings.iconPaletteGeneration == 0 ||
+     !gcolor_equal(globalSettings.iconFillColor, previousIconFillColor) ||
+     !gcolor_equal(globalSettings.iconStrokeColor, previousIconStrokeColor)) {
+    globalSettings.iconPaletteGeneration++;
+
+    if(globalSettings.iconPaletteGeneration == 0) {
+      globalSettings.iconPaletteGeneration = 1;
+    }
+  }
 }
 
 void Settings_init(void) {
@@ -199,11 +237,15 @@ void Settings_init(void) {
     // load all settings
     Settings_loadFromStorage();
   }
+
+  Storage_track(&settingsRecord, SETTING_VERSION6_AND_HIGHER, &storedSettings, sizeof(StoredSettings));
+  Storage_track(&versionRecord, SETTINGS_VERSION_KEY, &storedSettingsVersion, sizeof(storedSettingsVersion));
+
   Settings_updateDynamicSettings();
 }
 
 void Settings_deinit(void) {
-  // write all settings to storage
+  // write all settings to storage, if they changed
   Settings_saveToStorage();
 }
 
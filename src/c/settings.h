@@ -106,6 +106,13 @@ typedef struct {
   // alt tz widget settings
   char altclockName[8];
   int altclockOffset;
+  uint8_t altclockZone;
+
+  // weather widget settings, in minutes, 0 for the default TTL
+  uint16_t weatherTTL;
+
+  // identifies the config the phone last sent, 0 if unknown
+  uint32_t configHash;
 
   // health widget Settings
   ActivityDisplayType healthActivityDisplay;
@@ -118,10 +125,14 @@ typedef struct {
   bool enableAutoBatteryWidget;
   bool enableBeats;
   bool enableAltTimeZone;
+  bool enableHealth;
 
   // TODO: these shouldn't be dynamic
   GColor iconFillColor;
   GColor iconStrokeColor;
+
+  // incremented whenever the icon colors change, never 0
+  uint16_t iconPaletteGeneration;
 } Settings;
 
 
@@ -173,6 +184,15 @@ typedef struct {
   char languageDayNames[7][8];
   char languageMonthNames[12][8];
   char languageWordForWeek[12];
+
+  // alt tz widget zone, zero in the settings saved before it
+  uint8_t altclockZone;
+
+  // weather TTL in minutes, zero for the default
+  uint16_t weatherTTL;
+
+  // the hash of the config the phone last sent, zero makes it send everything
+  uint32_t configHash;
 } StoredSettings;
 
 extern Settings globalSettings;
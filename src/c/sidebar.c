@@ -5,6 +5,7 @@
 #include "sidebar.h"
 #include "sidebar_widgets.h"
 #include "util.h"
+#include "profiling.h"
 
 #define V_PADDING_DEFAULT 8
 #define V_PADDING_COMPACT 4
@@ -13,6 +14,68 @@
 #define HORIZONTAL_BAR_HEIGHT FIXED_WIDGET_HEIGHT
 #define RECT_WIDGETS_XOFFSET ((ACTION_BAR_WIDTH - 30) / 2)
 
+// any widget can be replaced by the auto battery or the disconnection icon,
+// so the sidebar also depends on the battery and bluetooth states
+#define REPLACEMENT_DEPENDENCIES (CHANGED_BATTERY | CHANGED_BLUETOOTH)
+
+// widgets draw their text slightly outside of their nominal height and width,
+// so each widget layer gets this margin around the widget
+#define WIDGET_LAYER_MARGIN 10
+
+#ifdef PBL_ROUND
+  #define WIDGET_LAYER_COUNT 2
+#else
+  #define WIDGET_LAYER_COUNT 4
+#endif
+
+// the widget slots of the settings
+#define WIDGET_SLOT_COUNT 4
+
+// the slots displayed by the left and right sidebars of rectangular watches
+#define RECT_VERTICAL_SLOT_COUNT 3
+
+// and the minimum number of positions of their top and bottom bars
+#define RECT_HORIZONTAL_MIN_SLOT_COUNT 3
+
+typedef struct {
+  SidebarWidget widget;
+  int xOffset;
+} WidgetLayerData;
+
+// where a widget layer goes in the sidebar
+typedef struct {
+  SidebarWidget widget;
+  int16_t x;
+  int16_t y;
+  int16_t height;
+  int xOffset;
+} WidgetPlacement;
+
+// everything the placement of the widgets depends on,
+// besides the content of the widgets listed by heightDependencies
+typedef struct {
+  BarLocationType location;
+  bool largeFonts;
+  int16_t unobstructedHeight;
+
+  // the widget displayed in each slot, after the replacements
+  SidebarWidgetType types[WIDGET_SLOT_COUNT];
+} WidgetLayoutInputs;
+
+typedef struct {
+  WidgetLayoutInputs inputs;
+  bool valid;
+
+  bool compactMode;
+  bool fixedHeight;
+
+  uint8_t placementCount;
+  WidgetPlacement placements[WIDGET_LAYER_COUNT];
+
+  // ChangeMask of the inputs which can change the height of the placed widgets
+  uint16_t heightDependencies;
+} WidgetLayout;
+
 static GRect screen_rect;
 static Layer* sidebarLayer;
 
@@ -20,6 +83,12 @@ static Layer* sidebarLayer;
   static Layer* sidebarLayer2;
 #endif
 
+// each widget is drawn in its own layer, on top of the sidebar background
+static Layer* widgetLayers[WIDGET_LAYER_COUNT];
+
+// the current placement of the widget layers, solved again only when its inputs change
+static WidgetLayout widgetLayout;
+
 static bool isAutoBatteryShown(void) {
   if(!globalSettings.disableAutobattery) {
     BatteryChargeState chargeState = battery_state_service_peek();
@@ -82,25 +151,97 @@ static int getReplacableWidget(void) {
 }
 #endif
 
-#ifdef PBL_ROUND
-static SidebarWidget getRoundSidebarWidget(int widgetNumber) {
-  bool showDisconnectIcon = !bluetooth_connection_service_peek();
+static void updateWidgetLayer(Layer *l, GContext* ctx) {
+  WidgetLayerData* data = layer_get_data(l);
+
+  Profiling_renderStart(PROFILE_LAYER_WIDGETS);
+
+  graphics_context_set_text_color(ctx, globalSettings.sidebarTextColor);
+  SidebarWidgets_xOffset = data->xOffset;
+
+  data->widget.draw(ctx, WIDGET_LAYER_MARGIN, WIDGET_LAYER_MARGIN);
+
+  Profiling_renderEnd(PROFILE_LAYER_WIDGETS);
+}
+
+/*
+ * Moves the widget layer so that the widget is drawn at its position
+ * in the parent layer
+ */
+static void placeWidgetLayer(int layerNumber, const WidgetPlacement* placement) {
+  Layer* layer = widgetLayers[layerNumber];
+  WidgetLayerData* data = layer_get_data(layer);
+
+  data->widget = placement->widget;
+  data->xOffset = placement->xOffset;
+
+  layer_set_frame(layer, GRect(placement->x - WIDGET_LAYER_MARGIN,
+                               placement->y - WIDGET_LAYER_MARGIN,
+                               ACTION_BAR_WIDTH + WIDGET_LAYER_MARGIN * 2,
+                               placement->height + WIDGET_LAYER_MARGIN * 2));
+  layer_set_hidden(layer, false);
+}
+
+static WidgetPlacement* addPlacement(WidgetLayout* layout, SidebarWidgetType type) {
+  WidgetPlacement* placement = &layout->placements[layout->placementCount++];
+
+  placement->widget = getSidebarWidgetByType(type);
+  layout->heightDependencies |= placement->widget.heightDependencies;
+
+  return placement;
+}
+
+// the heights depend on the compact mode and fixed height flags
+static int16_t measurePlacements(WidgetLayout* layout) {
+  int16_t totalHeight = 0;
+
+  SidebarWidgets_useCompactMode = layout->compactMode;
+  SidebarWidgets_fixedHeight = layout->fixedHeight;
+
+  for(int i = 0; i < layout->placementCount; i++) {
+    layout->placements[i].height = layout->placements[i].widget.getHeight();
+    totalHeight += layout->placements[i].height;
+  }
+
+  return totalHeight;
+}
+
+/*
+ * Collects what the widget layout depends on, including the widgets
+ * replaced by the auto battery or the disconnection icon
+ */
+static void getLayoutInputs(WidgetLayoutInputs* inputs) {
   bool showAutoBattery = isAutoBatteryShown();
 
-  SidebarWidgetType displayWidget = globalSettings.widgets[widgetNumber];
+  #ifdef PBL_ROUND
+    bool showDisconnectIcon = !bluetooth_connection_service_peek();
+  #else
+    // if the pebble is disconnected and activated, show the disconnect icon
+    bool showDisconnectIcon = globalSettings.activateDisconnectIcon && !bluetooth_connection_service_peek();
+  #endif
 
-  if((showAutoBattery || showDisconnectIcon) && getReplacableWidget() == widgetNumber) {
-    if(showAutoBattery) {
-      displayWidget = BATTERY_METER;
-    } else if(showDisconnectIcon) {
-      displayWidget = BLUETOOTH_DISCONNECT;
-    }
+  memset(inputs, 0, sizeof(WidgetLayoutInputs));
+
+  inputs->location = globalSettings.sidebarLocation;
+  inputs->largeFonts = globalSettings.useLargeFonts;
+  inputs->unobstructedHeight = layer_get_unobstructed_bounds(sidebarLayer).size.h;
+
+  for(int i = 0; i < WIDGET_SLOT_COUNT; i++) {
+    inputs->types[i] = globalSettings.widgets[i];
   }
 
-  return getSidebarWidgetByType(displayWidget);
+  // do we need to replace a widget?
+  if(showAutoBattery) {
+    inputs->types[getReplacableWidget()] = BATTERY_METER;
+  } else if(showDisconnectIcon) {
+    inputs->types[getReplacableWidget()] = BLUETOOTH_DISCONNECT;
+  }
 }
 
-static void drawRoundSidebar(GContext* ctx, GRect bgBounds, SidebarWidget widget, int widgetXPosition, int widgetYPosition, int widgetXOffset) {
+#ifdef PBL_ROUND
+static void drawRoundSidebar(Layer *l, GContext* ctx, GRect bgBounds) {
+  Profiling_renderStart(PROFILE_LAYER_SIDEBAR);
+
   graphics_context_set_fill_color(ctx, globalSettings.sidebarColor);
 
   graphics_fill_radial(ctx,
@@ -110,10 +251,7 @@ static void drawRoundSidebar(GContext* ctx, GRect bgBounds, SidebarWidget widget
                        DEG_TO_TRIGANGLE(0),
                        TRIG_MAX_ANGLE);
 
-  graphics_context_set_text_color(ctx, globalSettings.sidebarTextColor);
-  SidebarWidgets_xOffset = widgetXOffset;
-
-  widget.draw(ctx, widgetXPosition, widgetYPosition);
+  Profiling_renderEnd(PROFILE_LAYER_SIDEBAR);
 }
 
 static GRect getRoundSidebarBounds1(void) {
@@ -136,77 +274,66 @@ static GRect getRoundSidebarBounds2(void) {
   }
 }
 
-static void updateRoundSidebarRight(Layer *l, GContext* ctx) {
-  GRect bounds = layer_get_bounds(l);
-  GRect bgBounds = GRect(bounds.origin.x, bounds.size.h / -2, bounds.size.h * 2, bounds.size.h * 2);
-
-  SidebarWidget widget = getRoundSidebarWidget(2);
-
-  // calculate center position of the widget
-  int widgetYPosition = bgBounds.size.h / 4 - widget.getHeight() / 2;
-
-  drawRoundSidebar(ctx, bgBounds, widget, 0, widgetYPosition, 3);
+static GRect getRoundSidebarBgBounds1(GRect bounds) {
+  if(globalSettings.sidebarLocation == RIGHT || globalSettings.sidebarLocation == LEFT) {
+    return GRect(bounds.origin.x - bounds.size.h * 2 + bounds.size.w, bounds.size.h / -2, bounds.size.h * 2, bounds.size.h * 2);
+  } else {
+    return GRect(bounds.size.w / -2, bounds.origin.y - bounds.size.w * 2 + bounds.size.h, bounds.size.w * 2, bounds.size.w * 2);
+  }
 }
 
-static void updateRoundSidebarLeft(Layer *l, GContext* ctx) {
-  GRect bounds = layer_get_bounds(l);
-  GRect bgBounds = GRect(bounds.origin.x - bounds.size.h * 2 + bounds.size.w, bounds.size.h / -2, bounds.size.h * 2, bounds.size.h * 2);
-
-  SidebarWidget widget = getRoundSidebarWidget(0);
-
-  // calculate center position of the widget
-  int widgetYPosition = bgBounds.size.h / 4 - widget.getHeight() / 2;
-
-  drawRoundSidebar(ctx, bgBounds, widget, 0, widgetYPosition, 7);
+static GRect getRoundSidebarBgBounds2(GRect bounds) {
+  if(globalSettings.sidebarLocation == RIGHT || globalSettings.sidebarLocation == LEFT) {
+    return GRect(bounds.origin.x, bounds.size.h / -2, bounds.size.h * 2, bounds.size.h * 2);
+  } else {
+    return GRect(bounds.size.w / -2, bounds.origin.y, bounds.size.w * 2, bounds.size.w * 2);
+  }
 }
 
-static void updateRoundSidebarBottom(Layer *l, GContext* ctx) {
-  GRect bounds = layer_get_bounds(l);
-  GRect bgBounds = GRect(bounds.size.w / -2, bounds.origin.y, bounds.size.w * 2, bounds.size.w * 2);
-
-  SidebarWidget widget = getRoundSidebarWidget(2);
-
-  // use compact mode and fixed height for bottom and top widget
-  SidebarWidgets_useCompactMode = true;
-  SidebarWidgets_fixedHeight = true;
-
-  // calculate center position of the widget
-  int widgetXPosition = bgBounds.size.w / 4 - ACTION_BAR_WIDTH / 2;
-  int widgetYPosition = (HORIZONTAL_BAR_HEIGHT - widget.getHeight()) / 2;
-
-  drawRoundSidebar(ctx, bgBounds, widget, widgetXPosition, widgetYPosition, 5);
+static void updateRoundSidebar1(Layer *l, GContext* ctx) {
+  drawRoundSidebar(l, ctx, getRoundSidebarBgBounds1(layer_get_bounds(l)));
 }
 
-static void updateRoundSidebarTop(Layer *l, GContext* ctx) {
-  GRect bounds = layer_get_bounds(l);
-  GRect bgBounds = GRect(bounds.size.w / -2, bounds.origin.y - bounds.size.w * 2 + bounds.size.h, bounds.size.w * 2, bounds.size.w * 2);
-
-  SidebarWidget widget = getRoundSidebarWidget(0);
-
-  // use compact mode and fixed height for bottom and top widget
-  SidebarWidgets_useCompactMode = true;
-  SidebarWidgets_fixedHeight = true;
-
-  // calculate center position of the widget
-  int widgetXPosition = bgBounds.size.w / 4 - ACTION_BAR_WIDTH / 2;
-  int widgetYPosition = (HORIZONTAL_BAR_HEIGHT - widget.getHeight()) / 2;
-
-  drawRoundSidebar(ctx, bgBounds, widget, widgetXPosition, widgetYPosition, 5);
+static void updateRoundSidebar2(Layer *l, GContext* ctx) {
+  drawRoundSidebar(l, ctx, getRoundSidebarBgBounds2(layer_get_bounds(l)));
 }
 
-static void updateRoundSidebar1(Layer *l, GContext* ctx) {
-  if(globalSettings.sidebarLocation == RIGHT || globalSettings.sidebarLocation == LEFT) {
-    updateRoundSidebarLeft(l, ctx);
-  } else if(globalSettings.sidebarLocation == BOTTOM || globalSettings.sidebarLocation == TOP) {
-    updateRoundSidebarTop(l, ctx);
-  }
-}
+/*
+ * Centers the widget displayed by each round sidebar in its visible part:
+ * the left/top layer displays the first widget, the right/bottom layer the third one
+ */
+static void solveRoundLayout(WidgetLayout* layout) {
+  WidgetPlacement* placement1 = addPlacement(layout, layout->inputs.types[0]);
+  WidgetPlacement* placement2 = addPlacement(layout, layout->inputs.types[2]);
 
-static void updateRoundSidebar2(Layer *l, GContext* ctx) {
   if(globalSettings.sidebarLocation == RIGHT || globalSettings.sidebarLocation == LEFT) {
-    updateRoundSidebarRight(l, ctx);
+    layout->compactMode = false;
+    layout->fixedHeight = false;
+    measurePlacements(layout);
+
+    GRect bgBounds = getRoundSidebarBgBounds1(layer_get_bounds(sidebarLayer));
+    placement1->x = 0;
+    placement1->y = bgBounds.size.h / 4 - placement1->height / 2;
+    placement1->xOffset = 7;
+
+    bgBounds = getRoundSidebarBgBounds2(layer_get_bounds(sidebarLayer2));
+    placement2->x = 0;
+    placement2->y = bgBounds.size.h / 4 - placement2->height / 2;
+    placement2->xOffset = 3;
   } else if(globalSettings.sidebarLocation == BOTTOM || globalSettings.sidebarLocation == TOP) {
-    updateRoundSidebarBottom(l, ctx);
+    // use compact mode and fixed height for bottom and top widget
+    layout->compactMode = true;
+    layout->fixedHeight = true;
+    measurePlacements(layout);
+
+    GRect bgBounds = getRoundSidebarBgBounds1(layer_get_bounds(sidebarLayer));
+    int widgetXPosition = bgBounds.size.w / 4 - ACTION_BAR_WIDTH / 2;
+
+    for(int i = 0; i < layout->placementCount; i++) {
+      layout->placements[i].x = widgetXPosition;
+      layout->placements[i].y = (HORIZONTAL_BAR_HEIGHT - layout->placements[i].height) / 2;
+      layout->placements[i].xOffset = 5;
+    }
   }
 }
 
@@ -229,124 +356,123 @@ static GRect getRectSidebarBounds(void) {
 static void updateRectSidebar(Layer *l, GContext* ctx) {
   GRect bounds = layer_get_bounds(l);
 
-  // this ends up being zero on every rectangular platform besides emery
-  SidebarWidgets_xOffset = RECT_WIDGETS_XOFFSET;
+  Profiling_renderStart(PROFILE_LAYER_SIDEBAR);
 
   graphics_context_set_fill_color(ctx, globalSettings.sidebarColor);
   graphics_fill_rect(ctx, bounds, 0, GCornerNone);
 
-  graphics_context_set_text_color(ctx, globalSettings.sidebarTextColor);
+  Profiling_renderEnd(PROFILE_LAYER_SIDEBAR);
+}
 
-  // if the pebble is disconnected, show the disconnect icon
-  bool showDisconnectIcon = false;
-  bool showAutoBattery = isAutoBatteryShown();
-  int widget_to_replace = -1;
+/*
+ * Spreads the widgets over the width of the top or bottom bar, from the left
+ * edge to the right edge, vertically centered
+ */
+static void solveRectHorizontalLayout(WidgetLayout* layout, GRect bounds) {
+  bool shown[WIDGET_SLOT_COUNT];
+  int slotCount = WIDGET_SLOT_COUNT;
+
+  // empty slots leave their position to the next widgets, while there are enough positions
+  for(int i = 0; i < WIDGET_SLOT_COUNT; i++) {
+    shown[i] = true;
+  }
+
+  for(int i = WIDGET_SLOT_COUNT - 1; i > 0 && slotCount > RECT_HORIZONTAL_MIN_SLOT_COUNT; i--) {
+    if(layout->inputs.types[i] == EMPTY) {
+      shown[i] = false;
+      slotCount--;
+    }
+  }
 
-  // if the pebble is disconnected and activated, show the disconnect icon
-  if(globalSettings.activateDisconnectIcon) {
-    showDisconnectIcon = !bluetooth_connection_service_peek();
+  for(int i = 0; i < WIDGET_SLOT_COUNT; i++) {
+    if(shown[i]) {
+      addPlacement(layout, layout->inputs.types[i]);
+    }
   }
 
-  SidebarWidget displayWidgets[4];
+  // use compact mode and fixed height for bottom and top widget
+  layout->compactMode = true;
+  layout->fixedHeight = true;
+  measurePlacements(layout);
 
-  displayWidgets[0] = getSidebarWidgetByType(globalSettings.widgets[0]);
-  displayWidgets[1] = getSidebarWidgetByType(globalSettings.widgets[1]);
-  displayWidgets[2] = getSidebarWidgetByType(globalSettings.widgets[2]);
-  if(globalSettings.sidebarLocation == BOTTOM || globalSettings.sidebarLocation == TOP) {
-    displayWidgets[3] = getSidebarWidgetByType(globalSettings.widgets[3]);
+  int spacing = bounds.size.w - 2 * H_PADDING_DEFAULT - ACTION_BAR_WIDTH;
+
+  for(int i = 0; i < layout->placementCount; i++) {
+    WidgetPlacement* placement = &layout->placements[i];
+
+    placement->x = H_PADDING_DEFAULT + i * spacing / (layout->placementCount - 1);
+    placement->y = (HORIZONTAL_BAR_HEIGHT - placement->height) / 2;
   }
 
-  // do we need to replace a widget?
-  // if so, determine which widget should be replaced
-  if(showAutoBattery || showDisconnectIcon) {
-    widget_to_replace = getReplacableWidget();
-
-    if(showAutoBattery) {
-      displayWidgets[widget_to_replace] = getSidebarWidgetByType(BATTERY_METER);
-    } else { // showDisconnectIcon
-      displayWidgets[widget_to_replace] = getSidebarWidgetByType(BLUETOOTH_DISCONNECT);
-    }
+  // with four widgets, the middle ones keep their original positions, which
+  // split the bar in quarters rather than spreading the widgets evenly
+  if(layout->placementCount == 4) {
+    layout->placements[1].x = (bounds.size.w - 5 * H_PADDING_DEFAULT) / 4 + 2 * H_PADDING_DEFAULT;
+    layout->placements[2].x = (bounds.size.w - 5 * H_PADDING_DEFAULT) / 2 + 3 * H_PADDING_DEFAULT;
   }
+}
 
-  int v_padding;
-  int middleWidgetPos;
+/*
+ * Places the first widget at the top, the last one at the bottom, and the
+ * others evenly between them. When the widgets are too tall, they are
+ * compacted first, then their padding is reduced
+ */
+static void solveRectVerticalLayout(WidgetLayout* layout) {
+  int16_t availableHeight = layout->inputs.unobstructedHeight;
 
-  if(globalSettings.sidebarLocation == BOTTOM || globalSettings.sidebarLocation == TOP) {
-    // calculate the three horizontal widget positions
-    middleWidgetPos = (bounds.size.w - ACTION_BAR_WIDTH) / 2;
-    int rightWidgetPos = bounds.size.w - H_PADDING_DEFAULT - ACTION_BAR_WIDTH;
+  for(int i = 0; i < RECT_VERTICAL_SLOT_COUNT; i++) {
+    addPlacement(layout, layout->inputs.types[i]);
+  }
 
-    // use compact mode and fixed height for bottom and top widget
-    SidebarWidgets_useCompactMode = true;
-    SidebarWidgets_fixedHeight = true;
-
-    // draw the widgets
-    v_padding= (HORIZONTAL_BAR_HEIGHT - displayWidgets[0].getHeight()) / 2;
-    displayWidgets[0].draw(ctx, H_PADDING_DEFAULT, v_padding);
-
-    if(globalSettings.widgets[3] == EMPTY && widget_to_replace != 3) {
-      v_padding = (HORIZONTAL_BAR_HEIGHT - displayWidgets[1].getHeight()) / 2;
-      displayWidgets[1].draw(ctx, middleWidgetPos, v_padding);
-
-      v_padding = (HORIZONTAL_BAR_HEIGHT - displayWidgets[2].getHeight()) / 2;
-      displayWidgets[2].draw(ctx, rightWidgetPos, v_padding);
-    }else if(globalSettings.widgets[2] == EMPTY) {
-      v_padding = (HORIZONTAL_BAR_HEIGHT - displayWidgets[1].getHeight()) / 2;
-      displayWidgets[1].draw(ctx, middleWidgetPos, v_padding);
-
-      v_padding = (HORIZONTAL_BAR_HEIGHT - displayWidgets[3].getHeight()) / 2;
-      displayWidgets[3].draw(ctx, rightWidgetPos, v_padding);
-    }else if(globalSettings.widgets[1] == EMPTY) {
-      v_padding = (HORIZONTAL_BAR_HEIGHT - displayWidgets[2].getHeight()) / 2;
-      displayWidgets[2].draw(ctx, middleWidgetPos, v_padding);
-
-      v_padding = (HORIZONTAL_BAR_HEIGHT - displayWidgets[3].getHeight()) / 2;
-      displayWidgets[3].draw(ctx, rightWidgetPos, v_padding);
-    } else { // we have 4 widgets
-
-      // middle position 1
-      middleWidgetPos = (bounds.size.w - 5 * H_PADDING_DEFAULT) / 4 + 2 * H_PADDING_DEFAULT;
-      v_padding = (HORIZONTAL_BAR_HEIGHT - displayWidgets[1].getHeight()) / 2;
-      displayWidgets[1].draw(ctx, middleWidgetPos, v_padding);
-
-      // middle position 2
-      middleWidgetPos = (bounds.size.w - 5 * H_PADDING_DEFAULT) / 2 + 3 * H_PADDING_DEFAULT;
-      v_padding = (HORIZONTAL_BAR_HEIGHT - displayWidgets[2].getHeight()) / 2;
-      displayWidgets[2].draw(ctx, middleWidgetPos, v_padding);
-
-      v_padding = (HORIZONTAL_BAR_HEIGHT - displayWidgets[3].getHeight()) / 2;
-      displayWidgets[3].draw(ctx, rightWidgetPos, v_padding);
-    }
-  } else if(globalSettings.sidebarLocation == LEFT || globalSettings.sidebarLocation == RIGHT) {
-    GRect unobstructed_bounds = layer_get_unobstructed_bounds(l);
+  // if the widgets are too tall, enable "compact mode"
+  int compact_mode_threshold = availableHeight - V_PADDING_DEFAULT * 2 - 3;
+  int v_padding = V_PADDING_DEFAULT;
 
-    // if the widgets are too tall, enable "compact mode"
-    int compact_mode_threshold = unobstructed_bounds.size.h - V_PADDING_DEFAULT * 2 - 3;
-    v_padding = V_PADDING_DEFAULT;
+  // ensure that we compare the non-compacted heights
+  layout->compactMode = false;
+  layout->fixedHeight = false;
+  layout->compactMode = (measurePlacements(layout) > compact_mode_threshold);
+
+  // now that they have been compacted, check if they fit a second time,
+  // if they still don't fit, we can reduce padding
+  if(layout->compactMode && measurePlacements(layout) > compact_mode_threshold) {
+    v_padding = V_PADDING_COMPACT;
+  }
 
-    SidebarWidgets_useCompactMode = false; // ensure that we compare the non-compacted heights
-    SidebarWidgets_fixedHeight = false;
-    int totalHeight = displayWidgets[0].getHeight() + displayWidgets[1].getHeight() + displayWidgets[2].getHeight();
-    SidebarWidgets_useCompactMode = (totalHeight > compact_mode_threshold);
-    // printf("Total Height: %i, Threshold: %i", totalHeight, compact_mode_threshold);
+  int last = layout->placementCount - 1;
+  WidgetPlacement* placements = layout->placements;
 
-    // now that they have been compacted, check if they fit a second time,
-    // if they still don't fit, we can reduce padding
-    totalHeight = displayWidgets[0].getHeight() + displayWidgets[1].getHeight() + displayWidgets[2].getHeight();
+  placements[0].y = v_padding;
+  placements[last].y = availableHeight - v_padding - placements[last].height;
 
-    if(totalHeight > compact_mode_threshold) {
-      v_padding = V_PADDING_COMPACT;
+  // vertically center the middle widgets using MATH: each one is placed
+  // between the widgets above it and the widgets below it, weighted by its rank
+  for(int i = 1; i < last; i++) {
+    int top = v_padding;
+    int bottom = placements[last].y;
+
+    for(int j = 0; j < i; j++) {
+      top += placements[j].height;
+    }
+
+    for(int j = i; j < last; j++) {
+      bottom -= placements[j].height;
     }
 
-    // draw the widgets
-    int lowerWidgetPos = unobstructed_bounds.size.h - v_padding - displayWidgets[2].getHeight();
-    displayWidgets[0].draw(ctx, 0, v_padding);
+    placements[i].y = ((last - i) * top + i * bottom) / last;
+  }
+}
 
-    // vertically center the middle widget using MATH
-    middleWidgetPos = ((lowerWidgetPos - displayWidgets[1].getHeight()) + (v_padding + displayWidgets[0].getHeight())) / 2;
-    displayWidgets[1].draw(ctx, 0, middleWidgetPos);
+static void solveRectLayout(WidgetLayout* layout) {
+  if(globalSettings.sidebarLocation == BOTTOM || globalSettings.sidebarLocation == TOP) {
+    solveRectHorizontalLayout(layout, layer_get_bounds(sidebarLayer));
+  } else if(globalSettings.sidebarLocation == LEFT || globalSettings.sidebarLocation == RIGHT) {
+    solveRectVerticalLayout(layout);
+  }
 
-    displayWidgets[2].draw(ctx, 0, lowerWidgetPos);
+  // this ends up being zero on every rectangular platform besides emery
+  for(int i = 0; i < layout->placementCount; i++) {
+    layout->placements[i].xOffset = RECT_WIDGETS_XOFFSET;
   }
 }
 #endif
@@ -380,9 +506,27 @@ void Sidebar_init(Window* window) {
   #else
     layer_set_update_proc(sidebarLayer, updateRectSidebar);
   #endif
+
+  // init the widget layers, they are positioned by Sidebar_set_layer()
+  for(int i = 0; i < WIDGET_LAYER_COUNT; i++) {
+    widgetLayers[i] = layer_create_with_data(GRectZero, sizeof(WidgetLayerData));
+    layer_set_update_proc(widgetLayers[i], updateWidgetLayer);
+    layer_set_hidden(widgetLayers[i], true);
+
+    #ifdef PBL_ROUND
+      // the first widget is displayed in the first sidebar, the other one in the second
+      layer_add_child((i == 0) ? sidebarLayer : sidebarLayer2, widgetLayers[i]);
+    #else
+      layer_add_child(sidebarLayer, widgetLayers[i]);
+    #endif
+  }
 }
 
 void Sidebar_deinit(void) {
+  for(int i = 0; i < WIDGET_LAYER_COUNT; i++) {
+    layer_destroy(widgetLayers[i]);
+  }
+
   layer_destroy(sidebarLayer);
 
   #ifdef PBL_ROUND
@@ -417,6 +561,46 @@ void Sidebar_set_layer(void) {
   #endif
 
   SidebarWidgets_updateFonts();
+
+  // any setting may change the heights of the widgets
+  widgetLayout.valid = false;
+  Sidebar_update_layout();
+}
+
+void Sidebar_update_layout(void) {
+  if(globalSettings.sidebarLocation == NONE) {
+    return;
+  }
+
+  WidgetLayoutInputs inputs;
+  getLayoutInputs(&inputs);
+
+  if(widgetLayout.valid && memcmp(&inputs, &widgetLayout.inputs, sizeof(WidgetLayoutInputs)) == 0) {
+    return;
+  }
+
+  memset(&widgetLayout, 0, sizeof(WidgetLayout));
+  widgetLayout.inputs = inputs;
+
+  #ifdef PBL_ROUND
+    solveRoundLayout(&widgetLayout);
+  #else
+    solveRectLayout(&widgetLayout);
+  #endif
+
+  widgetLayout.valid = true;
+
+  // the widgets are drawn with the flags they were measured with
+  SidebarWidgets_useCompactMode = widgetLayout.compactMode;
+  SidebarWidgets_fixedHeight = widgetLayout.fixedHeight;
+
+  for(int i = 0; i < WIDGET_LAYER_COUNT; i++) {
+    if(i < widgetLayout.placementCount) {
+      placeWidgetLayer(i, &widgetLayout.placements[i]);
+    } else {
+      layer_set_hidden(widgetLayers[i], true);
+    }
+  }
 }
 
 void Sidebar_redraw(void) {
@@ -428,6 +612,32 @@ void Sidebar_redraw(void) {
   #endif
 }
 
+void Sidebar_redraw_changes(uint16_t changes) {
+  // the height of some widgets changes with their content
+  if(changes & widgetLayout.heightDependencies) {
+    widgetLayout.valid = false;
+  }
+
+  // the replaced widget may change, so everything must be placed again
+  if(changes & REPLACEMENT_DEPENDENCIES) {
+    Sidebar_update_layout();
+    Sidebar_redraw();
+    return;
+  }
+
+  if(!widgetLayout.valid) {
+    Sidebar_update_layout();
+  }
+
+  for(int i = 0; i < WIDGET_LAYER_COUNT; i++) {
+    WidgetLayerData* data = layer_get_data(widgetLayers[i]);
+
+    if(!layer_get_hidden(widgetLayers[i]) && (changes & data->widget.dependencies)) {
+      layer_mark_dirty(widgetLayers[i]);
+    }
+  }
+}
+
 #ifndef PBL_ROUND
 void Sidebar_set_hidden(bool hide) {
   layer_set_hidden(sidebarLayer, hide);
@@ -1,11 +1,14 @@
 #pragma once
 #include <pebble.h>
+#include "changes.h"
 
 // "public" functions
 void Sidebar_init(Window* window);
 void Sidebar_deinit(void);
 void Sidebar_set_layer(void);
+void Sidebar_update_layout(void);
 void Sidebar_redraw(void);
+void Sidebar_redraw_changes(uint16_t changes);
 #ifndef PBL_ROUND
 void Sidebar_set_hidden(bool hide);
 #endif
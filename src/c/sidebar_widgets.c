@@ -3,6 +3,7 @@
 #include "settings.h"
 #include "weather.h"
 #include "util.h"
+#include "icon_pool.h"
 #ifdef PBL_HEALTH
 #include "health.h"
 #endif
@@ -15,10 +16,10 @@ bool SidebarWidgets_fixedHeight = false;
 int SidebarWidgets_xOffset;
 
 // sidebar icons
-static GDrawCommandImage* dateImage;
-static GDrawCommandImage* disconnectImage;
-static GDrawCommandImage* batteryImage;
-static GDrawCommandImage* batteryChargeImage;
+static PaletteImage* dateImage;
+static PaletteImage* disconnectImage;
+static PaletteImage* batteryImage;
+static PaletteImage* batteryChargeImage;
 
 // fonts
 static GFont smSidebarFont;
@@ -69,9 +70,9 @@ static int Beats_getHeight(void);
 static void Beats_draw(GContext* ctx, int xPosition, int yPosition);
 
 #ifdef PBL_HEALTH
-  static GDrawCommandImage* sleepImage;
-  static GDrawCommandImage* stepsImage;
-  static GDrawCommandImage* heartImage;
+  static PaletteImage* sleepImage;
+  static PaletteImage* stepsImage;
+  static PaletteImage* heartImage;
 
   static SidebarWidget healthWidget;
   static int Health_getHeight(void);
@@ -95,74 +96,102 @@ void SidebarWidgets_init(void) {
   lgSidebarFont = fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD);
 
   // load the sidebar graphics
-  dateImage = gdraw_command_image_create_with_resource(RESOURCE_ID_DATE_BG);
-  disconnectImage = gdraw_command_image_create_with_resource(RESOURCE_ID_DISCONNECTED);
-  batteryImage = gdraw_command_image_create_with_resource(RESOURCE_ID_BATTERY_BG);
-  batteryChargeImage = gdraw_command_image_create_with_resource(RESOURCE_ID_BATTERY_CHARGE);
+  dateImage = IconPool_acquire(RESOURCE_ID_DATE_BG);
+  disconnectImage = IconPool_acquire(RESOURCE_ID_DISCONNECTED);
+  batteryImage = IconPool_acquire(RESOURCE_ID_BATTERY_BG);
+  batteryChargeImage = IconPool_acquire(RESOURCE_ID_BATTERY_CHARGE);
 
   #ifdef PBL_HEALTH
-    sleepImage = gdraw_command_image_create_with_resource(RESOURCE_ID_HEALTH_SLEEP);
-    stepsImage = gdraw_command_image_create_with_resource(RESOURCE_ID_HEALTH_STEPS);
-    heartImage = gdraw_command_image_create_with_resource(RESOURCE_ID_HEALTH_HEART);
+    sleepImage = IconPool_acquire(RESOURCE_ID_HEALTH_SLEEP);
+    stepsImage = IconPool_acquire(RESOURCE_ID_HEALTH_STEPS);
+    heartImage = IconPool_acquire(RESOURCE_ID_HEALTH_HEART);
   #endif
 
   // set up widgets' function pointers correctly
   batteryMeterWidget.getHeight = BatteryMeter_getHeight;
   batteryMeterWidget.draw      = BatteryMeter_draw;
+  batteryMeterWidget.dependencies = CHANGED_BATTERY;
+  batteryMeterWidget.heightDependencies = CHANGED_BATTERY;
 
   emptyWidget.getHeight = EmptyWidget_getHeight;
   emptyWidget.draw      = EmptyWidget_draw;
+  emptyWidget.dependencies = CHANGED_NONE;
+  emptyWidget.heightDependencies = CHANGED_NONE;
 
   dateWidget.getHeight = DateWidget_getHeight;
   dateWidget.draw      = DateWidget_draw;
+  dateWidget.dependencies = CHANGED_DAY;
+  dateWidget.heightDependencies = CHANGED_NONE;
 
   currentWeatherWidget.getHeight = CurrentWeather_getHeight;
   currentWeatherWidget.draw      = CurrentWeather_draw;
+  currentWeatherWidget.dependencies = CHANGED_WEATHER;
+  currentWeatherWidget.heightDependencies = CHANGED_NONE;
 
   weatherForecastWidget.getHeight = WeatherForecast_getHeight;
   weatherForecastWidget.draw      = WeatherForecast_draw;
+  weatherForecastWidget.dependencies = CHANGED_WEATHER;
+  weatherForecastWidget.heightDependencies = CHANGED_NONE;
 
   btDisconnectWidget.getHeight = BTDisconnect_getHeight;
   btDisconnectWidget.draw      = BTDisconnect_draw;
+  btDisconnectWidget.dependencies = CHANGED_BLUETOOTH;
+  btDisconnectWidget.heightDependencies = CHANGED_NONE;
 
   weekNumberWidget.getHeight = WeekNumber_getHeight;
   weekNumberWidget.draw      = WeekNumber_draw;
+  weekNumberWidget.dependencies = CHANGED_WEEK;
+  weekNumberWidget.heightDependencies = CHANGED_NONE;
 
   secondsWidget.getHeight = Seconds_getHeight;
   secondsWidget.draw      = Seconds_draw;
+  secondsWidget.dependencies = CHANGED_SECONDS;
+  secondsWidget.heightDependencies = CHANGED_NONE;
 
   altTimeWidget.getHeight = AltTime_getHeight;
   altTimeWidget.draw      = AltTime_draw;
+  altTimeWidget.dependencies = CHANGED_ALT_CLOCK;
+  altTimeWidget.heightDependencies = CHANGED_NONE;
 
   #ifdef PBL_HEALTH
     healthWidget.getHeight = Health_getHeight;
     healthWidget.draw = Health_draw;
+    healthWidget.dependencies = CHANGED_HEALTH;
+    healthWidget.heightDependencies = CHANGED_HEALTH;
 
     sleepWidget.getHeight = Sleep_getHeight;
     sleepWidget.draw = Sleep_draw;
+    sleepWidget.dependencies = CHANGED_HEALTH;
+    sleepWidget.heightDependencies = CHANGED_NONE;
 
     stepsWidget.getHeight = Steps_getHeight;
     stepsWidget.draw = Steps_draw;
+    stepsWidget.dependencies = CHANGED_HEALTH;
+    stepsWidget.heightDependencies = CHANGED_NONE;
 
     heartRateWidget.getHeight = HeartRate_getHeight;
     heartRateWidget.draw = HeartRate_draw;
+    heartRateWidget.dependencies = CHANGED_HEALTH;
+    heartRateWidget.heightDependencies = CHANGED_NONE;
   #endif
 
   beatsWidget.getHeight = Beats_getHeight;
   beatsWidget.draw      = Beats_draw;
+  beatsWidget.dependencies = CHANGED_BEATS;
+  beatsWidget.heightDependencies = CHANGED_NONE;
 
 }
 
 void SidebarWidgets_deinit(void) {
-  gdraw_command_image_destroy(dateImage);
-  gdraw_command_image_destroy(disconnectImage);
-  gdraw_command_image_destroy(batteryImage);
-  gdraw_command_image_destroy(batteryChargeImage);
+  IconPool_release(dateImage);
+  IconPool_release(disconnectImage);
+  IconPool_release(batteryImage);
+  IconPool_release(batteryChargeImage);
 
   #ifdef PBL_HEALTH
-    gdraw_command_image_destroy(stepsImage);
-    gdraw_command_image_destroy(sleepImage);
-    gdraw_command_image_destroy(heartImage);
+    IconPool_release(stepsImage);
+    IconPool_release(sleepImage);
+    IconPool_release(heartImage);
   #endif
 }
 
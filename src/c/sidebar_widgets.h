@@ -1,5 +1,6 @@
 #pragma once
 #include <pebble.h>
+#include "changes.h"
 
 /*
  * "Compact Mode" is a global setting shared by all widgets, which determines
@@ -53,6 +54,18 @@ typedef struct {
    * Draws the widget using the provided graphics context
    */
   void (*draw)(GContext* ctx, int xPosition, int yPosition);
+
+  /*
+   * ChangeMask of the inputs displayed by the widget, it only needs to be
+   * redrawn when one of them changed
+   */
+  uint16_t dependencies;
+
+  /*
+   * ChangeMask of the inputs which can change the height of the widget,
+   * besides the settings and the compact mode and fixed height flags
+   */
+  uint16_t heightDependencies;
 } SidebarWidget;
 
 void SidebarWidgets_init(void);
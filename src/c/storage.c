@@ -0,0 +1,106 @@
+#include <pebble.h>
+#include "storage.h"
+#include "profiling.h"
+
+// the tracked records, in no particular order
+static StorageRecord* firstRecord;
+
+static AppTimer* writeTimer;
+static uint32_t writeCount;
+
+// FNV-1a, enough to tell whether the data changed
+static uint32_t checksum(const void* data, size_t size) {
+  const uint8_t* bytes = data;
+  uint32_t hash = 2166136261u;
+
+  for(size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+
+  return hash;
+}
+
+static void write_record(StorageRecord* record) {
+  record->dirty = false;
+
+  uint32_t newChecksum = checksum(record->data, record->size);
+
+  if(record->persisted && record->checksum == newChecksum) {
+    return;
+  }
+
+  persist_write_data(record->key, record->data, record->size);
+
+  record->checksum = newChecksum;
+  record->persisted = true;
+  writeCount++;
+
+  Profiling_count(PROFILE_PERSIST_WRITES, 1);
+  Profiling_count(PROFILE_PERSIST_BYTES, record->size);
+}
+
+static void write_timer_callback(void* context) {
+  writeTimer = NULL;
+
+  Storage_flush();
+}
+
+void Storage_track(StorageRecord* record, uint32_t key, const void* data, uint16_t size) {
+  record->key = key;
+  record->data = data;
+  record->size = size;
+  record->dirty = false;
+
+  // the data of older versions may be shorter, which makes it differ anyway
+  uint8_t persistedData[PERSIST_DATA_MAX_LENGTH];
+  int persistedSize = persist_exists(key) ? persist_read_data(key, persistedData, sizeof(persistedData)) : -1;
+
+  record->persisted = (persistedSize >= 0);
+  record->checksum = record->persisted ? checksum(persistedData, persistedSize) : 0;
+
+  for(StorageRecord* tracked = firstRecord; tracked; tracked = tracked->next) {
+    if(tracked == record) {
+      return;
+    }
+  }
+
+  record->next = firstRecord;
+  firstRecord = record;
+}
+
+void Storage_markDirty(StorageRecord* record) {
+  record->dirty = true;
+
+  // the delay isn't pushed back, so that a stream of changes still gets written
+  if(!writeTimer) {
+    writeTimer = app_timer_register(STORAGE_WRITE_DELAY, write_timer_callback, NULL);
+  }
+}
+
+void Storage_flush(void) {
+  if(writeTimer) {
+    app_timer_cancel(writeTimer);
+    writeTimer = NULL;
+  }
+
+  for(StorageRecord* record = firstRecord; record; record = record->next) {
+    if(record->dirty) {
+      write_record(record);
+    }
+  }
+}
+
+uint32_t Storage_getWriteCount(void) {
+  return writeCount;
+}
+
+void Storage_deinit(void) {
+  Storage_flush();
+
+  while(firstRecord) {
+    StorageRecord* record = firstRecord;
+
+    firstRecord = record->next;
+    record->next = NULL;
+  }
+}
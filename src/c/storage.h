@@ -0,0 +1,50 @@
+#pragma once
+#include <pebble.h>
+
+// how long the changes wait for the ones following them before being written,
+// in milliseconds. A config or weather update often comes in several messages
+#define STORAGE_WRITE_DELAY 5000
+
+/*
+ * A record is a persistent storage key, written from the same memory every
+ * time. The records are owned by their modules, usually as statics
+ */
+typedef struct StorageRecord {
+  uint32_t key;
+  const void* data;
+  uint16_t size;
+
+  // of the data last written to the key, or read from it
+  uint32_t checksum;
+  bool persisted;
+
+  bool dirty;
+  struct StorageRecord* next;
+} StorageRecord;
+
+/*
+ * Tracks the key, which is then written from data. The current content of the
+ * key is read to know whether the data differs from it
+ */
+void Storage_track(StorageRecord* record, uint32_t key, const void* data, uint16_t size);
+
+/*
+ * The data of the record changed, it's written once the write delay has
+ * elapsed, if it differs from what was last written
+ */
+void Storage_markDirty(StorageRecord* record);
+
+/*
+ * Writes the dirty records now
+ */
+void Storage_flush(void);
+
+/*
+ * The number of keys written to flash since the watchface started
+ */
+uint32_t Storage_getWriteCount(void);
+
+/*
+ * Writes the dirty records and forgets all of them
+ */
+void Storage_deinit(void);
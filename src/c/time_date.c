@@ -2,6 +2,7 @@
 #include "time.h"
 #include "settings.h"
 #include "time_date.h"
+#include "tz_rules.h"
 
 // the date and time strings
 char time_date_currentDayNum[3];
@@ -13,10 +14,17 @@ char time_date_hours[3];
 char time_date_minutes[3];
 uint8_t time_date_currentDayName;
 uint8_t time_date_currentMonth;
+char time_date_currentDate[21];
 #ifndef PBL_ROUND
 bool time_date_isAmHour;
 #endif
 
+// the offset of the alternate time zone, until its next transition
+static uint8_t cachedZoneId = TZ_ZONE_NONE;
+static int16_t cachedZoneOffset;
+static time_t cachedZoneOffsetStart;
+static time_t cachedZoneOffsetEnd;
+
 // c can't do true modulus on negative numbers, apparently
 // from http://stackoverflow.com/questions/11720656/modulo-operation-with-negative-numbers
 static int mod(int a, int b) {
@@ -24,96 +32,255 @@ static int mod(int a, int b) {
     return r < 0 ? r + b : r;
 }
 
-static int time_date_get_beats(const struct tm *tm) {
-  // code from https://gist.github.com/insom/bf40b91fd25ae1d84764
+// the seconds since midnight in Biel Mean Time, which is UTC+1 without daylight saving
+static int32_t get_bmt_seconds(time_t now) {
+  return (now + 3600) % SECONDS_PER_DAY;
+}
 
-  time_t t = mktime((struct tm *)tm);
-  t = t + 3600; // Add an hour to make into BMT
+// writes the two digits of value, or a space instead of a leading zero when padding is ' '
+static void format_two_digits(char* dest, int value, char padding) {
+  dest[0] = (value < 10) ? padding : '0' + value / 10;
+  dest[1] = '0' + value % 10;
+  dest[2] = '\0';
+}
 
-  struct tm *bt = gmtime(&t);
-  double sex = (bt->tm_hour * 3600) + (bt->tm_min * 60) + bt->tm_sec;
-  int beats = (int)(10 * (sex / 864)) % 1000;
+// removes the padding space of a two digits string
+static void trim_padding(char* str) {
+  if(str[0] == ' ') {
+    str[0] = str[1];
+    str[1] = '\0';
+  }
+}
 
-  return beats;
+static bool is_long_iso_year(int year) {
+  // the years whose first day or last day is a thursday have 53 weeks
+  int p = (year + year / 4 - year / 100 + year / 400) % 7;
+  int previous = ((year - 1) + (year - 1) / 4 - (year - 1) / 100 + (year - 1) / 400) % 7;
+
+  return p == 4 || previous == 3;
 }
 
-void time_date_update(void) {
-  time_t rawTime;
-  struct tm* time_info;
+// same as strftime("%V")
+static int iso_week_number(const struct tm* time_info) {
+  int year = time_info->tm_year + 1900;
+  int isoWeekDay = (time_info->tm_wday + 6) % 7 + 1;
+  int week = (time_info->tm_yday + 1 - isoWeekDay + 10) / 7;
+
+  if(week < 1) {
+    return is_long_iso_year(year - 1) ? 53 : 52;
+  } else if(week == 53 && !is_long_iso_year(year)) {
+    return 1;
+  }
 
-  time(&rawTime);
-  time_info = localtime(&rawTime);
+  return week;
+}
 
-  if (clock_is_24h_style()) {
-    strftime(time_date_hours, sizeof(time_date_hours), (globalSettings.showLeadingZero) ? "%H" : "%k", time_info);
-  } else {
-    strftime(time_date_hours, sizeof(time_date_hours), (globalSettings.showLeadingZero) ? "%I" : "%l", time_info);
+/*
+ * Returns the UTC offset of the zone in minutes, found by binary search in its
+ * transitions. It is cached until the next transition
+ */
+static int16_t get_zone_offset(uint8_t zoneId, time_t now) {
+  if(zoneId == cachedZoneId && now >= cachedZoneOffsetStart && now < cachedZoneOffsetEnd) {
+    return cachedZoneOffset;
   }
 
-  if(time_date_hours[0] == ' ' && globalSettings.centerTime) {
-    time_date_hours[0] = time_date_hours[1];
-    time_date_hours[1] = '\0';
+  const TzZone* zone = &tz_zones[zoneId - 1];
+  const TzTransition* transitions = &tz_transitions[zone->firstTransition];
+
+  // count the transitions which already happened
+  int low = 0;
+  int high = zone->transitionCount;
+
+  while(low < high) {
+    int middle = (low + high) / 2;
+
+    if(transitions[middle].utcTime <= (uint32_t)now) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
   }
 
-  // minutes
-  strftime(time_date_minutes, sizeof(time_date_minutes), "%M", time_info);
+  // after the end of the table, the last offset stays
+  cachedZoneId = zoneId;
+  cachedZoneOffset = (low == 0) ? zone->initialOffset : transitions[low - 1].offset;
+  cachedZoneOffsetStart = (low == 0) ? 0 : (time_t)transitions[low - 1].utcTime;
+  cachedZoneOffsetEnd = (low == zone->transitionCount) ? (time_t)INT32_MAX : (time_t)transitions[low].utcTime;
 
-  // set all the date strings
-  strftime(time_date_currentDayNum,  3, "%e", time_info);
-  strftime(time_date_currentWeekNum, 3, "%V", time_info);
+  return cachedZoneOffset;
+}
 
-  // remove padding on date num, if needed
-  if(time_date_currentDayNum[0] == ' ') {
-    time_date_currentDayNum[0] = time_date_currentDayNum[1];
-    time_date_currentDayNum[1] = '\0';
+// copies the new value into the string, and reports if it was different
+static bool update_string(char* dest, const char* src, size_t size) {
+  if(strncmp(dest, src, size) == 0) {
+    return false;
   }
 
-  // set the seconds string
-  strftime(time_date_currentSecondsNum, 4, ":%S", time_info);
+  strncpy(dest, src, size);
+  return true;
+}
 
-  time_date_currentDayName = time_info->tm_wday;
-  time_date_currentMonth = time_info->tm_mon;
+static uint16_t update_time(const struct tm* time_info) {
+  uint16_t changes = CHANGED_NONE;
+  char hours[sizeof(time_date_hours)];
+  char minutes[sizeof(time_date_minutes)];
+
+  // same as strftime("%H"), "%k", "%I" or "%l"
+  int displayHour = time_info->tm_hour;
+
+  if(!clock_is_24h_style()) {
+    displayHour = (displayHour % 12 == 0) ? 12 : displayHour % 12;
+  }
+
+  format_two_digits(hours, displayHour, (globalSettings.showLeadingZero) ? '0' : ' ');
+
+  if(globalSettings.centerTime) {
+    trim_padding(hours);
+  }
+
+  if(update_string(time_date_hours, hours, sizeof(time_date_hours))) {
+    changes |= CHANGED_HOURS;
+  }
+
+  // minutes
+  format_two_digits(minutes, time_info->tm_min, '0');
+
+  if(update_string(time_date_minutes, minutes, sizeof(time_date_minutes))) {
+    changes |= CHANGED_MINUTES;
+  }
 
 #ifndef PBL_ROUND
+  // the am/pm indicator is drawn along with the hours
+  if(time_date_isAmHour != (time_info->tm_hour < 12)) {
+    changes |= CHANGED_HOURS;
+  }
+
   time_date_isAmHour = time_info->tm_hour < 12;
 #endif // PBL_ROUND
 
   if(globalSettings.enableAltTimeZone) {
     // set the alternate time zone string
-    int hour = time_info->tm_hour;
+    int hour;
 
-    // apply the configured offset value
-    hour += globalSettings.altclockOffset;
+    if(globalSettings.altclockZone != TZ_ZONE_NONE && globalSettings.altclockZone <= tz_zone_count) {
+      // the zone may be a fraction of an hour away, so the hour is computed from the UTC time
+      time_t now = time(NULL);
+      time_t zoneTime = now + get_zone_offset(globalSettings.altclockZone, now) * SECONDS_PER_MINUTE;
+
+      hour = (zoneTime % SECONDS_PER_DAY) / SECONDS_PER_HOUR;
+    } else {
+      // apply the configured offset value
+      hour = mod(time_info->tm_hour + globalSettings.altclockOffset, 24);
+    }
 
     char am_pm;
+    char altClock[sizeof(time_date_altClock)];
 
     // format it
     if(clock_is_24h_style()) {
-      hour = mod(hour, 24);
       am_pm = (char) 0;
     } else {
+      am_pm = (hour < 12) ? 'a' : 'p';
       hour = mod(hour, 12);
       if(hour == 0) {
         hour = 12;
       }
-      am_pm = (mod(hour, 24) < 12) ? 'a' : 'p';
     }
 
     if(globalSettings.showLeadingZero && hour < 10) {
-      snprintf(time_date_altClock, sizeof(time_date_altClock), "0%i%c", hour, am_pm);
+      snprintf(altClock, sizeof(altClock), "0%i%c", hour, am_pm);
     } else {
-      snprintf(time_date_altClock, sizeof(time_date_altClock), "%i%c", hour, am_pm);
+      snprintf(altClock, sizeof(altClock), "%i%c", hour, am_pm);
+    }
+
+    if(update_string(time_date_altClock, altClock, sizeof(time_date_altClock))) {
+      changes |= CHANGED_ALT_CLOCK;
     }
   }
 
-  if(globalSettings.enableBeats) {
-    // this must be last, because time_get_beats screws with the time structure
-    int beats = 0;
+  return changes;
+}
+
+static uint16_t update_date(const struct tm* time_info) {
+  uint16_t changes = CHANGED_NONE;
+  char dayNum[sizeof(time_date_currentDayNum)];
+  char weekNum[sizeof(time_date_currentWeekNum)];
 
-    // set the swatch internet time beats
-    beats = time_date_get_beats(time_info);
+  // same as strftime("%e") without the padding, and strftime("%V")
+  format_two_digits(dayNum, time_info->tm_mday, ' ');
+  trim_padding(dayNum);
+  format_two_digits(weekNum, iso_week_number(time_info), '0');
+
+  if(update_string(time_date_currentDayNum, dayNum, sizeof(time_date_currentDayNum)) ||
+     time_date_currentDayName != time_info->tm_wday ||
+     time_date_currentMonth != time_info->tm_mon) {
+    changes |= CHANGED_DAY;
+  }
 
-    snprintf(time_date_currentBeats, sizeof(time_date_currentBeats), "%i", beats);
+  if(update_string(time_date_currentWeekNum, weekNum, sizeof(time_date_currentWeekNum))) {
+    changes |= CHANGED_WEEK;
   }
+
+  time_date_currentDayName = time_info->tm_wday;
+  time_date_currentMonth = time_info->tm_mon;
+
+  // compose the full date, the language may have changed even if the day didn't
+  strncpy(time_date_currentDate, globalSettings.languageDayNames[time_date_currentDayName], sizeof(globalSettings.languageDayNames[time_date_currentDayName]));
+  strncat(time_date_currentDate, " " , 2);
+  strncat(time_date_currentDate, time_date_currentDayNum, sizeof(time_date_currentDayNum));
+  strncat(time_date_currentDate, " " , 2);
+  strncat(time_date_currentDate, globalSettings.languageMonthNames[time_date_currentMonth], sizeof(globalSettings.languageMonthNames[time_date_currentMonth]));
+
+  return changes;
 }
 
+uint16_t time_date_update(const struct tm* time_info, TimeUnits units_changed) {
+  uint16_t changes = CHANGED_NONE;
+  char seconds[sizeof(time_date_currentSecondsNum)];
+
+  // same as strftime(":%S")
+  seconds[0] = ':';
+  format_two_digits(seconds + 1, time_info->tm_sec, '0');
+
+  if(update_string(time_date_currentSecondsNum, seconds, sizeof(time_date_currentSecondsNum))) {
+    changes |= CHANGED_SECONDS;
+  }
+
+  if(units_changed & MINUTE_UNIT) {
+    changes |= update_time(time_info);
+  }
+
+  if(units_changed & DAY_UNIT) {
+    changes |= update_date(time_info);
+  }
+
+  return changes;
+}
+
+uint16_t time_date_update_beats(time_t now) {
+  // a beat lasts 86.4 seconds, there are 1000 of them per day
+  int beats = get_bmt_seconds(now) * 10 / 864;
+  char beatsString[sizeof(time_date_currentBeats)];
+  char* digit = beatsString + sizeof(beatsString) - 1;
+
+  // same as snprintf("%i")
+  *digit = '\0';
+
+  do {
+    *--digit = '0' + beats % 10;
+    beats /= 10;
+  } while(beats > 0);
+
+  if(update_string(time_date_currentBeats, digit, sizeof(time_date_currentBeats))) {
+    return CHANGED_BEATS;
+  }
+
+  return CHANGED_NONE;
+}
+
+uint32_t time_date_ms_until_next_beat(time_t now, uint16_t ms) {
+  // in the day of 86400000 ms, a beat lasts 86400 ms
+  uint32_t dayMs = get_bmt_seconds(now) * 1000 + ms;
+
+  return MS_PER_BEAT - dayMs % MS_PER_BEAT;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <pebble.h>
+#include "changes.h"
 
 // the date and time strings
 extern char time_date_currentDayNum[3];
@@ -11,8 +12,34 @@ extern char time_date_hours[3];
 extern char time_date_minutes[3];
 extern uint8_t time_date_currentDayName;
 extern uint8_t time_date_currentMonth;
+
+// the day name, day number and month name, composed when the day or the language changes
+extern char time_date_currentDate[21];
 #ifndef PBL_ROUND
 extern bool time_date_isAmHour;
 #endif // PBL_ROUND
 
-void time_date_update(void);
+// passed to time_date_update() to refresh all the strings, e.g. after a settings change
+#define TIME_DATE_ALL_UNITS (SECOND_UNIT | MINUTE_UNIT | HOUR_UNIT | DAY_UNIT | MONTH_UNIT | YEAR_UNIT)
+
+/*
+ * Refreshes the date and time strings of the units which changed: the seconds
+ * on every call, the time strings with MINUTE_UNIT and the date strings with
+ * DAY_UNIT. Returns a ChangeMask of the strings whose content changed
+ */
+uint16_t time_date_update(const struct tm* time_info, TimeUnits units_changed);
+
+// the length of a swatch internet time beat
+#define MS_PER_BEAT 86400
+
+/*
+ * Refreshes the beats string from the UTC time, returns CHANGED_BEATS if its
+ * content changed
+ */
+uint16_t time_date_update_beats(time_t now);
+
+/*
+ * Returns the delay until the next beat starts, from the time and milliseconds
+ * given by time_ms()
+ */
+uint32_t time_date_ms_until_next_beat(time_t now, uint16_t ms);
@@ -0,0 +1,522 @@
+// generated by tools/tz_rules.py from the IANA tz database, do not edit
+// the UTC offset changes from 2026 to the end of 2037
+#include <pebble.h>
+#include "tz_rules.h"
+
+const TzTransition tz_transitions[] = {
+  // America/Anchorage
+  { 1772967600, -480 },
+  { 1793527200, -540 },
+  { 1805022000, -480 },
+  { 1825581600, -540 },
+  { 1836471600, -480 },
+  { 1857031200, -540 },
+  { 1867921200, -480 },
+  { 1888480800, -540 },
+  { 1899370800, -480 },
+  { 1919930400, -540 },
+  { 1930820400, -480 },
+  { 1951380000, -540 },
+  { 1962874800, -480 },
+  { 1983434400, -540 },
+  { 1994324400, -480 },
+  { 2014884000, -540 },
+  { 2025774000, -480 },
+  { 2046333600, -540 },
+  { 2057223600, -480 },
+  { 2077783200, -540 },
+  { 2088673200, -480 },
+  { 2109232800, -540 },
+  { 2120122800, -480 },
+  { 2140682400, -540 },
+  // America/Los_Angeles
+  { 1772964000, -420 },
+  { 1793523600, -480 },
+  { 1805018400, -420 },
+  { 1825578000, -480 },
+  { 1836468000, -420 },
+  { 1857027600, -480 },
+  { 1867917600, -420 },
+  { 1888477200, -480 },
+  { 1899367200, -420 },
+  { 1919926800, -480 },
+  { 1930816800, -420 },
+  { 1951376400, -480 },
+  { 1962871200, -420 },
+  { 1983430800, -480 },
+  { 1994320800, -420 },
+  { 2014880400, -480 },
+  { 2025770400, -420 },
+  { 2046330000, -480 },
+  { 2057220000, -420 },
+  { 2077779600, -480 },
+  { 2088669600, -420 },
+  { 2109229200, -480 },
+  { 2120119200, -420 },
+  { 2140678800, -480 },
+  // America/Denver
+  { 1772960400, -360 },
+  { 1793520000, -420 },
+  { 1805014800, -360 },
+  { 1825574400, -420 },
+  { 1836464400, -360 },
+  { 1857024000, -420 },
+  { 1867914000, -360 },
+  { 1888473600, -420 },
+  { 1899363600, -360 },
+  { 1919923200, -420 },
+  { 1930813200, -360 },
+  { 1951372800, -420 },
+  { 1962867600, -360 },
+  { 1983427200, -420 },
+  { 1994317200, -360 },
+  { 2014876800, -420 },
+  { 2025766800, -360 },
+  { 2046326400, -420 },
+  { 2057216400, -360 },
+  { 2077776000, -420 },
+  { 2088666000, -360 },
+  { 2109225600, -420 },
+  { 2120115600, -360 },
+  { 2140675200, -420 },
+  // America/Chicago
+  { 1772956800, -300 },
+  { 1793516400, -360 },
+  { 1805011200, -300 },
+  { 1825570800, -360 },
+  { 1836460800, -300 },
+  { 1857020400, -360 },
+  { 1867910400, -300 },
+  { 1888470000, -360 },
+  { 1899360000, -300 },
+  { 1919919600, -360 },
+  { 1930809600, -300 },
+  { 1951369200, -360 },
+  { 1962864000, -300 },
+  { 1983423600, -360 },
+  { 1994313600, -300 },
+  { 2014873200, -360 },
+  { 2025763200, -300 },
+  { 2046322800, -360 },
+  { 2057212800, -300 },
+  { 2077772400, -360 },
+  { 2088662400, -300 },
+  { 2109222000, -360 },
+  { 2120112000, -300 },
+  { 2140671600, -360 },
+  // America/New_York
+  { 1772953200, -240 },
+  { 1793512800, -300 },
+  { 1805007600, -240 },
+  { 1825567200, -300 },
+  { 1836457200, -240 },
+  { 1857016800, -300 },
+  { 1867906800, -240 },
+  { 1888466400, -300 },
+  { 1899356400, -240 },
+  { 1919916000, -300 },
+  { 1930806000, -240 },
+  { 1951365600, -300 },
+  { 1962860400, -240 },
+  { 1983420000, -300 },
+  { 1994310000, -240 },
+  { 2014869600, -300 },
+  { 2025759600, -240 },
+  { 2046319200, -300 },
+  { 2057209200, -240 },
+  { 2077768800, -300 },
+  { 2088658800, -240 },
+  { 2109218400, -300 },
+  { 2120108400, -240 },
+  { 2140668000, -300 },
+  // America/Halifax
+  { 1772949600, -180 },
+  { 1793509200, -240 },
+  { 1805004000, -180 },
+  { 1825563600, -240 },
+  { 1836453600, -180 },
+  { 1857013200, -240 },
+  { 1867903200, -180 },
+  { 1888462800, -240 },
+  { 1899352800, -180 },
+  { 1919912400, -240 },
+  { 1930802400, -180 },
+  { 1951362000, -240 },
+  { 1962856800, -180 },
+  { 1983416400, -240 },
+  { 1994306400, -180 },
+  { 2014866000, -240 },
+  { 2025756000, -180 },
+  { 2046315600, -240 },
+  { 2057205600, -180 },
+  { 2077765200, -240 },
+  { 2088655200, -180 },
+  { 2109214800, -240 },
+  { 2120104800, -180 },
+  { 2140664400, -240 },
+  // America/St_Johns
+  { 1772947800, -150 },
+  { 1793507400, -210 },
+  { 1805002200, -150 },
+  { 1825561800, -210 },
+  { 1836451800, -150 },
+  { 1857011400, -210 },
+  { 1867901400, -150 },
+  { 1888461000, -210 },
+  { 1899351000, -150 },
+  { 1919910600, -210 },
+  { 1930800600, -150 },
+  { 1951360200, -210 },
+  { 1962855000, -150 },
+  { 1983414600, -210 },
+  { 1994304600, -150 },
+  { 2014864200, -210 },
+  { 2025754200, -150 },
+  { 2046313800, -210 },
+  { 2057203800, -150 },
+  { 2077763400, -210 },
+  { 2088653400, -150 },
+  { 2109213000, -210 },
+  { 2120103000, -150 },
+  { 2140662600, -210 },
+  // Atlantic/Azores
+  { 1774746000, 0 },
+  { 1792890000, -60 },
+  { 1806195600, 0 },
+  { 1824944400, -60 },
+  { 1837645200, 0 },
+  { 1856394000, -60 },
+  { 1869094800, 0 },
+  { 1887843600, -60 },
+  { 1901149200, 0 },
+  { 1919293200, -60 },
+  { 1932598800, 0 },
+  { 1950742800, -60 },
+  { 1964048400, 0 },
+  { 1982797200, -60 },
+  { 1995498000, 0 },
+  { 2014246800, -60 },
+  { 2026947600, 0 },
+  { 2045696400, -60 },
+  { 2058397200, 0 },
+  { 2077146000, -60 },
+  { 2090451600, 0 },
+  { 2108595600, -60 },
+  { 2121901200, 0 },
+  { 2140045200, -60 },
+  // Europe/London
+  { 1774746000, 60 },
+  { 1792890000, 0 },
+  { 1806195600, 60 },
+  { 1824944400, 0 },
+  { 1837645200, 60 },
+  { 1856394000, 0 },
+  { 1869094800, 60 },
+  { 1887843600, 0 },
+  { 1901149200, 60 },
+  { 1919293200, 0 },
+  { 1932598800, 60 },
+  { 1950742800, 0 },
+  { 1964048400, 60 },
+  { 1982797200, 0 },
+  { 1995498000, 60 },
+  { 2014246800, 0 },
+  { 2026947600, 60 },
+  { 2045696400, 0 },
+  { 2058397200, 60 },
+  { 2077146000, 0 },
+  { 2090451600, 60 },
+  { 2108595600, 0 },
+  { 2121901200, 60 },
+  { 2140045200, 0 },
+  // Europe/Paris
+  { 1774746000, 120 },
+  { 1792890000, 60 },
+  { 1806195600, 120 },
+  { 1824944400, 60 },
+  { 1837645200, 120 },
+  { 1856394000, 60 },
+  { 1869094800, 120 },
+  { 1887843600, 60 },
+  { 1901149200, 120 },
+  { 1919293200, 60 },
+  { 1932598800, 120 },
+  { 1950742800, 60 },
+  { 1964048400, 120 },
+  { 1982797200, 60 },
+  { 1995498000, 120 },
+  { 2014246800, 60 },
+  { 2026947600, 120 },
+  { 2045696400, 60 },
+  { 2058397200, 120 },
+  { 2077146000, 60 },
+  { 2090451600, 120 },
+  { 2108595600, 60 },
+  { 2121901200, 120 },
+  { 2140045200, 60 },
+  // Europe/Athens
+  { 1774746000, 180 },
+  { 1792890000, 120 },
+  { 1806195600, 180 },
+  { 1824944400, 120 },
+  { 1837645200, 180 },
+  { 1856394000, 120 },
+  { 1869094800, 180 },
+  { 1887843600, 120 },
+  { 1901149200, 180 },
+  { 1919293200, 120 },
+  { 1932598800, 180 },
+  { 1950742800, 120 },
+  { 1964048400, 180 },
+  { 1982797200, 120 },
+  { 1995498000, 180 },
+  { 2014246800, 120 },
+  { 2026947600, 180 },
+  { 2045696400, 120 },
+  { 2058397200, 180 },
+  { 2077146000, 120 },
+  { 2090451600, 180 },
+  { 2108595600, 120 },
+  { 2121901200, 180 },
+  { 2140045200, 120 },
+  // Africa/Cairo
+  { 1776981600, 180 },
+  { 1793307600, 120 },
+  { 1809036000, 180 },
+  { 1824757200, 120 },
+  { 1840485600, 180 },
+  { 1856206800, 120 },
+  { 1871935200, 180 },
+  { 1887656400, 120 },
+  { 1903384800, 180 },
+  { 1919710800, 120 },
+  { 1934834400, 180 },
+  { 1951160400, 120 },
+  { 1966888800, 180 },
+  { 1982610000, 120 },
+  { 1998338400, 180 },
+  { 2014059600, 120 },
+  { 2029788000, 180 },
+  { 2045509200, 120 },
+  { 2061237600, 180 },
+  { 2076958800, 120 },
+  { 2092687200, 180 },
+  { 2109013200, 120 },
+  { 2124136800, 180 },
+  { 2140462800, 120 },
+  // Asia/Jerusalem
+  { 1774569600, 180 },
+  { 1792882800, 120 },
+  { 1806019200, 180 },
+  { 1824937200, 120 },
+  { 1837468800, 180 },
+  { 1856386800, 120 },
+  { 1868918400, 180 },
+  { 1887836400, 120 },
+  { 1900972800, 180 },
+  { 1919286000, 120 },
+  { 1932422400, 180 },
+  { 1950735600, 120 },
+  { 1963872000, 180 },
+  { 1982790000, 120 },
+  { 1995321600, 180 },
+  { 2014239600, 120 },
+  { 2026771200, 180 },
+  { 2045689200, 120 },
+  { 2058220800, 180 },
+  { 2077138800, 120 },
+  { 2090275200, 180 },
+  { 2108588400, 120 },
+  { 2121724800, 180 },
+  { 2140038000, 120 },
+  // Australia/Adelaide
+  { 1775320200, 570 },
+  { 1791045000, 630 },
+  { 1806769800, 570 },
+  { 1822494600, 630 },
+  { 1838219400, 570 },
+  { 1853944200, 630 },
+  { 1869669000, 570 },
+  { 1885998600, 630 },
+  { 1901723400, 570 },
+  { 1917448200, 630 },
+  { 1933173000, 570 },
+  { 1948897800, 630 },
+  { 1964622600, 570 },
+  { 1980347400, 630 },
+  { 1996072200, 570 },
+  { 2011797000, 630 },
+  { 2027521800, 570 },
+  { 2043246600, 630 },
+  { 2058971400, 570 },
+  { 2075301000, 630 },
+  { 2091025800, 570 },
+  { 2106750600, 630 },
+  { 2122475400, 570 },
+  { 2138200200, 630 },
+  // Australia/Sydney
+  { 1775318400, 600 },
+  { 1791043200, 660 },
+  { 1806768000, 600 },
+  { 1822492800, 660 },
+  { 1838217600, 600 },
+  { 1853942400, 660 },
+  { 1869667200, 600 },
+  { 1885996800, 660 },
+  { 1901721600, 600 },
+  { 1917446400, 660 },
+  { 1933171200, 600 },
+  { 1948896000, 660 },
+  { 1964620800, 600 },
+  { 1980345600, 660 },
+  { 1996070400, 600 },
+  { 2011795200, 660 },
+  { 2027520000, 600 },
+  { 2043244800, 660 },
+  { 2058969600, 600 },
+  { 2075299200, 660 },
+  { 2091024000, 600 },
+  { 2106748800, 660 },
+  { 2122473600, 600 },
+  { 2138198400, 660 },
+  // Australia/Lord_Howe
+  { 1775314800, 630 },
+  { 1791041400, 660 },
+  { 1806764400, 630 },
+  { 1822491000, 660 },
+  { 1838214000, 630 },
+  { 1853940600, 660 },
+  { 1869663600, 630 },
+  { 1885995000, 660 },
+  { 1901718000, 630 },
+  { 1917444600, 660 },
+  { 1933167600, 630 },
+  { 1948894200, 660 },
+  { 1964617200, 630 },
+  { 1980343800, 660 },
+  { 1996066800, 630 },
+  { 2011793400, 660 },
+  { 2027516400, 630 },
+  { 2043243000, 660 },
+  { 2058966000, 630 },
+  { 2075297400, 660 },
+  { 2091020400, 630 },
+  { 2106747000, 660 },
+  { 2122470000, 630 },
+  { 2138196600, 660 },
+  // Pacific/Auckland
+  { 1775311200, 720 },
+  { 1790431200, 780 },
+  { 1806760800, 720 },
+  { 1821880800, 780 },
+  { 1838210400, 720 },
+  { 1853330400, 780 },
+  { 1869660000, 720 },
+  { 1885384800, 780 },
+  { 1901714400, 720 },
+  { 1916834400, 780 },
+  { 1933164000, 720 },
+  { 1948284000, 780 },
+  { 1964613600, 720 },
+  { 1979733600, 780 },
+  { 1996063200, 720 },
+  { 2011183200, 780 },
+  { 2027512800, 720 },
+  { 2042632800, 780 },
+  { 2058962400, 720 },
+  { 2074687200, 780 },
+  { 2091016800, 720 },
+  { 2106136800, 780 },
+  { 2122466400, 720 },
+  { 2137586400, 780 },
+  // Pacific/Chatham
+  { 1775311200, 765 },
+  { 1790431200, 825 },
+  { 1806760800, 765 },
+  { 1821880800, 825 },
+  { 1838210400, 765 },
+  { 1853330400, 825 },
+  { 1869660000, 765 },
+  { 1885384800, 825 },
+  { 1901714400, 765 },
+  { 1916834400, 825 },
+  { 1933164000, 765 },
+  { 1948284000, 825 },
+  { 1964613600, 765 },
+  { 1979733600, 825 },
+  { 1996063200, 765 },
+  { 2011183200, 825 },
+  { 2027512800, 765 },
+  { 2042632800, 825 },
+  { 2058962400, 765 },
+  { 2074687200, 825 },
+  { 2091016800, 765 },
+  { 2106136800, 825 },
+  { 2122466400, 765 },
+  { 2137586400, 825 },
+};
+
+const TzZone tz_zones[] = {
+  { 0, 0, 0 }, // UTC
+  { -600, 0, 0 }, // Pacific/Honolulu
+  { -540, 0, 24 }, // America/Anchorage
+  { -480, 24, 24 }, // America/Los_Angeles
+  { -420, 48, 24 }, // America/Denver
+  { -420, 0, 0 }, // America/Phoenix
+  { -360, 72, 24 }, // America/Chicago
+  { -360, 0, 0 }, // America/Mexico_City
+  { -300, 96, 24 }, // America/New_York
+  { -240, 120, 24 }, // America/Halifax
+  { -210, 144, 24 }, // America/St_Johns
+  { -180, 0, 0 }, // America/Sao_Paulo
+  { -180, 0, 0 }, // America/Argentina/Buenos_Aires
+  { -60, 168, 24 }, // Atlantic/Azores
+  { 0, 192, 24 }, // Europe/London
+  { 0, 192, 24 }, // Europe/Dublin
+  { 0, 192, 24 }, // Europe/Lisbon
+  { 60, 216, 24 }, // Europe/Paris
+  { 60, 216, 24 }, // Europe/Berlin
+  { 60, 216, 24 }, // Europe/Madrid
+  { 60, 216, 24 }, // Europe/Rome
+  { 60, 216, 24 }, // Europe/Amsterdam
+  { 60, 216, 24 }, // Europe/Stockholm
+  { 60, 216, 24 }, // Europe/Warsaw
+  { 120, 240, 24 }, // Europe/Athens
+  { 120, 240, 24 }, // Europe/Helsinki
+  { 120, 240, 24 }, // Europe/Kiev
+  { 180, 0, 0 }, // Europe/Istanbul
+  { 180, 0, 0 }, // Europe/Moscow
+  { 60, 0, 0 }, // Africa/Lagos
+  { 120, 264, 24 }, // Africa/Cairo
+  { 120, 0, 0 }, // Africa/Johannesburg
+  { 180, 0, 0 }, // Africa/Nairobi
+  { 120, 288, 24 }, // Asia/Jerusalem
+  { 210, 0, 0 }, // Asia/Tehran
+  { 240, 0, 0 }, // Asia/Dubai
+  { 270, 0, 0 }, // Asia/Kabul
+  { 300, 0, 0 }, // Asia/Karachi
+  { 330, 0, 0 }, // Asia/Kolkata
+  { 345, 0, 0 }, // Asia/Kathmandu
+  { 360, 0, 0 }, // Asia/Dhaka
+  { 390, 0, 0 }, // Asia/Yangon
+  { 420, 0, 0 }, // Asia/Bangkok
+  { 480, 0, 0 }, // Asia/Shanghai
+  { 480, 0, 0 }, // Asia/Hong_Kong
+  { 480, 0, 0 }, // Asia/Singapore
+  { 540, 0, 0 }, // Asia/Tokyo
+  { 540, 0, 0 }, // Asia/Seoul
+  { 480, 0, 0 }, // Australia/Perth
+  { 525, 0, 0 }, // Australia/Eucla
+  { 570, 0, 0 }, // Australia/Darwin
+  { 630, 312, 24 }, // Australia/Adelaide
+  { 600, 0, 0 }, // Australia/Brisbane
+  { 660, 336, 24 }, // Australia/Sydney
+  { 660, 360, 24 }, // Australia/Lord_Howe
+  { 660, 0, 0 }, // Pacific/Noumea
+  { 780, 384, 24 }, // Pacific/Auckland
+  { 825, 408, 24 }, // Pacific/Chatham
+  { 780, 0, 0 }, // Pacific/Tongatapu
+  { 840, 0, 0 }, // Pacific/Kiritimati
+};
+
+const uint8_t tz_zone_count = ARRAY_LENGTH(tz_zones);
@@ -0,0 +1,26 @@
+#pragma once
+#include <pebble.h>
+
+// the zone ID of the alternate clock when it uses the fixed hour offset of the settings
+#define TZ_ZONE_NONE 0
+
+// a change of the UTC offset of a zone
+typedef struct __attribute__((__packed__)) {
+  uint32_t utcTime;
+  int16_t offset; // minutes
+} TzTransition;
+
+// the offset of a zone at the start of the table, and its changes in tz_transitions
+typedef struct {
+  int16_t initialOffset; // minutes
+  uint16_t firstTransition;
+  uint16_t transitionCount;
+} TzZone;
+
+/*
+ * The offsets of the zones of the alternate clock, generated by tools/tz_rules.py.
+ * The zone ID sent by the phone is the index in tz_zones plus one
+ */
+extern const TzTransition tz_transitions[];
+extern const TzZone tz_zones[];
+extern const uint8_t tz_zone_count;
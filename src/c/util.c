@@ -25,14 +25,63 @@ void image_recolor(GDrawCommandImage *img, GColor fill_color, GColor stroke_colo
                              recolor_iterator_cb, &colors);
 }
 
-void util_image_draw(GContext* ctx, GDrawCommandImage *img, int xPosition, int yPosition) {
-  image_recolor(img, globalSettings.iconFillColor, globalSettings.iconStrokeColor);
-  gdraw_command_image_draw(ctx, img, GPoint(xPosition, yPosition));
+PaletteImage* util_image_create(uint32_t resourceId) {
+  GDrawCommandImage* image = gdraw_command_image_create_with_resource(resourceId);
+
+  if(!image) {
+    return NULL;
+  }
+
+  PaletteImage* img = malloc(sizeof(PaletteImage));
+
+  if(!img) {
+    gdraw_command_image_destroy(image);
+    return NULL;
+  }
+
+  // generation 0 is never current, so the first draw recolors
+  img->image = image;
+  img->invertedImage = NULL;
+  img->paletteGeneration = 0;
+  img->invertedPaletteGeneration = 0;
+
+  return img;
+}
+
+void util_image_destroy(PaletteImage *img) {
+  if(img) {
+    gdraw_command_image_destroy(img->image);
+    gdraw_command_image_destroy(img->invertedImage);
+    free(img);
+  }
 }
 
-void util_image_draw_inverted_color(GContext* ctx, GDrawCommandImage *img, int xPosition, int yPosition) {
-  image_recolor(img, globalSettings.iconStrokeColor, globalSettings.iconFillColor);
-  gdraw_command_image_draw(ctx, img, GPoint(xPosition, yPosition));
+void util_image_draw(GContext* ctx, PaletteImage *img, int xPosition, int yPosition) {
+  // only walk the commands if the palette changed since the last draw
+  if(img->paletteGeneration != globalSettings.iconPaletteGeneration) {
+    image_recolor(img->image, globalSettings.iconFillColor, globalSettings.iconStrokeColor);
+    img->paletteGeneration = globalSettings.iconPaletteGeneration;
+  }
+
+  gdraw_command_image_draw(ctx, img->image, GPoint(xPosition, yPosition));
+}
+
+void util_image_draw_inverted_color(GContext* ctx, PaletteImage *img, int xPosition, int yPosition) {
+  // the inverted colors live in their own copy, so that drawing both variants doesn't recolor each time
+  if(!img->invertedImage) {
+    img->invertedImage = gdraw_command_image_clone(img->image);
+
+    if(!img->invertedImage) {
+      return;
+    }
+  }
+
+  if(img->invertedPaletteGeneration != globalSettings.iconPaletteGeneration) {
+    image_recolor(img->invertedImage, globalSettings.iconStrokeColor, globalSettings.iconFillColor);
+    img->invertedPaletteGeneration = globalSettings.iconPaletteGeneration;
+  }
+
+  gdraw_command_image_draw(ctx, img->invertedImage, GPoint(xPosition, yPosition));
 }
 
 int16_t get_obstruction_height(Layer *s_window_layer) {
@@ -1,15 +1,32 @@
 #pragma once
 #include <pebble.h>
 
+/*
+ * An icon, along with the palette generation its commands were last recolored
+ * with. The inverted copy is only created if the icon is drawn inverted
+ */
+typedef struct {
+  GDrawCommandImage* image;
+  GDrawCommandImage* invertedImage;
+  uint16_t paletteGeneration;
+  uint16_t invertedPaletteGeneration;
+} PaletteImage;
+
+/*
+ * Load the icon from the resource, returns NULL if it can't be loaded
+ */
+PaletteImage* util_image_create(uint32_t resourceId);
+void util_image_destroy(PaletteImage *img);
+
 /*
  * Draw image at position with the specified fill and stroke colors
  */
-void util_image_draw(GContext* ctx, GDrawCommandImage *img, int xPosition, int yPosition);
+void util_image_draw(GContext* ctx, PaletteImage *img, int xPosition, int yPosition);
 
 /*
  * Draw image at position with the inverted fill and stroke colors
  */
-void util_image_draw_inverted_color(GContext* ctx, GDrawCommandImage *img, int xPosition, int yPosition);
+void util_image_draw_inverted_color(GContext* ctx, PaletteImage *img, int xPosition, int yPosition);
 
 /*
  * Get obstruction height of Timeline Quick View on the layer given as input
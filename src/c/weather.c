@@ -1,12 +1,48 @@
 #include <pebble.h>
 #include "weather.h"
 #include "settings.h"
+#include "scheduler.h"
+#include "messaging.h"
+#include "icon_pool.h"
+#include "storage.h"
+
+// the TTL of the weather data when the settings don't set one, the slots
+// keep the widgets correct for longer than the current conditions alone
+#define DEFAULT_TTL_SLOTS WEATHER_SLOT_SECONDS
+#define DEFAULT_TTL_NO_SLOTS SECONDS_PER_HOUR
+
+// the delay before asking again when a request brought no data, doubled
+// after each unanswered request up to the TTL
+#define RETRY_DELAY SECONDS_PER_MINUTE
+#define MAX_RETRY_SHIFT 8
+
+// the reconnections within this delay lead to a single request
+#define RECONNECT_DELAY 20
+
+// the forecast condition is the one of the slot about 9 hours from now
+#define FORECAST_CONDITION_DELAY (9 * SECONDS_PER_HOUR)
 
 WeatherInfo Weather_weatherInfo;
 WeatherForecastInfo Weather_weatherForecast;
 
-GDrawCommandImage* Weather_currentWeatherIcon;
-GDrawCommandImage* Weather_forecastWeatherIcon;
+PaletteImage* Weather_currentWeatherIcon;
+PaletteImage* Weather_forecastWeatherIcon;
+
+static WeatherSlotRing slotRing;
+
+static StorageRecord infoRecord;
+static StorageRecord forecastRecord;
+static StorageRecord slotsRecord;
+
+// updates the weather when the next slot starts
+static SchedulerJob slotJob;
+
+// asks the phone for new data when it's stale
+static SchedulerJob refreshJob;
+static bool refreshEnabled;
+static uint8_t unansweredRequests;
+
+static void scheduleRefresh(time_t due, uint32_t delay);
 
 static uint32_t getConditionIcon(WeatherCondition conditionCode) {
   uint32_t iconToLoad;
@@ -53,26 +89,257 @@ static uint32_t getConditionIcon(WeatherCondition conditionCode) {
   return iconToLoad;
 }
 
-void Weather_setCurrentCondition(int conditionCode) {
+// the forecast covers the day, so it doesn't show the night icons
+static WeatherCondition getDayCondition(WeatherCondition conditionCode) {
+  switch(conditionCode) {
+    case CLEAR_NIGHT:
+      return CLEAR_DAY;
+    case PARTLY_CLOUDY_NIGHT:
+      return PARTLY_CLOUDY;
+    default:
+      return conditionCode;
+  }
+}
 
-  uint32_t currentWeatherIcon = getConditionIcon(conditionCode);
+// the icons come from the pool, so the current and forecast icons share
+// their instance when they show the same condition
+static void loadCurrentIcon(uint32_t currentWeatherIcon) {
+  if(Weather_currentWeatherIcon && Weather_weatherInfo.currentIconResourceID == currentWeatherIcon) {
+    return;
+  }
 
   // ok, now load the new icon:
-  gdraw_command_image_destroy(Weather_currentWeatherIcon);
-  Weather_currentWeatherIcon = gdraw_command_image_create_with_resource(currentWeatherIcon);
+  IconPool_release(Weather_currentWeatherIcon);
+  Weather_currentWeatherIcon = IconPool_acquire(currentWeatherIcon);
 
   Weather_weatherInfo.currentIconResourceID = currentWeatherIcon;
 }
 
-void Weather_setForecastCondition(int conditionCode) {
-  uint32_t forecastWeatherIcon = getConditionIcon(conditionCode);
+static void loadForecastIcon(uint32_t forecastWeatherIcon) {
+  if(Weather_forecastWeatherIcon && Weather_weatherForecast.forecastIconResourceID == forecastWeatherIcon) {
+    return;
+  }
 
-  gdraw_command_image_destroy(Weather_forecastWeatherIcon);
-  Weather_forecastWeatherIcon = gdraw_command_image_create_with_resource(forecastWeatherIcon);
+  IconPool_release(Weather_forecastWeatherIcon);
+  Weather_forecastWeatherIcon = IconPool_acquire(forecastWeatherIcon);
 
   Weather_weatherForecast.forecastIconResourceID = forecastWeatherIcon;
 }
 
+static inline const WeatherSlot* getSlot(uint8_t index) {
+  return &slotRing.slots[(slotRing.first + index) % WEATHER_SLOT_COUNT];
+}
+
+// returns the index of the last slot started at now, or of the first slot
+static uint8_t findCurrentSlot(time_t now) {
+  uint8_t current = 0;
+
+  for(uint8_t i = 1; i < slotRing.count && getSlot(i)->time <= now; i++) {
+    current = i;
+  }
+
+  return current;
+}
+
+void Weather_setCurrentCondition(int conditionCode, time_t fetchTime) {
+  time_t now = time(NULL);
+
+  loadCurrentIcon(getConditionIcon(conditionCode));
+
+  // the observation is newer than the current slot, until the next one starts.
+  // The phone clock may be a little ahead of the watch
+  slotRing.currentTime = (fetchTime < now) ? fetchTime : now;
+
+  // the phone answered, the next request is due when this data expires
+  unansweredRequests = 0;
+
+  if(refreshEnabled) {
+    scheduleRefresh(slotRing.currentTime + Weather_getTTL(), Weather_getTTL());
+  }
+}
+
+void Weather_setForecastCondition(int conditionCode) {
+  loadForecastIcon(getConditionIcon(conditionCode));
+
+  // this provider doesn't send slots, the old ones would override its forecast
+  slotRing.count = 0;
+  Scheduler_cancel(&slotJob);
+}
+
+static uint16_t slot_job(time_t now) {
+  return Weather_update(now);
+}
+
+void Weather_setForecastSlots(const uint8_t* data, uint16_t length) {
+  uint8_t newCount = length / sizeof(WeatherSlot);
+
+  if(newCount == 0) {
+    return;
+  }
+
+  WeatherSlot newSlot;
+  memcpy(&newSlot, data, sizeof(WeatherSlot));
+
+  // the new slots replace the ones from their first slot onwards
+  while(slotRing.count > 0 && getSlot(slotRing.count - 1)->time >= newSlot.time) {
+    slotRing.count--;
+  }
+
+  for(uint8_t i = 0; i < newCount; i++) {
+    memcpy(&newSlot, data + i * sizeof(WeatherSlot), sizeof(WeatherSlot));
+
+    if(slotRing.count == WEATHER_SLOT_COUNT) {
+      // overwrite the oldest slot
+      slotRing.first = (slotRing.first + 1) % WEATHER_SLOT_COUNT;
+      slotRing.count--;
+    }
+
+    slotRing.slots[(slotRing.first + slotRing.count) % WEATHER_SLOT_COUNT] = newSlot;
+    slotRing.count++;
+  }
+
+  Weather_update(time(NULL));
+}
+
+uint16_t Weather_update(time_t now) {
+  if(slotRing.count == 0) {
+    return CHANGED_NONE;
+  }
+
+  bool changed = false;
+  uint8_t current = findCurrentSlot(now);
+  const WeatherSlot* slot = getSlot(current);
+
+  // the slot replaces the current conditions received before it started
+  if(slot->time <= now && slot->time > slotRing.currentTime) {
+    uint32_t currentIcon = getConditionIcon(slot->condition);
+
+    changed |= (Weather_weatherInfo.currentTemp != slot->temp);
+    Weather_weatherInfo.currentTemp = slot->temp;
+
+    if(Weather_weatherInfo.currentIconResourceID != currentIcon || !Weather_currentWeatherIcon) {
+      loadCurrentIcon(currentIcon);
+      changed = true;
+    }
+  }
+
+  // the forecast of the next 24 hours, from the current slot
+  int highTemp = slot->temp;
+  int lowTemp = slot->temp;
+  WeatherCondition forecastCondition = slot->condition;
+
+  for(uint8_t i = current + 1; i < slotRing.count; i++) {
+    slot = getSlot(i);
+
+    if(slot->time >= now + SECONDS_PER_DAY) {
+      break;
+    }
+
+    highTemp = (slot->temp > highTemp) ? slot->temp : highTemp;
+    lowTemp = (slot->temp < lowTemp) ? slot->temp : lowTemp;
+
+    if(slot->time <= now + FORECAST_CONDITION_DELAY) {
+      forecastCondition = slot->condition;
+    }
+  }
+
+  uint32_t forecastIcon = getConditionIcon(getDayCondition(forecastCondition));
+
+  changed |= (Weather_weatherForecast.highTemp != highTemp || Weather_weatherForecast.lowTemp != lowTemp);
+  Weather_weatherForecast.highTemp = highTemp;
+  Weather_weatherForecast.lowTemp = lowTemp;
+
+  if(Weather_weatherForecast.forecastIconResourceID != forecastIcon || !Weather_forecastWeatherIcon) {
+    loadForecastIcon(forecastIcon);
+    changed = true;
+  }
+
+  // update again when the next slot starts
+  if(current + 1 < slotRing.count && getSlot(current + 1)->time > now) {
+    Scheduler_schedule(&slotJob, slot_job, getSlot(current + 1)->time, 0);
+  } else {
+    Scheduler_cancel(&slotJob);
+  }
+
+  return changed ? CHANGED_WEATHER : CHANGED_NONE;
+}
+
+uint32_t Weather_getTTL(void) {
+  if(globalSettings.weatherTTL > 0) {
+    return globalSettings.weatherTTL * SECONDS_PER_MINUTE;
+  }
+
+  return (slotRing.count > 0) ? DEFAULT_TTL_SLOTS : DEFAULT_TTL_NO_SLOTS;
+}
+
+bool Weather_isRefreshNeeded(time_t now) {
+  return now - (time_t)slotRing.currentTime >= (time_t)Weather_getTTL();
+}
+
+static uint16_t refresh_job(time_t now) {
+  uint32_t ttl = Weather_getTTL();
+
+  if(!Weather_isRefreshNeeded(now)) {
+    scheduleRefresh(slotRing.currentTime + ttl, ttl);
+  } else if(bluetooth_connection_service_peek()) {
+    messaging_requestNewWeatherData();
+
+    // if no data comes back, ask again later and later
+    uint8_t shift = (unansweredRequests < MAX_RETRY_SHIFT) ? unansweredRequests : MAX_RETRY_SHIFT;
+    uint32_t delay = RETRY_DELAY << shift;
+
+    if(delay > ttl) {
+      delay = ttl;
+    }
+
+    unansweredRequests++;
+    scheduleRefresh(now + delay, delay);
+  }
+
+  // otherwise, the reconnection will ask for it
+
+  return CHANGED_NONE;
+}
+
+// the jitter delays the requests by up to a quarter of the delay, so that
+// the watches don't all ask at once
+static void scheduleRefresh(time_t due, uint32_t delay) {
+  time_t now = time(NULL);
+
+  if(due < now) {
+    due = now;
+  }
+
+  Scheduler_schedule(&refreshJob, refresh_job, due + rand() % (delay / 4 + 1), 0);
+}
+
+void Weather_enableRefresh(bool enable) {
+  refreshEnabled = enable;
+
+  if(!enable) {
+    Scheduler_cancel(&refreshJob);
+  } else if(unansweredRequests == 0) {
+    // the TTL may have changed, a pending retry keeps its backoff
+    scheduleRefresh(slotRing.currentTime + Weather_getTTL(), Weather_getTTL());
+  }
+}
+
+void Weather_refreshSoon(void) {
+  if(!refreshEnabled) {
+    return;
+  }
+
+  time_t due = time(NULL) + RECONNECT_DELAY;
+
+  // a request is already coming
+  if(refreshJob.scheduled && refreshJob.due <= due) {
+    return;
+  }
+
+  unansweredRequests = 0;
+  Scheduler_schedule(&refreshJob, refresh_job, due, 0);
+}
+
 void Weather_init(void) {
   // if possible, load weather data from persistent storage
   if (persist_exists(WEATHERINFO_PERSIST_KEY) && !globalSettings.disableWeather) {
@@ -82,7 +349,7 @@ void Weather_init(void) {
 
     Weather_weatherInfo = w;
 
-    Weather_currentWeatherIcon = gdraw_command_image_create_with_resource(w.currentIconResourceID);
+    Weather_currentWeatherIcon = IconPool_acquire(w.currentIconResourceID);
 
   } else {
 
@@ -99,7 +366,7 @@ void Weather_init(void) {
 
     Weather_weatherForecast = w;
 
-    Weather_forecastWeatherIcon = gdraw_command_image_create_with_resource(w.forecastIconResourceID);
+    Weather_forecastWeatherIcon = IconPool_acquire(w.forecastIconResourceID);
 
   } else {
     // printf("forecast key does not exist!");
@@ -108,12 +375,24 @@ void Weather_init(void) {
     Weather_weatherForecast.highTemp = INT32_MIN;
     Weather_weatherForecast.lowTemp = INT32_MIN;
   }
+
+  if (persist_exists(WEATHERSLOTS_PERSIST_KEY) && !globalSettings.disableWeather) {
+    persist_read_data(WEATHERSLOTS_PERSIST_KEY, &slotRing, sizeof(WeatherSlotRing));
+
+    // the slots may have moved on while the watchface wasn't running
+    Weather_update(time(NULL));
+  }
+
+  Storage_track(&infoRecord, WEATHERINFO_PERSIST_KEY, &Weather_weatherInfo, sizeof(WeatherInfo));
+  Storage_track(&forecastRecord, WEATHERFORECAST_PERSIST_KEY, &Weather_weatherForecast, sizeof(WeatherForecastInfo));
+  Storage_track(&slotsRecord, WEATHERSLOTS_PERSIST_KEY, &slotRing, sizeof(WeatherSlotRing));
 }
 
 void Weather_saveData(void) {
-  // printf("saving data!");
-  persist_write_data(WEATHERINFO_PERSIST_KEY, &Weather_weatherInfo, sizeof(WeatherInfo));
-  persist_write_data(WEATHERFORECAST_PERSIST_KEY, &Weather_weatherForecast, sizeof(WeatherForecastInfo));
+  // only the parts which changed are written, a little later
+  Storage_markDirty(&infoRecord);
+  Storage_markDirty(&forecastRecord);
+  Storage_markDirty(&slotsRecord);
 }
 
 void Weather_deinit(void) {
@@ -122,7 +401,13 @@ void Weather_deinit(void) {
     Weather_saveData();
   }
 
+  Scheduler_cancel(&slotJob);
+  Scheduler_cancel(&refreshJob);
+
   // free memory
-  gdraw_command_image_destroy(Weather_currentWeatherIcon);
-  gdraw_command_image_destroy(Weather_forecastWeatherIcon);
+  IconPool_release(Weather_currentWeatherIcon);
+  IconPool_release(Weather_forecastWeatherIcon);
+
+  Weather_currentWeatherIcon = NULL;
+  Weather_forecastWeatherIcon = NULL;
 }
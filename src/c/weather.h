@@ -1,9 +1,15 @@
 #pragma once
 #include <pebble.h>
+#include "util.h"
 
 // persistent storage
 #define WEATHERINFO_PERSIST_KEY 2
 #define WEATHERFORECAST_PERSIST_KEY 222
+#define WEATHERSLOTS_PERSIST_KEY 223
+
+// the forecast slots sent by the phone cover the next 24 hours, three hours apart
+#define WEATHER_SLOT_COUNT 8
+#define WEATHER_SLOT_SECONDS (3 * SECONDS_PER_HOUR)
 
 typedef struct {
   int currentTemp;
@@ -16,6 +22,39 @@ typedef struct {
   uint32_t forecastIconResourceID;
 } WeatherForecastInfo;
 
+// a forecast slot, as packed by the phone
+typedef struct __attribute__((__packed__)) {
+  uint32_t time;      // UTC
+  int8_t temp;        // celsius
+  uint8_t condition;  // WeatherCondition
+} WeatherSlot;
+
+// the last forecast slots received, the oldest are overwritten first
+typedef struct {
+  WeatherSlot slots[WEATHER_SLOT_COUNT];
+  uint8_t first;
+  uint8_t count;
+  uint32_t currentTime; // when the current conditions were received
+} WeatherSlotRing;
+
+// the weather sent by the phone, in a byte array followed by slotCount slots
+#define WEATHER_PAYLOAD_VERSION 1
+
+#define WEATHER_PAYLOAD_CURRENT  (1 << 0)
+#define WEATHER_PAYLOAD_FORECAST (1 << 1)
+
+typedef struct __attribute__((__packed__)) {
+  uint8_t version;
+  uint8_t flags;              // the parts of the payload which are set
+  uint32_t time;              // UTC, when the phone fetched the data
+  int8_t currentTemp;         // celsius
+  uint8_t currentCondition;   // WeatherCondition
+  int8_t highTemp;            // celsius
+  int8_t lowTemp;             // celsius
+  uint8_t forecastCondition;  // WeatherCondition
+  uint8_t slotCount;
+} WeatherPayload;
+
 typedef enum {
   CLEAR_DAY           = 0,
   CLEAR_NIGHT         = 1,
@@ -34,12 +73,45 @@ typedef enum {
 extern WeatherInfo Weather_weatherInfo;
 extern WeatherForecastInfo Weather_weatherForecast;
 
-extern GDrawCommandImage* Weather_currentWeatherIcon;
-extern GDrawCommandImage* Weather_forecastWeatherIcon;
+extern PaletteImage* Weather_currentWeatherIcon;
+extern PaletteImage* Weather_forecastWeatherIcon;
+
 
+// fetchTime is when the phone fetched the conditions, which sets their age
+void Weather_setCurrentCondition(int conditionCode, time_t fetchTime);
 
-void Weather_setCurrentCondition(int conditionCode);
+// sets a daily forecast, which replaces the forecast slots
 void Weather_setForecastCondition(int conditionCode);
+
+/*
+ * Adds the packed slots received from the phone to the ring, replacing the
+ * slots they overlap, and updates the weather of now from them
+ */
+void Weather_setForecastSlots(const uint8_t* data, uint16_t length);
+
+/*
+ * Picks the current conditions and the forecast of the next 24 hours from the
+ * slots, and returns CHANGED_WEATHER if they changed
+ */
+uint16_t Weather_update(time_t now);
+
+// the age, in seconds, at which the weather data should be fetched again
+uint32_t Weather_getTTL(void);
+
+// whether the weather data is older than the TTL
+bool Weather_isRefreshNeeded(time_t now);
+
+/*
+ * Asks the phone for new data once the current data is older than the TTL.
+ * While the phone doesn't answer, it asks again with an exponential backoff
+ */
+void Weather_enableRefresh(bool enable);
+
+// asks for new data soon if it's stale, e.g. after a reconnection. The calls
+// within a few seconds lead to a single request
+void Weather_refreshSoon(void);
+
+// the data is written to persistent storage a little later, if it changed
 void Weather_saveData(void);
 void Weather_init(void);
 void Weather_deinit(void);
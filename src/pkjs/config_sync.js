@@ -0,0 +1,158 @@
+/*
+ sends the settings to the watch. Only the settings which changed since the
+ config the watch acknowledged last are sent, with the hash of the config they
+ apply to: when the watch has another one, it asks for every setting again
+*/
+
+// { hash, values } of the config the watch acknowledged
+var STORAGE_KEY = 'config_acked';
+
+// the inbox of the watch is 305 bytes, see messaging_init()
+var MAX_MESSAGE_BYTES = 280;
+
+// the key, type and length of a tuple, before its value
+var TUPLE_HEADER_BYTES = 7;
+
+function loadAcked() {
+  try {
+    return JSON.parse(window.localStorage.getItem(STORAGE_KEY));
+  } catch(err) {
+    return null;
+  }
+}
+
+// FNV-1a of the sorted settings. It's sent as an int32, so the top bit is
+// dropped, and it's never 0, which the watch uses for "unknown"
+function hashConfig(values) {
+  var names = Object.keys(values).sort();
+  var hash = 2166136261;
+
+  for(var i = 0; i < names.length; i++) {
+    var text = names[i] + '=' + JSON.stringify(values[names[i]]) + ';';
+
+    for(var j = 0; j < text.length; j++) {
+      hash ^= text.charCodeAt(j);
+      hash = (hash + (hash << 1) + (hash << 4) + (hash << 7) + (hash << 8) + (hash << 24)) >>> 0;
+    }
+  }
+
+  return (hash & 0x7FFFFFFF) || 1;
+}
+
+function getTupleSize(value) {
+  if(typeof value === 'string') {
+    // UTF-8, plus the terminating zero
+    return TUPLE_HEADER_BYTES + unescape(encodeURIComponent(value)).length + 1;
+  }
+
+  return TUPLE_HEADER_BYTES + 4;
+}
+
+// splits the changes in messages which fit in the inbox, with the hashes
+function splitChanges(changes) {
+  var messages = [];
+  var message = {};
+  var size = 1 + 2 * getTupleSize(0);
+
+  for(var name in changes) {
+    var tupleSize = getTupleSize(changes[name]);
+
+    if(Object.keys(message).length > 0 && size + tupleSize > MAX_MESSAGE_BYTES) {
+      messages.push(message);
+      message = {};
+      size = 1 + 2 * getTupleSize(0);
+    }
+
+    message[name] = changes[name];
+    size += tupleSize;
+  }
+
+  if(Object.keys(message).length > 0) {
+    messages.push(message);
+  }
+
+  return messages;
+}
+
+// each message moves the watch from the config of base to the next one
+function sendMessages(messages, values, base, callback) {
+  if(messages.length === 0) {
+    callback(true);
+    return;
+  }
+
+  var message = messages.shift();
+  var nextValues = {};
+  var name;
+
+  for(name in values) {
+    nextValues[name] = values[name];
+  }
+
+  for(name in message) {
+    nextValues[name] = message[name];
+  }
+
+  var hash = hashConfig(nextValues);
+
+  message.SettingConfigHash = hash;
+
+  if(base) {
+    message.SettingConfigBase = base;
+  }
+
+  console.log('Preparing config message: ', JSON.stringify(message));
+
+  Pebble.sendAppMessage(message, function() {
+    window.localStorage.setItem(STORAGE_KEY, JSON.stringify({ hash: hash, values: nextValues }));
+
+    sendMessages(messages, nextValues, hash, callback);
+  }, function() {
+    // the next config is compared with the last one acknowledged, so
+    // what wasn't sent goes with it
+    console.log('Failed to send config data!');
+    callback(false);
+  });
+}
+
+/*
+ Sends the settings of values, a dictionary for Pebble.sendAppMessage, which
+ differ from the acknowledged ones, or all of them if full is set. Calls back
+ with whether the watch acknowledged all of them
+*/
+function sendConfig(values, full, callback) {
+  var acked = full ? null : loadAcked();
+  var ackedValues = acked ? acked.values : {};
+  var changes = {};
+
+  for(var name in values) {
+    if(!acked || JSON.stringify(ackedValues[name]) !== JSON.stringify(values[name])) {
+      changes[name] = values[name];
+    }
+  }
+
+  sendMessages(splitChanges(changes), ackedValues, acked ? acked.hash : 0, callback);
+}
+
+/*
+ Sends every acknowledged setting again if the watch asks for them, returns
+ whether the message was such a request
+*/
+function handleMessage(payload, callback) {
+  if(payload.ConfigResync === undefined) {
+    return false;
+  }
+
+  var acked = loadAcked();
+
+  console.log('The watch asked for the whole config');
+
+  if(acked) {
+    sendConfig(acked.values, true, callback);
+  }
+
+  return true;
+}
+
+module.exports.sendConfig = sendConfig;
+module.exports.handleMessage = handleMessage;
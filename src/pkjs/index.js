@@ -1,6 +1,9 @@
 
 var weather = require('./weather');
 var languages = require('./languages');
+var profiling = require('./profiling');
+var configSync = require('./config_sync');
+var tzZones = require('./tz_zones');
 
 // Require the keys' numeric values.
 var keys = require('message_keys');
@@ -29,9 +32,17 @@ Pebble.addEventListener('ready',
 );
 
 // Listen for incoming messages
-// when one is received, we simply assume that it is a request for new weather data
+// besides the profiling records, we simply assume that it is a request for new weather data
 Pebble.addEventListener('appmessage',
   function(msg) {
+    if(profiling.handleMessage(msg.payload)) {
+      return;
+    }
+
+    if(configSync.handleMessage(msg.payload, configSent)) {
+      return;
+    }
+
     console.log('Received message: ' + JSON.stringify(msg.payload));
 
     // in the case of receiving this, we assume the watch does, in fact, need weather data
@@ -209,6 +220,11 @@ Pebble.addEventListener('webviewclosed', function(e) {
       window.localStorage.setItem('weather_loc_lng', configData.weather_loc_lng);
     }
 
+    // how long a GPS fix is used for, in minutes
+    if(configData.location_max_age !== undefined) {
+      window.localStorage.setItem('location_max_age', configData.location_max_age);
+    }
+
     if(configData.weather_datasource) {
       window.localStorage.setItem('weather_datasource', configData.weather_datasource);
       window.localStorage.setItem('weather_api_key', configData.weather_api_key);
@@ -239,6 +255,17 @@ Pebble.addEventListener('webviewclosed', function(e) {
       dict.SettingAltClockOffset = parseInt(configData.altclock_offset, 10);
     }
 
+    // a zone follows its daylight saving time, unlike the offset
+    // zones missing from the watch table fall back to the offset
+    if(configData.altclock_zone !== undefined) {
+      dict.SettingAltClockZone = tzZones.indexOf(configData.altclock_zone) + 1;
+    }
+
+    // how old the weather can get before the watch asks for more, in minutes
+    if(configData.weather_ttl !== undefined) {
+      dict.SettingWeatherTTL = parseInt(configData.weather_ttl, 10) || 0;
+    }
+
     if(watch.platform != "aplite"){
       if(configData.decimal_separator) {
         dict.SettingDecimalSep = configData.decimal_separator;
@@ -288,49 +315,31 @@ Pebble.addEventListener('webviewclosed', function(e) {
 
     window.localStorage.setItem('enable_forecast', enableForecast);
 
-    console.log('Preparing message: ', JSON.stringify(dict));
-
-    // Send settings to Pebble watchapp
-    Pebble.sendAppMessage(dict, function(){
-      // Second part of data (send datas in 2 part in order to reduce buffer size on Pebble watch)
-      if(configData.language_id !== undefined) {
-        // reset the structure
-        dict = {};
-
-        for (i = 0; i < 7; i++) {
-          dict[keys.SettingLanguageDayNames + i] = languages.dayNames[configData.language_id][i];
-        }
-        for (i = 0; i < 12; i++) {
-          dict[keys.SettingLanguageMonthNames + i] = languages.monthNames[configData.language_id][i];
-        }
-        dict.SettingLanguageWordForWeek = languages.wordForWeek[configData.language_id];
-
-        console.log('Preparing language message: ', JSON.stringify(dict));
-
-        // Send language information to Pebble watchapp
-        Pebble.sendAppMessage(dict, function(){
-          console.log('Sent language data to Pebble, now trying to get weather');
-
-          if(window.localStorage.getItem('disable_weather') != 'yes') {
-            // after sending config data, force a weather refresh in case that changed
-            weather.updateWeather(true);
-          }
-        }, function() {
-            console.log('Failed to send language data!');
-        });
-      } else {
-        console.log('Sent config data to Pebble, now trying to get weather');
-
-        if(window.localStorage.getItem('disable_weather') != 'yes') {
-          // after sending config data, force a weather refresh in case that changed
-          weather.updateWeather(true);
-        }
+    if(configData.language_id !== undefined) {
+      for (i = 0; i < 7; i++) {
+        dict[keys.SettingLanguageDayNames + i] = languages.dayNames[configData.language_id][i];
+      }
+      for (i = 0; i < 12; i++) {
+        dict[keys.SettingLanguageMonthNames + i] = languages.monthNames[configData.language_id][i];
       }
-    }, function() {
-        console.log('Failed to send config data!');
-    });
+      dict.SettingLanguageWordForWeek = languages.wordForWeek[configData.language_id];
+    }
+
+    // Send the settings which changed to Pebble watchapp, in as many messages as needed
+    configSync.sendConfig(dict, false, configSent);
   } else {
     console.log("No settings changed!");
   }
 
 });
+
+function configSent(success) {
+  if(success) {
+    console.log('Sent config data to Pebble, now trying to get weather');
+
+    if(window.localStorage.getItem('disable_weather') != 'yes') {
+      // after sending config data, force a weather refresh in case that changed
+      weather.updateWeather(true);
+    }
+  }
+}
@@ -0,0 +1,91 @@
+/* logs the profiling records sent by watchfaces built with PROFILING, see src/c/profiling.h */
+
+var LAYERS = ['clock', 'sidebar', 'widgets'];
+
+var COUNTERS = ['ticks', 'messages_in', 'bytes_in', 'messages_out', 'bytes_out',
+                'persist_writes', 'persist_bytes'];
+
+var headerLogged = false;
+
+// same field order as ProfileRecord, all little endian
+function decodeRecord(bytes) {
+  var offset = 0;
+  var fields = [];
+
+  function read(size) {
+    var value = 0;
+
+    for(var i = size - 1; i >= 0; i--) {
+      value = value * 256 + bytes[offset + i];
+    }
+
+    offset += size;
+    return value;
+  }
+
+  fields.push(new Date(read(4) * 1000).toISOString());
+
+  var renders = { count: [], ms: [], maxMs: [] };
+  var i;
+
+  for(i = 0; i < LAYERS.length; i++) {
+    renders.count.push(read(2));
+  }
+
+  for(i = 0; i < LAYERS.length; i++) {
+    renders.ms.push(read(2));
+  }
+
+  for(i = 0; i < LAYERS.length; i++) {
+    renders.maxMs.push(read(2));
+  }
+
+  for(i = 0; i < LAYERS.length; i++) {
+    fields.push(renders.count[i], renders.ms[i], renders.maxMs[i]);
+  }
+
+  for(i = 0; i < COUNTERS.length; i++) {
+    fields.push(read(4));
+  }
+
+  // heap used max, heap free min
+  fields.push(read(4), read(4));
+
+  return fields;
+}
+
+function getHeader() {
+  var columns = ['platform', 'start'];
+
+  LAYERS.forEach(function(layer) {
+    columns.push(layer + '_renders', layer + '_ms', layer + '_max_ms');
+  });
+
+  return columns.concat(COUNTERS, ['heap_used_max', 'heap_free_min']).join(',');
+}
+
+function getPlatform() {
+  try {
+    return Pebble.getActiveWatchInfo().platform;
+  } catch(err) {
+    return 'unknown';
+  }
+}
+
+// returns true if the message was a profiling record
+function handleMessage(payload) {
+  if(payload.ProfilingRecord === undefined) {
+    return false;
+  }
+
+  if(!headerLogged) {
+    console.log(getHeader());
+    headerLogged = true;
+  }
+
+  console.log([getPlatform()].concat(decodeRecord(payload.ProfilingRecord)).join(','));
+
+  return true;
+}
+
+module.exports.handleMessage = handleMessage;
@@ -8,10 +8,38 @@ var weatherProviders = {
 
 var DEFAULT_WEATHER_PROVIDER = 'owm';
 
-// get new forecasts if 3 hours have elapsed
-var FORECAST_MAX_AGE = 3 * 60 * 60 * 1000;
-var MAX_FAILURES = 3;
-var currentFailures = 0;
+// the responses are cached by URL, which holds the provider, the kind of data
+// and the rounded coordinates, so the requests from nearby positions share it
+var CURRENT_MAX_AGE = 10 * 60 * 1000;
+var FORECAST_MAX_AGE = 60 * 60 * 1000;
+var CACHE_STORAGE_KEY = 'weather_cache';
+
+// two decimals are about a kilometer
+var COORDINATE_DECIMALS = 2;
+
+// the callbacks waiting for each request in flight
+var inFlightRequests = {};
+
+// a request which didn't answer by then failed, its waiters aren't kept forever
+var REQUEST_TIMEOUT = 15000;
+
+// the weather waiting for the message in flight
+var pendingWeather = null;
+var sendingWeather = false;
+
+// the last GPS fix, { latitude, longitude, accuracy, time }, is used again
+// while it's younger than the location_max_age setting, in minutes.
+// Its coordinates only move once the user is LOCATION_MOVE_KM away from them,
+// so that the requests, and their cache, stay the same in the meantime
+var LOCATION_STORAGE_KEY = 'location_cache';
+var DEFAULT_LOCATION_MAX_AGE = 30;
+var LOCATION_MOVE_KM = 2;
+var EARTH_RADIUS_KM = 6371;
+
+// a message the watch didn't take is sent again after 2, 4, 8... seconds,
+// plus up to as much again of jitter
+var SEND_RETRY_DELAY = 2000;
+var MAX_SEND_ATTEMPTS = 5;
 
 // icon codes for sending weather icons to pebble
 var WeatherIcons = {
@@ -57,32 +85,27 @@ function updateWeather(forceUpdate) {
 
     // console.log("Stored lat: " +  storedLat + ", stored lng: " + storedLng);
 
+    // the configuration may have changed, so don't use the cached responses.
+    // The cached location stays, the user didn't move because of it
+    if(forceUpdate) {
+      window.localStorage.removeItem(CACHE_STORAGE_KEY);
+    }
+
     if(weatherLoc) { // do we have a stored location?
+      var location;
+
       // if so, we should check if we have valid LAT and LNG coords
       hasLocationCoords = (storedLat != undefined && storedLng != undefined)
                        && (storedLat != '' && storedLng != '');
       if(hasLocationCoords) { // do we have valid stored coordinates?
         // if we have valid coords, use them
-        var pos = {
-                    coords : {
-                      latitude : storedLat,
-                      longitude : storedLng
-                    }
-                  };
-
-        getCurrentWeatherProvider().getWeatherFromCoords(pos);
-
-        if(forceUpdate || isForecastNeeded()) {
-          getCurrentWeatherProvider().getForecastFromCoords(pos);
-        }
+        location = roundLocation(storedLat, storedLng);
       } else {
         // otherwise, use the stored string (legacy, or google was blocked from running)
-        getCurrentWeatherProvider().getWeather(weatherLoc);
-
-        if(forceUpdate || isForecastNeeded()) {
-          getCurrentWeatherProvider().getForecast(weatherLoc);
-        }
+        location = { name: weatherLoc };
       }
+
+      fetchWeather(location);
     } else {
       // if we don't have a stored location, get the GPS location
       getLocation();
@@ -91,87 +114,330 @@ function updateWeather(forceUpdate) {
 }
 
 function getLocation() {
+  var cached = loadLocation();
+  var maxAge = getLocationMaxAge();
+
+  // waking the GPS up is what costs the most battery, so a recent fix will do
+  if(cached && Date.now() - cached.time < maxAge) {
+    console.log('Using the cached location');
+    fetchWeather(roundLocation(cached.latitude, cached.longitude));
+    return;
+  }
+
+  // the phone may have a fix of its own, from another app
   navigator.geolocation.getCurrentPosition(
     locationSuccess,
     locationError,
-    {timeout: 15000, maximumAge: 60000}
+    {timeout: 15000, maximumAge: maxAge, enableHighAccuracy: false}
   );
 }
 
 function locationError(err) {
-  console.log('location error on the JS side! Failure #' + currentFailures);
-  //if we fail, try using the cached location
-  if(currentFailures <= MAX_FAILURES) {
-    // reset cache time
-    window.localStorage.setItem('weather_loc_cache_time', (new Date().getTime() / 1000));
-
-    currentFailures++;
-    // try again
-    updateWeather();
-  } else {
-    // until we get too many failures, at which point give up
-    currentFailures = 0;
+  var cached = loadLocation();
+
+  console.log('location error on the JS side!');
+
+  // an old fix is better than no weather. Without one, give up: the watch
+  // asks again once its backoff expires
+  if(cached) {
+    fetchWeather(roundLocation(cached.latitude, cached.longitude));
   }
 }
 
 function locationSuccess(pos) {
-  getCurrentWeatherProvider().getWeatherFromCoords(pos);
+  var cached = loadLocation();
+  var fix = {
+    latitude: pos.coords.latitude,
+    longitude: pos.coords.longitude,
+    accuracy: pos.coords.accuracy,
+    time: Date.now()
+  };
+
+  // close enough to the cached fix, keep its coordinates
+  if(cached && getDistanceKm(cached, fix) < LOCATION_MOVE_KM) {
+    fix.latitude = cached.latitude;
+    fix.longitude = cached.longitude;
+  }
+
+  window.localStorage.setItem(LOCATION_STORAGE_KEY, JSON.stringify(fix));
 
-  if(isForecastNeeded()) {
-    setTimeout(function() { getCurrentWeatherProvider().getForecastFromCoords(pos); }, 5000);
+  fetchWeather(roundLocation(fix.latitude, fix.longitude));
+}
+
+function loadLocation() {
+  try {
+    return JSON.parse(window.localStorage.getItem(LOCATION_STORAGE_KEY));
+  } catch(err) {
+    return null;
   }
 }
 
+// in milliseconds
+function getLocationMaxAge() {
+  var minutes = parseInt(window.localStorage.getItem('location_max_age'), 10);
+
+  return (isNaN(minutes) ? DEFAULT_LOCATION_MAX_AGE : minutes) * 60 * 1000;
+}
+
+// the great-circle distance between two { latitude, longitude }
+function getDistanceKm(from, to) {
+  var toRadians = Math.PI / 180;
+  var dLat = (to.latitude - from.latitude) * toRadians;
+  var dLng = (to.longitude - from.longitude) * toRadians;
+
+  var a = Math.sin(dLat / 2) * Math.sin(dLat / 2) +
+          Math.cos(from.latitude * toRadians) * Math.cos(to.latitude * toRadians) *
+          Math.sin(dLng / 2) * Math.sin(dLng / 2);
+
+  return 2 * EARTH_RADIUS_KM * Math.atan2(Math.sqrt(a), Math.sqrt(1 - a));
+}
+
+// nearby positions make the same requests, which can then be cached
+function roundLocation(latitude, longitude) {
+  return {
+    latitude : Number(latitude).toFixed(COORDINATE_DECIMALS),
+    longitude : Number(longitude).toFixed(COORDINATE_DECIMALS)
+  };
+}
+
+// the provider fetches the current conditions and, if needed, the forecast,
+// which are sent to the watch in one message. The slots are fetched for any
+// weather widget, they keep the current conditions right without a connection
+function fetchWeather(location) {
+  var options = { forecast: isForecastNeeded(), slots: true };
+
+  getCurrentWeatherProvider().fetch(location, options, function(record) {
+    if(record) {
+      sendWeatherToPebble(record);
+    } else {
+      console.log('No weather data from the provider');
+    }
+  });
+}
+
 function isForecastNeeded() {
-  var enableForecast = window.localStorage.getItem('enable_forecast');
-  var lastForecastTime = window.localStorage.getItem('last_forecast_time');
-  var forecastAge = Date.now() - lastForecastTime;
+  // the forecast cache decides whether it's actually fetched
+  return window.localStorage.getItem('enable_forecast') === 'yes';
+}
 
-  console.log("Forecast requested! Age is " + forecastAge);
+function loadCache() {
+  try {
+    return JSON.parse(window.localStorage.getItem(CACHE_STORAGE_KEY)) || {};
+  } catch(err) {
+    return {};
+  }
+}
 
-  if(enableForecast === 'yes' && forecastAge > FORECAST_MAX_AGE) {
-    return true;
-  } else {
-    return false;
+function storeResponse(url, responseText) {
+  var cache = loadCache();
+  var now = Date.now();
+
+  // drop the responses too old for any kind of data
+  for(var key in cache) {
+    if(now - cache[key].time >= FORECAST_MAX_AGE) {
+      delete cache[key];
+    }
+  }
+
+  cache[url] = { time: now, responseText: responseText };
+
+  window.localStorage.setItem(CACHE_STORAGE_KEY, JSON.stringify(cache));
+}
+
+/*
+ GETs the url, unless it was fetched less than maxAge milliseconds ago, and
+ calls back with the response text and the time it was fetched at, or null if
+ the request failed or timed out. The calls made while the same url is in
+ flight wait for its response instead of making their own request
+*/
+function cachedRequest(url, maxAge, callback) {
+  var cached = loadCache()[url];
+
+  if(cached && Date.now() - cached.time < maxAge) {
+    console.log('Using the cached response for ' + url);
+
+    // like the requests, call back once the caller is done
+    setTimeout(function() { callback(cached.responseText, cached.time); }, 0);
+    return;
+  }
+
+  if(inFlightRequests[url]) {
+    inFlightRequests[url].push(callback);
+    return;
+  }
+
+  inFlightRequests[url] = [callback];
+
+  var xhr = new XMLHttpRequest();
+  var finished = false;
+
+  // calls the waiters once, whatever ends the request. A late event of this
+  // request doesn't take the waiters of the next one
+  function finish(responseText, fetchTime) {
+    if(finished) {
+      return;
+    }
+
+    var callbacks = inFlightRequests[url];
+    finished = true;
+    clearTimeout(guardTimer);
+    delete inFlightRequests[url];
+
+    for(var i = 0; i < callbacks.length; i++) {
+      callbacks[i](responseText, fetchTime);
+    }
+  }
+
+  function fail() {
+    finish(null, 0);
+  }
+
+  // in case the XMLHttpRequest of the phone ignores the timeout
+  var guardTimer = setTimeout(function() {
+    console.log('Request timed out: ' + url);
+    fail();
+    xhr.abort();
+  }, REQUEST_TIMEOUT + 1000);
+
+  xhr.onload = function () {
+    // only the successful responses are cached, the others are retried
+    if(!finished && this.status == 200) {
+      storeResponse(url, this.responseText);
+    }
+
+    finish(this.responseText, Date.now());
+  };
+  xhr.onerror = fail;
+  xhr.ontimeout = fail;
+  xhr.onabort = fail;
+  xhr.open('GET', url);
+  xhr.timeout = REQUEST_TIMEOUT;
+  xhr.send();
+}
+
+// sends the parts of the weather which are set: current ({ temp, condition, fetchTime }),
+// forecast ({ highTemp, lowTemp, condition }) and slots ({ time, temp, condition }).
+// The watch takes one message at a time, so the parts coming in meanwhile
+// are merged in the next message
+function sendWeatherToPebble(weather) {
+  pendingWeather = pendingWeather || {};
+
+  for(var part in weather) {
+    pendingWeather[part] = weather[part];
+  }
+
+  if(!sendingWeather) {
+    sendingWeather = true;
+
+    // the parts completed at the same time, e.g. from the cache, go together
+    setTimeout(sendPendingWeather, 0);
   }
 }
 
-function sendWeatherToPebble(dictionary) {
+function sendPendingWeather() {
+  var dictionary = {
+    'WeatherData': packWeatherPayload(pendingWeather)
+  };
+
+  console.log(JSON.stringify(pendingWeather));
+  pendingWeather = null;
+
+  sendDictionary(dictionary, 0, function() {
+    if(pendingWeather) {
+      sendPendingWeather();
+    } else {
+      sendingWeather = false;
+    }
+  });
+}
+
+function sendDictionary(dictionary, attempt, done) {
   // Send to Pebble
   Pebble.sendAppMessage(dictionary,
     function(e) {
       console.log('Weather info sent to Pebble successfully!');
+      done();
     },
     function(e) {
-      // if we fail, wait a couple seconds, then try again
-      if(currentFailures < failureRetryAmount) {
-        // call it again somewhere between 3 and 10 seconds
-        setTimeout(updateWeather, Math.floor(Math.random() * 10000) + 3000);
+      console.log('Error sending weather info to Pebble! Attempt: #' + (attempt + 1));
 
-        currentFailures++;
+      // the data is still fresh, so send it again rather than fetching it again.
+      // Past the last attempt, the watch asks again once its own backoff expires
+      if(attempt + 1 < MAX_SEND_ATTEMPTS) {
+        var delay = SEND_RETRY_DELAY * Math.pow(2, attempt);
+
+        setTimeout(function() {
+          sendDictionary(dictionary, attempt + 1, done);
+        }, delay + Math.floor(Math.random() * delay));
       } else {
-        currentFailures = 0;
+        done();
       }
-
-      console.log('Error sending weather info to Pebble! Count: #' + currentFailures);
     }
   );
 }
 
-var xhrRequest = function (url, type, callback) {
-  var xhr = new XMLHttpRequest();
-  xhr.onload = function () {
-    callback(this.responseText);
-  };
-  xhr.open(type, url);
-  xhr.send();
-};
+// the layout of WeatherPayload in weather.h, little endian: version, flags,
+// uint32 fetch time, current temp and icon, forecast high, low and icon, slot
+// count, then each slot as a uint32 UTC time, a temp and an icon.
+// The temperatures are int8 celsius
+var WEATHER_PAYLOAD_VERSION = 1;
+var PAYLOAD_CURRENT  = 1 << 0;
+var PAYLOAD_FORECAST = 1 << 1;
+
+// the watch keeps 8 slots
+var FORECAST_SLOT_COUNT = 8;
+
+function packInt8(value) {
+  return Math.max(-128, Math.min(127, Math.round(value))) & 0xFF;
+}
+
+function packUint32(bytes, value) {
+  bytes.push(value & 0xFF, (value >>> 8) & 0xFF, (value >>> 16) & 0xFF, (value >>> 24) & 0xFF);
+}
+
+function packWeatherPayload(weather) {
+  var flags = 0;
+  var current = weather.current || { temp: 0, condition: 0 };
+  var forecast = weather.forecast || { highTemp: 0, lowTemp: 0, condition: 0 };
+  var slots = (weather.slots || []).slice(0, FORECAST_SLOT_COUNT);
+
+  if(weather.current) {
+    flags |= PAYLOAD_CURRENT;
+  }
+
+  if(weather.forecast) {
+    flags |= PAYLOAD_FORECAST;
+  }
+
+  // the watch computes the age of the current conditions from their fetch time
+  var fetchTime = (weather.current && weather.current.fetchTime) || Date.now();
+
+  var bytes = [WEATHER_PAYLOAD_VERSION, flags];
+  packUint32(bytes, Math.floor(fetchTime / 1000));
+  bytes.push(packInt8(current.temp), current.condition);
+  bytes.push(packInt8(forecast.highTemp), packInt8(forecast.lowTemp), forecast.condition);
+  bytes.push(slots.length);
+
+  for(var i = 0; i < slots.length; i++) {
+    packUint32(bytes, slots[i].time);
+    bytes.push(packInt8(slots[i].temp), slots[i].condition);
+  }
+
+  return bytes;
+}
 
 // the individual weather providers need access to the weather icons
 module.exports.icons = WeatherIcons;
 
+// the providers by name, for the tests
+module.exports.getProvider = function(name) {
+  return weatherProviders[name];
+};
+
 // utility functions common to all weather providers
-module.exports.xhrRequest = xhrRequest;
+module.exports.cachedRequest = cachedRequest;
+module.exports.CURRENT_MAX_AGE = CURRENT_MAX_AGE;
+module.exports.FORECAST_MAX_AGE = FORECAST_MAX_AGE;
 module.exports.sendWeatherToPebble = sendWeatherToPebble;
 
 // called by app.js
@@ -2,108 +2,114 @@
 var secrets = require('./secrets');
 var weatherCommon = require('./weather');
 
+var BASE_URL = 'http://api.openweathermap.org/data/2.5/';
+
 // "public" functions
 
-module.exports.getWeather = getWeather;
-module.exports.getWeatherFromCoords = getWeatherFromCoords;
-module.exports.getForecast = getForecast;
-module.exports.getForecastFromCoords = getForecastFromCoords;
+module.exports.fetch = fetch;
 
-function getWeather(weatherLoc) {
-  var url = 'http://api.openweathermap.org/data/2.5/weather?q=' +
-      encodeURIComponent(weatherLoc) + '&units=metric&appid=' + secrets.OWM_APP_ID;
+/*
+ Fetches the weather at the location, { latitude, longitude } or { name }, and
+ calls back with the record sent to the watch, or null if nothing came.
+ OpenWeatherMap has no free endpoint with both the current conditions and the
+ forecast, so both requests go at once and their results are merged.
+ The watch computes the forecast from the slots, so they are fetched for
+ options.forecast or options.slots
+*/
+function fetch(location, options, callback) {
+  var query = getLocationQuery(location) + '&units=metric&appid=' + secrets.OWM_APP_ID;
+  var record = {};
+  var fetchSlots = options.forecast || options.slots;
+  var pendingRequests = fetchSlots ? 2 : 1;
 
-  getAndSendCurrentWeather(url);
-}
+  function requestDone() {
+    pendingRequests--;
 
-function getWeatherFromCoords(pos) {
-  // Construct URL
-  var url = 'http://api.openweathermap.org/data/2.5/weather?lat=' +
-      pos.coords.latitude + '&lon=' + pos.coords.longitude + '&units=metric&appid=' + secrets.OWM_APP_ID;
-  console.log(url);
+    if(pendingRequests === 0) {
+      callback((record.current || record.slots) ? record : null);
+    }
+  }
 
-  getAndSendCurrentWeather(url);
-}
+  weatherCommon.cachedRequest(BASE_URL + 'weather?' + query, weatherCommon.CURRENT_MAX_AGE,
+    function(responseText, fetchTime) {
+      var json = parseResponse(responseText);
 
-function getForecast(weatherLoc) {
-  var forecastURL = 'http://api.openweathermap.org/data/2.5/forecast?q=' +
-      encodeURIComponent(weatherLoc) + '&cnt=8&units=metric&appid=' + secrets.OWM_APP_ID;
+      if(json) {
+        record.current = getCurrentWeather(json, fetchTime);
+      }
 
-  getAndSendWeatherForecast(forecastURL);
-}
+      requestDone();
+  });
 
-function getForecastFromCoords(pos) {
-  var forecastURL = 'http://api.openweathermap.org/data/2.5/forecast?lat=' +
-      pos.coords.latitude + '&lon=' + pos.coords.longitude + '&cnt=8&units=metric&appid=' + secrets.OWM_APP_ID;
+  if(fetchSlots) {
+    weatherCommon.cachedRequest(BASE_URL + 'forecast?' + query + '&cnt=8', weatherCommon.FORECAST_MAX_AGE,
+      function(responseText) {
+        var json = parseResponse(responseText);
 
-  getAndSendWeatherForecast(forecastURL);
+        if(json) {
+          record.slots = getForecastSlots(json);
+        }
+
+        requestDone();
+    });
+  }
 }
 
 // "private" functions
 
-// accepts an openweathermap url, gets weather data from it, and sends it to the watch
-function getAndSendCurrentWeather(url) {
-  weatherCommon.xhrRequest(url, 'GET',
-    function(responseText) {
-      // responseText contains a JSON object with weather info
-      var json = JSON.parse(responseText);
-
-      if(json.cod == "200") {
-        var temperature = Math.round(json.main.temp);
-        console.log('Temperature is ' + temperature);
-
-        // Conditions
-        var conditionCode = json.weather[0].id;
-        console.log('Condition code is ' + conditionCode);
-
-        // night state
-        var isNight = (json.weather[0].icon.slice(-1) == 'n') ? 1 : 0;
-
-        var iconToLoad = getIconForConditionCode(conditionCode, isNight);
+function getLocationQuery(location) {
+  if(location.name !== undefined) {
+    return 'q=' + encodeURIComponent(location.name);
+  }
 
-        // Assemble dictionary using our keys
-        var dictionary = {
-          'WeatherTemperature': temperature,
-          'WeatherCondition': iconToLoad
-        };
+  return 'lat=' + location.latitude + '&lon=' + location.longitude;
+}
 
-        console.log(JSON.stringify(dictionary));
+// returns the JSON object of a successful response, or null
+function parseResponse(responseText) {
+  try {
+    var json = JSON.parse(responseText);
 
-        weatherCommon.sendWeatherToPebble(dictionary);
-      }
-  });
+    return (json && json.cod == "200") ? json : null;
+  } catch(err) {
+    return null;
+  }
 }
 
-function getAndSendWeatherForecast(url) {
-  console.log(url);
-  weatherCommon.xhrRequest(url, 'GET',
-    function(responseText) {
-      // responseText contains a JSON object with weather info
-      var json = JSON.parse(responseText);
+function getCurrentWeather(json, fetchTime) {
+  var temperature = Math.round(json.main.temp);
+  console.log('Temperature is ' + temperature);
 
-      if(json.cod == "200") {
-        var forecast = extractFakeDailyForecast(json);
+  // Conditions
+  var conditionCode = json.weather[0].id;
+  console.log('Condition code is ' + conditionCode);
 
-        console.log('Forecast high/low temps are ' + forecast.highTemp + '/' + forecast.lowTemp);
+  // night state
+  var isNight = (json.weather[0].icon.slice(-1) == 'n') ? 1 : 0;
 
-        // Conditions
-        var conditionCode = forecast.condition;
-        console.log('Forecast condition is ' + conditionCode);
+  return {
+    temp: temperature,
+    condition: getIconForConditionCode(conditionCode, isNight),
+    fetchTime: fetchTime
+  };
+}
 
-        var iconToLoad = getIconForConditionCode(conditionCode, false);
+// the watch picks the slot of the current time, and the forecast of the next
+// 24 hours, by itself
+function getForecastSlots(json) {
+  var slots = [];
 
-        // Assemble dictionary using our keys
-        var dictionary = {
-          'WeatherForecastCondition': iconToLoad,
-          'WeatherForecastHighTemp': forecast.highTemp,
-          'WeatherForecastLowTemp': forecast.lowTemp
-        };
+  for(var i = 0; i < json.list.length; i++) {
+    var isNight = (json.list[i].sys.pod == 'n');
 
-        console.log(JSON.stringify(dictionary));
+    slots.push({
+      time: json.list[i].dt,
+      temp: json.list[i].main.temp,
+      condition: getIconForConditionCode(json.list[i].weather[0].id, isNight)
+    });
+  }
 
-        weatherCommon.sendWeatherToPebble(dictionary);
-    }
-  });
+  return slots;
 }
 
 function getIconForConditionCode(conditionCode, isNight) {
@@ -157,29 +163,3 @@ function getIconForConditionCode(conditionCode, isNight) {
   return iconToLoad;
 }
 
-/*
- Attempts to approximate a daily forecast by interpolating the next
- 24 hours worth of 3 hour forecasts :-O
-*/
-function extractFakeDailyForecast(json) {
-  var todaysForecast = {};
-
-  // find the max and min of those temperatures
-  todaysForecast.highTemp = -Number.MAX_SAFE_INTEGER;
-  todaysForecast.lowTemp  = Number.MAX_SAFE_INTEGER;
-
-  for(var i = 0; i < json.list.length; i++) {
-    if(todaysForecast.highTemp < json.list[i].main.temp_max) {
-      todaysForecast.highTemp = json.list[i].main.temp_max;
-    }
-
-    if(todaysForecast.lowTemp > json.list[i].main.temp_min) {
-      todaysForecast.lowTemp = json.list[i].main.temp_min;
-    }
-  }
-
-  // we can't really "average" conditions, so we'll just cheat and use...one of them :-O
-  todaysForecast.condition = json.list[3].weather[0].id;
-
-  return todaysForecast;
-}
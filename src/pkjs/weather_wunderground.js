@@ -1,122 +1,101 @@
 var weatherCommon = require('./weather');
 
+var BASE_URL = 'http://api.wunderground.com/api/';
+
 // "public" functions
 
-module.exports.getWeather = getWeather;
-module.exports.getWeatherFromCoords = getWeatherFromCoords;
-module.exports.getForecast = getForecast;
-module.exports.getForecastFromCoords = getForecastFromCoords;
+module.exports.fetch = fetch;
 
-function getWeather(weatherLoc) {
+/*
+ Fetches the weather at the location, { latitude, longitude } or { name }, and
+ calls back with the record sent to the watch, or null if nothing came.
+ Weather Underground combines the features asked for in one request. It has
+ no slots, options.slots is ignored
+*/
+function fetch(location, options, callback) {
   var apiKey = window.localStorage.getItem('weather_api_key');
+  var features = options.forecast ? 'conditions/forecast' : 'conditions';
 
-  var url = 'http://api.wunderground.com/api/' + apiKey +
-            '/conditions/q/' + encodeURIComponent(weatherLoc) + '.json';
+  var url = BASE_URL + apiKey + '/' + features + '/q/' + getLocationQuery(location) + '.json';
 
-  getAndSendCurrentWeather(url);
-}
+  // the response holds the current conditions, so it's only cached as long as they are
+  weatherCommon.cachedRequest(url, weatherCommon.CURRENT_MAX_AGE,
+    function(responseText, fetchTime) {
+      var json = parseResponse(responseText);
+      var record = {};
 
-function getWeatherFromCoords(pos) {
-  var apiKey = window.localStorage.getItem('weather_api_key');
+      if(json && json.response.features.conditions == 1 && json.current_observation) {
+        record.current = getCurrentWeather(json, fetchTime);
+      }
 
-  // Construct URL
-  var url = 'http://api.wunderground.com/api/' + apiKey +
-            '/conditions/q/' + pos.coords.latitude + ',' + pos.coords.longitude + '.json';
+      if(json && json.response.features.forecast == 1 && json.forecast) {
+        record.forecast = getForecast(json);
+      }
 
-  getAndSendCurrentWeather(url);
+      callback((record.current || record.forecast) ? record : null);
+  });
 }
 
-function getForecast(weatherLoc) {
-  var apiKey = window.localStorage.getItem('weather_api_key');
+// "private" functions
 
-  var forecastURL = 'http://api.wunderground.com/api/' + apiKey +
-            '/forecast/q/' + encodeURIComponent(weatherLoc) + '.json';
+function getLocationQuery(location) {
+  if(location.name !== undefined) {
+    return encodeURIComponent(location.name);
+  }
 
-  getAndSendWeatherForecast(forecastURL);
+  return location.latitude + ',' + location.longitude;
 }
 
-function getForecastFromCoords(pos) {
-  var apiKey = window.localStorage.getItem('weather_api_key');
-
-  var forecastURL = 'http://api.wunderground.com/api/' + apiKey +
-            '/forecast/q/' + pos.coords.latitude + ',' + pos.coords.longitude + '.json';
+// returns the JSON object of a response, or null
+function parseResponse(responseText) {
+  try {
+    var json = JSON.parse(responseText);
 
-  getAndSendWeatherForecast(forecastURL);
+    return (json && json.response && json.response.features) ? json : null;
+  } catch(err) {
+    return null;
+  }
 }
 
-// "private" functions
-
-// accepts a wunderground conditions url, gets weather data from it, and sends it to the watch
-function getAndSendCurrentWeather(url) {
-  weatherCommon.xhrRequest(url, 'GET',
-    function(responseText) {
-      // responseText contains a JSON object with weather info
-      var json = JSON.parse(responseText);
-
-      if(json.response.features.conditions == 1) {
-        var temperature = Math.round(json.current_observation.temp_c);
-        console.log('Temperature is ' + temperature);
-
-        // Conditions
-        var conditionCode = json.current_observation.icon;
-        console.log('Condition icon is ' + conditionCode);
-
-        // night state
-        var isNight = false;
+function getCurrentWeather(json, fetchTime) {
+  var temperature = Math.round(json.current_observation.temp_c);
+  console.log('Temperature is ' + temperature);
 
-        if(json.current_observation.icon_url.indexOf('nt_') != -1) {
-          isNight = true;
-        }
+  // Conditions
+  var conditionCode = json.current_observation.icon;
+  console.log('Condition icon is ' + conditionCode);
 
-        var iconToLoad = getIconForConditionCode(conditionCode, isNight);
-        console.log('were loading this icon:' + iconToLoad);
+  // night state
+  var isNight = false;
 
-        // Assemble dictionary using our keys
-        var dictionary = {
-          'WeatherTemperature': temperature,
-          'WeatherCondition': iconToLoad
-        };
-
-        console.log(JSON.stringify(dictionary));
+  if(json.current_observation.icon_url.indexOf('nt_') != -1) {
+    isNight = true;
+  }
 
-        weatherCommon.sendWeatherToPebble(dictionary);
-      }
-  });
+  return {
+    temp: temperature,
+    condition: getIconForConditionCode(conditionCode, isNight),
+    fetchTime: fetchTime
+  };
 }
 
-function getAndSendWeatherForecast(url) {
-  console.log(url);
-  weatherCommon.xhrRequest(url, 'GET',
-    function(responseText) {
-      // responseText contains a JSON object with weather info
-      var json = JSON.parse(responseText);
-
-      if(json.response.features.forecast == 1) {
-        var todaysForecast = json.forecast.simpleforecast.forecastday[0];
-
-        var highTemp = parseInt(todaysForecast.high.celsius, 10);
-        var lowTemp = parseInt(todaysForecast.low.celsius, 10);
+function getForecast(json) {
+  var todaysForecast = json.forecast.simpleforecast.forecastday[0];
 
-        console.log('Forecast high/low temps are ' + highTemp + '/' + lowTemp);
+  var highTemp = parseInt(todaysForecast.high.celsius, 10);
+  var lowTemp = parseInt(todaysForecast.low.celsius, 10);
 
-        // Conditions
-        var conditionCode = todaysForecast.icon;
-        console.log('Forecast icon is ' + conditionCode);
+  console.log('Forecast high/low temps are ' + highTemp + '/' + lowTemp);
 
-        var iconToLoad = getIconForConditionCode(conditionCode, false);
+  // Conditions
+  var conditionCode = todaysForecast.icon;
+  console.log('Forecast icon is ' + conditionCode);
 
-        // Assemble dictionary using our keys
-        var dictionary = {
-          'WeatherForecastCondition': iconToLoad,
-          'WeatherForecastHighTemp': highTemp,
-          'WeatherForecastLowTemp': lowTemp
-        };
-
-        console.log(JSON.stringify(dictionary));
-
-        weatherCommon.sendWeatherToPebble(dictionary);
-    }
-  });
+  return {
+    highTemp: highTemp,
+    lowTemp: lowTemp,
+    condition: getIconForConditionCode(conditionCode, false)
+  };
 }
 
 function getIconForConditionCode(conditionCode, isNight) {
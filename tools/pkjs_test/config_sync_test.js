@@ -0,0 +1,213 @@
+/* the delta config sync of config_sync.js */
+var assert = require('assert');
+var harness = require('./harness');
+
+var CONFIG = {
+  SettingColorBG: 0x000000,
+  SettingColorSidebar: 0x00AAFF,
+  SettingColorTime: 0xFFFFFF,
+  SettingWidget0ID: 7,
+  SettingAltClockName: 'UTC'
+};
+
+function copy(values) {
+  return JSON.parse(JSON.stringify(values));
+}
+
+// the settings of a message, without the hashes
+function settingsOf(message) {
+  var settings = copy(message);
+
+  delete settings.SettingConfigHash;
+  delete settings.SettingConfigBase;
+
+  return settings;
+}
+
+module.exports['the first config is sent whole'] = function(done) {
+  var configSync = harness.loadPkjs('config_sync');
+
+  configSync.sendConfig(copy(CONFIG), false, function(success) {
+    assert.ok(success);
+    assert.equal(Pebble.sentMessages.length, 1);
+    assert.deepEqual(settingsOf(Pebble.sentMessages[0]), CONFIG);
+    assert.equal(Pebble.sentMessages[0].SettingConfigBase, undefined);
+    assert.ok(Pebble.sentMessages[0].SettingConfigHash > 0);
+    done();
+  });
+};
+
+module.exports['only the changed settings are sent after'] = function(done) {
+  var configSync = harness.loadPkjs('config_sync');
+
+  configSync.sendConfig(copy(CONFIG), false, function() {
+    var config = copy(CONFIG);
+    config.SettingColorSidebar = 0xFF0055;
+
+    configSync.sendConfig(config, false, function(success) {
+      var first = Pebble.sentMessages[0];
+      var delta = Pebble.sentMessages[1];
+
+      assert.ok(success);
+      assert.deepEqual(settingsOf(delta), { SettingColorSidebar: 0xFF0055 });
+      assert.equal(delta.SettingConfigBase, first.SettingConfigHash);
+      assert.notEqual(delta.SettingConfigHash, first.SettingConfigHash);
+      done();
+    });
+  });
+};
+
+module.exports['unchanged configs send nothing'] = function(done) {
+  var configSync = harness.loadPkjs('config_sync');
+
+  configSync.sendConfig(copy(CONFIG), false, function() {
+    configSync.sendConfig(copy(CONFIG), false, function(success) {
+      assert.ok(success);
+      assert.equal(Pebble.sentMessages.length, 1);
+      done();
+    });
+  });
+};
+
+module.exports['large configs are split in chained messages'] = function(done) {
+  var configSync = harness.loadPkjs('config_sync');
+  var config = copy(CONFIG);
+
+  // the day and month names of a language
+  for(var i = 0; i < 19; i++) {
+    config[String(10016 + i)] = 'Nameday' + i;
+  }
+
+  configSync.sendConfig(config, false, function(success) {
+    var messages = Pebble.sentMessages;
+    var received = {};
+
+    assert.ok(success);
+    assert.ok(messages.length > 1);
+
+    for(var i = 0; i < messages.length; i++) {
+      assert.equal(messages[i].SettingConfigBase, (i > 0) ? messages[i - 1].SettingConfigHash : undefined);
+
+      var settings = settingsOf(messages[i]);
+      for(var name in settings) {
+        received[name] = settings[name];
+      }
+    }
+
+    assert.deepEqual(received, config);
+    done();
+  });
+};
+
+module.exports['settings which failed to send go with the next config'] = function(done) {
+  var configSync = harness.loadPkjs('config_sync');
+
+  configSync.sendConfig(copy(CONFIG), false, function() {
+    var sendAppMessage = Pebble.sendAppMessage;
+    var config = copy(CONFIG);
+
+    Pebble.sendAppMessage = function(dictionary, success, failure) {
+      setTimeout(failure, 0);
+    };
+    config.SettingColorBG = 0x555555;
+
+    configSync.sendConfig(config, false, function(success) {
+      assert.ok(!success);
+      Pebble.sendAppMessage = sendAppMessage;
+      config.SettingColorTime = 0xAAAAAA;
+
+      configSync.sendConfig(config, false, function() {
+        var last = Pebble.sentMessages[Pebble.sentMessages.length - 1];
+
+        assert.deepEqual(settingsOf(last), { SettingColorBG: 0x555555, SettingColorTime: 0xAAAAAA });
+        assert.equal(last.SettingConfigBase, Pebble.sentMessages[0].SettingConfigHash);
+        done();
+      });
+    });
+  });
+};
+
+module.exports['the watch can ask for the whole config'] = function(done) {
+  var configSync = harness.loadPkjs('config_sync');
+
+  assert.ok(!configSync.handleMessage({ WeatherRequest: 0 }, function() {}));
+
+  configSync.sendConfig(copy(CONFIG), false, function() {
+    var config = copy(CONFIG);
+    config.SettingWidget0ID = 8;
+
+    configSync.sendConfig(config, false, function() {
+      var handled = configSync.handleMessage({ ConfigResync: 1 }, function(success) {
+        var resync = Pebble.sentMessages[2];
+
+        assert.ok(success);
+        assert.deepEqual(settingsOf(resync), config);
+        assert.equal(resync.SettingConfigBase, undefined);
+        assert.equal(resync.SettingConfigHash, Pebble.sentMessages[1].SettingConfigHash);
+        done();
+      });
+
+      assert.ok(handled);
+    });
+  });
+};
+
+// a watch applying the messages like messaging.c, which acknowledges the
+// deltas it rejects, and whose resync requests can be lost
+function simulateWatch() {
+  var watch = { hash: 0, settings: {}, resyncRequests: 0 };
+
+  Pebble.sendAppMessage = function(dictionary, success, failure) {
+    Pebble.sentMessages.push(dictionary);
+
+    if(dictionary.SettingConfigBase !== undefined && dictionary.SettingConfigBase !== watch.hash) {
+      watch.resyncRequests++;
+    } else {
+      var settings = settingsOf(dictionary);
+
+      for(var name in settings) {
+        watch.settings[name] = settings[name];
+      }
+
+      watch.hash = dictionary.SettingConfigHash;
+    }
+
+    setTimeout(function() { success({}); }, 0);
+  };
+
+  return watch;
+}
+
+module.exports['changes rejected while a resync was lost are sent with the resync'] = function(done) {
+  var configSync = harness.loadPkjs('config_sync');
+  var watch = simulateWatch();
+
+  configSync.sendConfig(copy(CONFIG), false, function() {
+    // the watch lost its settings, and then its first resync request
+    watch.hash = 0;
+    watch.settings = {};
+
+    var config = copy(CONFIG);
+    config.SettingColorBG = 0x555555;
+
+    configSync.sendConfig(config, false, function(success) {
+      assert.ok(success, 'the rejected delta is acknowledged');
+      assert.equal(watch.resyncRequests, 1);
+
+      config.SettingColorTime = 0xAAAAAA;
+
+      configSync.sendConfig(config, false, function() {
+        // still based on the config the watch doesn't have
+        assert.equal(watch.resyncRequests, 2);
+        assert.deepEqual(watch.settings, {});
+
+        // the watch asks again until its request goes through
+        configSync.handleMessage({ ConfigResync: 1 }, function(success) {
+          assert.ok(success);
+          assert.deepEqual(watch.settings, config);
+          done();
+        });
+      });
+    });
+  });
+};
@@ -0,0 +1,319 @@
+/*
+ The PebbleKit JS environment for the tests, on node: an in-memory
+ localStorage, a Pebble object recording the sent messages, a clock the tests
+ can move forward, and an XMLHttpRequest which sends every request to a local
+ mock server, whatever its host.
+*/
+var http = require('http');
+var path = require('path');
+var url = require('url');
+var Module = require('module');
+
+var PKJS_DIR = path.join(__dirname, '..', '..', 'src', 'pkjs');
+
+var server = null;
+var routes = {};
+var requests = [];
+var inFlight = 0;
+var pendingXhrs = [];
+var timeOffset = 0;
+var realNow = Date.now;
+
+// the tests don't have the real API keys
+var resolveFilename = Module._resolveFilename;
+Module._resolveFilename = function(request, parent) {
+  if(request === './secrets' && parent && path.dirname(parent.filename) === PKJS_DIR) {
+    return path.join(PKJS_DIR, 'secrets_example.js');
+  }
+
+  return resolveFilename.apply(this, arguments);
+};
+
+function createStorage() {
+  var items = {};
+
+  return {
+    getItem: function(key) {
+      return items.hasOwnProperty(key) ? items[key] : null;
+    },
+    setItem: function(key, value) {
+      items[key] = String(value);
+    },
+    removeItem: function(key) {
+      delete items[key];
+    },
+    clear: function() {
+      items = {};
+    }
+  };
+}
+
+function MockXMLHttpRequest() {
+  this.status = 0;
+  this.responseText = '';
+}
+
+MockXMLHttpRequest.prototype.open = function(method, requestUrl) {
+  this.method = method;
+  this.url = requestUrl;
+};
+
+// ends the request, without calling its handlers
+MockXMLHttpRequest.prototype.end = function() {
+  if(this.req) {
+    this.req.removeAllListeners('error');
+    this.req.on('error', function() {});
+    this.req.destroy();
+    this.req = null;
+
+    inFlight--;
+    pendingXhrs.splice(pendingXhrs.indexOf(this), 1);
+  }
+};
+
+MockXMLHttpRequest.prototype.abort = function() {
+  if(this.req) {
+    this.end();
+
+    if(this.onabort) {
+      this.onabort();
+    }
+  }
+};
+
+MockXMLHttpRequest.prototype.send = function() {
+  var xhr = this;
+  var parsed = url.parse(xhr.url);
+
+  inFlight++;
+  pendingXhrs.push(xhr);
+
+  var req = xhr.req = http.request({
+    host: '127.0.0.1',
+    port: server.address().port,
+    method: xhr.method,
+    path: parsed.path,
+    headers: { 'X-Original-Host': parsed.host }
+  }, function(res) {
+    var body = '';
+
+    res.setEncoding('utf8');
+    res.on('data', function(chunk) { body += chunk; });
+    res.on('end', function() {
+      inFlight--;
+      pendingXhrs.splice(pendingXhrs.indexOf(xhr), 1);
+      xhr.req = null;
+      xhr.status = res.statusCode;
+      xhr.responseText = body;
+
+      if(xhr.onload) {
+        xhr.onload();
+      }
+    });
+  });
+
+  req.on('error', function() {
+    inFlight--;
+    pendingXhrs.splice(pendingXhrs.indexOf(xhr), 1);
+    xhr.req = null;
+
+    if(xhr.onerror) {
+      xhr.onerror();
+    }
+  });
+
+  req.end();
+};
+
+// the route of the longest host + pathname prefix of the request
+function findRoute(hostAndPath) {
+  var found = null;
+
+  for(var prefix in routes) {
+    if(hostAndPath.indexOf(prefix) === 0 && (!found || prefix.length > found.length)) {
+      found = prefix;
+    }
+  }
+
+  return found ? routes[found] : null;
+}
+
+function handleRequest(req, res) {
+  var parsed = url.parse(req.url, true);
+  var route = findRoute(req.headers['x-original-host'] + parsed.pathname);
+
+  requests.push({ host: req.headers['x-original-host'], pathname: parsed.pathname, query: parsed.query });
+
+  if(!route) {
+    res.writeHead(404);
+    res.end('{}');
+    return;
+  }
+
+  var response = route(parsed.query, parsed.pathname);
+
+  // a server which never answers
+  if(!response) {
+    return;
+  }
+
+  res.writeHead(response.status || 200, { 'Content-Type': 'application/json' });
+  res.end(typeof response.body === 'string' ? response.body : JSON.stringify(response.body));
+}
+
+/*
+ Installs a fresh environment and starts the mock server, then calls back.
+ The pkjs modules are loaded again, so that their state doesn't leak between tests
+*/
+function setUp(callback) {
+  routes = {};
+  requests = [];
+  pendingXhrs.slice().forEach(function(xhr) { xhr.end(); });
+  timeOffset = 0;
+
+  Date.now = function() {
+    return realNow() + timeOffset;
+  };
+
+  global.window = { localStorage: createStorage() };
+  global.localStorage = global.window.localStorage;
+  global.XMLHttpRequest = MockXMLHttpRequest;
+  global.navigator = {
+    geolocation: {
+      getCurrentPosition: function(success, error) {
+        error({ code: 2, message: 'no position in the tests' });
+      }
+    }
+  };
+  global.Pebble = {
+    sentMessages: [],
+    sendAppMessage: function(dictionary, success, failure) {
+      global.Pebble.sentMessages.push(dictionary);
+      setTimeout(function() { success({}); }, 0);
+    }
+  };
+
+  for(var cached in require.cache) {
+    if(cached.indexOf(PKJS_DIR) === 0) {
+      delete require.cache[cached];
+    }
+  }
+
+  if(server) {
+    callback();
+    return;
+  }
+
+  server = http.createServer(handleRequest);
+  server.listen(0, '127.0.0.1', callback);
+}
+
+function tearDown() {
+  if(server) {
+    server.close();
+    server = null;
+  }
+
+  Date.now = realNow;
+}
+
+// answers the requests starting with host + pathname with handler(query, pathname),
+// which returns { status, body }, or null to never answer
+function route(hostAndPath, handler) {
+  routes[hostAndPath] = handler;
+}
+
+// the requests received by the mock server whose pathname contains the text
+function countRequests(text) {
+  return requests.filter(function(request) {
+    return request.pathname.indexOf(text) !== -1;
+  }).length;
+}
+
+// calls back once no request is in flight and the timers due now have run
+function settle(callback) {
+  var idleRounds = 0;
+
+  (function poll() {
+    idleRounds = (inFlight === 0) ? idleRounds + 1 : 0;
+
+    if(idleRounds >= 3) {
+      callback();
+    } else {
+      setTimeout(poll, 5);
+    }
+  })();
+}
+
+// the requests with a timeout which are still waiting time out now
+function expireRequests() {
+  pendingXhrs.slice().forEach(function(xhr) {
+    if(xhr.timeout > 0) {
+      xhr.end();
+
+      if(xhr.ontimeout) {
+        xhr.ontimeout();
+      }
+    }
+  });
+}
+
+// the requests the mock server received and hasn't answered
+function countPendingRequests() {
+  return pendingXhrs.length;
+}
+
+function advanceTime(milliseconds) {
+  timeOffset += milliseconds;
+}
+
+function loadPkjs(name) {
+  return require(path.join(PKJS_DIR, name));
+}
+
+function loadFixture(name) {
+  return require(path.join(__dirname, 'fixtures', name));
+}
+
+// the fields of a WeatherData payload, as decoded by messaging.c
+function decodeWeatherPayload(bytes) {
+  function int8(value) {
+    return (value > 127) ? value - 256 : value;
+  }
+
+  var payload = {
+    version: bytes[0],
+    flags: bytes[1],
+    time: (bytes[2] | (bytes[3] << 8) | (bytes[4] << 16) | (bytes[5] << 24)) >>> 0,
+    currentTemp: int8(bytes[6]),
+    currentCondition: bytes[7],
+    highTemp: int8(bytes[8]),
+    lowTemp: int8(bytes[9]),
+    forecastCondition: bytes[10],
+    slots: []
+  };
+
+  for(var i = 0; i < bytes[11]; i++) {
+    var offset = 12 + i * 6;
+
+    payload.slots.push({
+      time: (bytes[offset] | (bytes[offset + 1] << 8) | (bytes[offset + 2] << 16) | (bytes[offset + 3] << 24)) >>> 0,
+      temp: int8(bytes[offset + 4]),
+      condition: bytes[offset + 5]
+    });
+  }
+
+  return payload;
+}
+
+module.exports.setUp = setUp;
+module.exports.tearDown = tearDown;
+module.exports.route = route;
+module.exports.countRequests = countRequests;
+module.exports.settle = settle;
+module.exports.advanceTime = advanceTime;
+module.exports.expireRequests = expireRequests;
+module.exports.countPendingRequests = countPendingRequests;
+module.exports.loadPkjs = loadPkjs;
+module.exports.loadFixture = loadFixture;
+module.exports.decodeWeatherPayload = decodeWeatherPayload;
@@ -0,0 +1,142 @@
+/* the GPS fix cache of weather.js, used when no weather location is set */
+var assert = require('assert');
+var harness = require('./harness');
+
+var MINUTE = 60 * 1000;
+
+// the position the phone reports, or null for an error
+var position;
+var positionRequests;
+
+// OpenWeatherMap answers from the fixtures, at the position of the phone
+function setUpGps(latitude, longitude) {
+  position = { latitude: latitude, longitude: longitude };
+  positionRequests = 0;
+
+  navigator.geolocation.getCurrentPosition = function(success, error) {
+    positionRequests++;
+
+    setTimeout(function() {
+      if(position) {
+        success({ coords: { latitude: position.latitude, longitude: position.longitude, accuracy: 50 } });
+      } else {
+        error({ code: 2, message: 'no position' });
+      }
+    }, 0);
+  };
+
+  harness.route('api.openweathermap.org/data/2.5/weather', function() {
+    return { body: harness.loadFixture('owm_weather.json') };
+  });
+
+  window.localStorage.setItem('disable_weather', 'no');
+
+  return harness.loadPkjs('weather');
+}
+
+module.exports['recent fixes are used again'] = function(done) {
+  var weather = setUpGps(48.8566, 2.3522);
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    harness.advanceTime(20 * MINUTE);
+    weather.updateWeather();
+
+    harness.settle(function() {
+      assert.equal(positionRequests, 1);
+      assert.equal(Pebble.sentMessages.length, 2);
+      done();
+    });
+  });
+};
+
+module.exports['the age of the fixes follows the setting'] = function(done) {
+  var weather = setUpGps(48.8566, 2.3522);
+  window.localStorage.setItem('location_max_age', '5');
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    harness.advanceTime(6 * MINUTE);
+    weather.updateWeather();
+
+    harness.settle(function() {
+      assert.equal(positionRequests, 2);
+      done();
+    });
+  });
+};
+
+module.exports['small moves keep the same requests'] = function(done) {
+  var weather = setUpGps(48.8566, 2.3522);
+  window.localStorage.setItem('location_max_age', '5');
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    // about a kilometer away, across a rounding boundary, the weather is still cached
+    position = { latitude: 48.8651, longitude: 2.3452 };
+    harness.advanceTime(6 * MINUTE);
+    weather.updateWeather();
+
+    harness.settle(function() {
+      assert.equal(positionRequests, 2);
+      assert.equal(harness.countRequests('/weather'), 1);
+      assert.equal(JSON.parse(window.localStorage.getItem('location_cache')).latitude, 48.8566);
+      done();
+    });
+  });
+};
+
+module.exports['large moves update the location'] = function(done) {
+  var weather = setUpGps(48.8566, 2.3522);
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    // Versailles
+    position = { latitude: 48.8049, longitude: 2.1204 };
+    harness.advanceTime(31 * MINUTE);
+    weather.updateWeather();
+
+    harness.settle(function() {
+      var cached = JSON.parse(window.localStorage.getItem('location_cache'));
+      assert.equal(cached.latitude, 48.8049);
+      assert.equal(cached.accuracy, 50);
+      assert.equal(harness.countRequests('/weather'), 2);
+      done();
+    });
+  });
+};
+
+module.exports['errors fall back on the last fix'] = function(done) {
+  var weather = setUpGps(48.8566, 2.3522);
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    position = null;
+    harness.advanceTime(2 * 60 * MINUTE);
+    weather.updateWeather();
+
+    harness.settle(function() {
+      assert.equal(positionRequests, 2);
+      assert.equal(Pebble.sentMessages.length, 2);
+      done();
+    });
+  });
+};
+
+module.exports['errors without a fix give up'] = function(done) {
+  var weather = setUpGps(48.8566, 2.3522);
+  position = null;
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    assert.equal(positionRequests, 1);
+    assert.equal(Pebble.sentMessages.length, 0);
+    done();
+  });
+};
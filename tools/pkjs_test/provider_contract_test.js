@@ -0,0 +1,179 @@
+/*
+ The contract of the weather providers: fetch(location, options, callback)
+ calls back once with a record of the weather, as sendWeatherToPebble takes
+ it, or null. The providers answer from the recorded responses in fixtures.
+*/
+var assert = require('assert');
+var harness = require('./harness');
+
+var PAYLOAD_CURRENT  = 1 << 0;
+var PAYLOAD_FORECAST = 1 << 1;
+
+var LOCATION = { latitude: '48.86', longitude: '2.35' };
+
+var PROVIDERS = {
+  owm: {
+    // the current conditions and the forecast have their own endpoints
+    maxRequests: 2,
+    hasSlots: true,
+    expectedCurrent: { temp: 18, condition: 8 },
+    setUp: function(failing) {
+      harness.route('api.openweathermap.org/data/2.5/weather', function() {
+        return failing ? { status: 401, body: harness.loadFixture('owm_error.json') }
+                       : { body: harness.loadFixture('owm_weather.json') };
+      });
+      harness.route('api.openweathermap.org/data/2.5/forecast', function() {
+        return failing ? { status: 401, body: harness.loadFixture('owm_error.json') }
+                       : { body: harness.loadFixture('owm_forecast.json') };
+      });
+    },
+    checkForecast: function(record) {
+      assert.equal(record.slots.length, 8);
+      assert.deepEqual(record.slots[0], { time: 1715763600, temp: 14.2, condition: 0 });
+      assert.equal(record.slots[1].condition, 7, 'night slots have night icons');
+    }
+  },
+
+  wunderground: {
+    maxRequests: 1,
+    hasSlots: false,
+    expectedCurrent: { temp: 8, condition: 3 },
+    setUp: function(failing) {
+      harness.route('api.wunderground.com/api/', function(query, pathname) {
+        if(failing) {
+          return { body: harness.loadFixture('wunderground_error.json') };
+        }
+
+        // the response only has the features of the request
+        var json = JSON.parse(JSON.stringify(harness.loadFixture('wunderground_conditions_forecast.json')));
+
+        if(pathname.indexOf('/forecast/') === -1) {
+          delete json.forecast;
+          delete json.response.features.forecast;
+        }
+
+        return { body: json };
+      });
+      window.localStorage.setItem('weather_api_key', 'test');
+    },
+    checkForecast: function(record) {
+      assert.deepEqual(record.forecast, { highTemp: 12, lowTemp: 5, condition: 8 });
+    }
+  }
+};
+
+// the fields the watch decodes, whatever the provider
+function checkRecord(record) {
+  assert.ok(record, 'a record');
+
+  if(record.current) {
+    assert.equal(typeof record.current.fetchTime, 'number');
+    assert.ok(Number.isInteger(record.current.temp));
+    assert.ok(record.current.condition >= 0 && record.current.condition <= 11);
+  }
+
+  if(record.forecast) {
+    assert.ok(record.forecast.highTemp >= record.forecast.lowTemp);
+    assert.ok(record.forecast.condition >= 0 && record.forecast.condition <= 11);
+  }
+
+  if(record.slots) {
+    for(var i = 0; i < record.slots.length; i++) {
+      assert.ok(i === 0 || record.slots[i].time > record.slots[i - 1].time, 'the slots are sorted');
+      assert.ok(record.slots[i].condition >= 0 && record.slots[i].condition <= 11);
+    }
+  }
+}
+
+function fetchWith(name, location, options, failing, callback) {
+  PROVIDERS[name].setUp(failing);
+
+  harness.loadPkjs('weather').getProvider(name).fetch(location, options, callback);
+}
+
+Object.keys(PROVIDERS).forEach(function(name) {
+  var provider = PROVIDERS[name];
+
+  module.exports[name + ': fetches the current conditions and the forecast in one record'] = function(done) {
+    fetchWith(name, LOCATION, { forecast: true }, false, function(record) {
+      checkRecord(record);
+      assert.equal(record.current.temp, provider.expectedCurrent.temp);
+      assert.equal(record.current.condition, provider.expectedCurrent.condition);
+      provider.checkForecast(record);
+      assert.ok(harness.countRequests('') <= provider.maxRequests);
+      done();
+    });
+  };
+
+  module.exports[name + ': fetches by location name'] = function(done) {
+    fetchWith(name, { name: 'Paris, France' }, { forecast: true }, false, function(record) {
+      checkRecord(record);
+      assert.equal(record.current.temp, provider.expectedCurrent.temp);
+      done();
+    });
+  };
+
+  module.exports[name + ': fetches only the current conditions without the forecast'] = function(done) {
+    fetchWith(name, LOCATION, { forecast: false, slots: false }, false, function(record) {
+      checkRecord(record);
+      assert.ok(record.current);
+      assert.equal(record.forecast, undefined);
+      assert.equal(record.slots, undefined);
+      assert.equal(harness.countRequests(''), 1);
+      done();
+    });
+  };
+
+  module.exports[name + ': calls back with null on errors'] = function(done) {
+    fetchWith(name, LOCATION, { forecast: true }, true, function(record) {
+      assert.strictEqual(record, null);
+      done();
+    });
+  };
+
+  module.exports[name + ': an update sends one message'] = function(done) {
+    provider.setUp(false);
+    window.localStorage.setItem('weather_datasource', name);
+    window.localStorage.setItem('disable_weather', 'no');
+    window.localStorage.setItem('enable_forecast', 'yes');
+    window.localStorage.setItem('weather_loc', 'Paris');
+    window.localStorage.setItem('weather_loc_lat', LOCATION.latitude);
+    window.localStorage.setItem('weather_loc_lng', LOCATION.longitude);
+
+    harness.loadPkjs('weather').updateWeather();
+
+    harness.settle(function() {
+      assert.equal(Pebble.sentMessages.length, 1);
+
+      var payload = harness.decodeWeatherPayload(Pebble.sentMessages[0].WeatherData);
+      assert.equal(payload.version, 1);
+      assert.equal(payload.flags & PAYLOAD_CURRENT, PAYLOAD_CURRENT);
+      assert.equal(payload.currentTemp, provider.expectedCurrent.temp);
+      assert.ok((payload.flags & PAYLOAD_FORECAST) || payload.slots.length > 0);
+      done();
+    });
+  };
+
+  module.exports[name + ': an update for the current conditions widget alone'] = function(done) {
+    provider.setUp(false);
+    window.localStorage.setItem('weather_datasource', name);
+    window.localStorage.setItem('disable_weather', 'no');
+    window.localStorage.setItem('weather_loc', 'Paris');
+    window.localStorage.setItem('weather_loc_lat', LOCATION.latitude);
+    window.localStorage.setItem('weather_loc_lng', LOCATION.longitude);
+
+    harness.loadPkjs('weather').updateWeather();
+
+    harness.settle(function() {
+      assert.equal(Pebble.sentMessages.length, 1);
+
+      var payload = harness.decodeWeatherPayload(Pebble.sentMessages[0].WeatherData);
+      assert.equal(payload.flags & PAYLOAD_CURRENT, PAYLOAD_CURRENT);
+      assert.equal(payload.flags & PAYLOAD_FORECAST, 0);
+
+      // the slots keep the current conditions right for a day offline
+      assert.equal(payload.slots.length, provider.hasSlots ? 8 : 0);
+      done();
+    });
+  };
+});
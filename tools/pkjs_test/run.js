@@ -0,0 +1,83 @@
+/*
+ Runs the tests of the PebbleKit JS code on node, against a local mock server:
+
+   node tools/pkjs_test/run.js [test file name filter]
+
+ Each *_test.js file exports its tests, as functions taking a done callback.
+ The logs of a test are only shown if it fails.
+*/
+var fs = require('fs');
+var path = require('path');
+var harness = require('./harness');
+
+var TEST_TIMEOUT = 5000;
+
+var filter = process.argv[2] || '';
+var tests = [];
+
+fs.readdirSync(__dirname).sort().forEach(function(file) {
+  if(/_test\.js$/.test(file) && file.indexOf(filter) !== -1) {
+    var fileTests = require(path.join(__dirname, file));
+
+    Object.keys(fileTests).forEach(function(name) {
+      tests.push({ name: file.replace(/\.js$/, '') + ': ' + name, run: fileTests[name] });
+    });
+  }
+});
+
+var failures = 0;
+var log = console.log;
+var testLogs = [];
+
+function report(test, err) {
+  if(err) {
+    failures++;
+    log('FAIL ' + test.name);
+    log('     ' + testLogs.concat((err.stack || err).toString().split('\n')).join('\n     '));
+  } else {
+    log('ok   ' + test.name);
+  }
+}
+
+function runNext(index) {
+  if(index >= tests.length) {
+    harness.tearDown();
+    log(tests.length - failures + '/' + tests.length + ' tests passed');
+    process.exit(failures ? 1 : 0);
+  }
+
+  var test = tests[index];
+  var finished = false;
+
+  testLogs = [];
+  console.log = function() {
+    testLogs.push(Array.prototype.join.call(arguments, ' '));
+  };
+
+  function done(err) {
+    if(finished) {
+      return;
+    }
+
+    finished = true;
+    clearTimeout(timeout);
+    report(test, err);
+    setImmediate(function() { runNext(index + 1); });
+  }
+
+  var timeout = setTimeout(function() { done(new Error('timed out')); }, TEST_TIMEOUT);
+
+  harness.setUp(function() {
+    // the failed assertions in callbacks end the test too
+    process.removeAllListeners('uncaughtException');
+    process.on('uncaughtException', done);
+
+    try {
+      test.run(done);
+    } catch(err) {
+      done(err);
+    }
+  });
+}
+
+runNext(0);
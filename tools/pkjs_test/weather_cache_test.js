@@ -0,0 +1,198 @@
+/* the request coalescing and the response cache of weather.js */
+var assert = require('assert');
+var harness = require('./harness');
+
+var OWM_HOST = 'api.openweathermap.org';
+var MINUTE = 60 * 1000;
+
+var PAYLOAD_CURRENT = 1 << 0;
+
+// OpenWeatherMap answers from the fixtures, with a stored position and the forecast widget
+function setUpOwm(currentStatus) {
+  harness.route(OWM_HOST + '/data/2.5/weather', function() {
+    if(currentStatus) {
+      return { status: currentStatus, body: { cod: currentStatus } };
+    }
+
+    return { body: harness.loadFixture('owm_weather.json') };
+  });
+  harness.route(OWM_HOST + '/data/2.5/forecast', function() {
+    return { body: harness.loadFixture('owm_forecast.json') };
+  });
+
+  window.localStorage.setItem('disable_weather', 'no');
+  window.localStorage.setItem('enable_forecast', 'yes');
+  window.localStorage.setItem('weather_loc', 'Paris');
+  window.localStorage.setItem('weather_loc_lat', '48.8566');
+  window.localStorage.setItem('weather_loc_lng', '2.3522');
+
+  return harness.loadPkjs('weather');
+}
+
+function lastPayload() {
+  var messages = Pebble.sentMessages;
+
+  return harness.decodeWeatherPayload(messages[messages.length - 1].WeatherData);
+}
+
+module.exports['concurrent updates share their requests'] = function(done) {
+  var weather = setUpOwm();
+
+  weather.updateWeather();
+  weather.updateWeather();
+
+  harness.settle(function() {
+    assert.equal(harness.countRequests('/weather'), 1);
+    assert.equal(harness.countRequests('/forecast'), 1);
+    done();
+  });
+};
+
+module.exports['recent responses come from the cache'] = function(done) {
+  var weather = setUpOwm();
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    var messageCount = Pebble.sentMessages.length;
+
+    harness.advanceTime(5 * MINUTE);
+    weather.updateWeather();
+
+    harness.settle(function() {
+      assert.equal(harness.countRequests('/weather'), 1);
+      assert.equal(harness.countRequests('/forecast'), 1);
+
+      // both parts come from the cache at once, so they share one message
+      assert.equal(Pebble.sentMessages.length, messageCount + 1);
+      assert.equal(lastPayload().flags & PAYLOAD_CURRENT, PAYLOAD_CURRENT);
+      assert.equal(lastPayload().slots.length, 8);
+      done();
+    });
+  });
+};
+
+module.exports['cached conditions keep their fetch time'] = function(done) {
+  var weather = setUpOwm();
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    var fetchTime = lastPayload().time;
+
+    harness.advanceTime(5 * MINUTE);
+    weather.updateWeather();
+
+    harness.settle(function() {
+      assert.equal(lastPayload().time, fetchTime);
+      done();
+    });
+  });
+};
+
+module.exports['nearby positions share the cache'] = function(done) {
+  var weather = setUpOwm();
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    window.localStorage.setItem('weather_loc_lat', '48.8571');
+    window.localStorage.setItem('weather_loc_lng', '2.3519');
+    weather.updateWeather();
+
+    harness.settle(function() {
+      assert.equal(harness.countRequests('/weather'), 1);
+      assert.equal(harness.countRequests('/forecast'), 1);
+      done();
+    });
+  });
+};
+
+module.exports['expired responses are fetched again'] = function(done) {
+  var weather = setUpOwm();
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    // the current conditions expire before the forecast
+    harness.advanceTime(11 * MINUTE);
+    weather.updateWeather();
+
+    harness.settle(function() {
+      assert.equal(harness.countRequests('/weather'), 2);
+      assert.equal(harness.countRequests('/forecast'), 1);
+
+      harness.advanceTime(50 * MINUTE);
+      weather.updateWeather();
+
+      harness.settle(function() {
+        assert.equal(harness.countRequests('/weather'), 3);
+        assert.equal(harness.countRequests('/forecast'), 2);
+        done();
+      });
+    });
+  });
+};
+
+module.exports['failed responses are not cached'] = function(done) {
+  var weather = setUpOwm(500);
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    weather.updateWeather();
+
+    harness.settle(function() {
+      assert.equal(harness.countRequests('/weather'), 2);
+      done();
+    });
+  });
+};
+
+module.exports['forced updates bypass the cache'] = function(done) {
+  var weather = setUpOwm();
+
+  weather.updateWeather();
+
+  harness.settle(function() {
+    weather.updateWeather(true);
+
+    harness.settle(function() {
+      assert.equal(harness.countRequests('/weather'), 2);
+      assert.equal(harness.countRequests('/forecast'), 2);
+      done();
+    });
+  });
+};
+
+module.exports['requests which never answer time out'] = function(done) {
+  var weather = setUpOwm();
+  var answering = false;
+
+  harness.route(OWM_HOST + '/data/2.5/weather', function() {
+    return answering ? { body: harness.loadFixture('owm_weather.json') } : null;
+  });
+
+  weather.updateWeather();
+
+  setTimeout(function() {
+    // a refresh while the request hangs waits for it
+    weather.updateWeather();
+    assert.equal(harness.countPendingRequests(), 1);
+
+    harness.expireRequests();
+
+    harness.settle(function() {
+      assert.equal(harness.countPendingRequests(), 0);
+      answering = true;
+      weather.updateWeather();
+
+      harness.settle(function() {
+        // the url isn't in flight anymore, so it's requested again
+        assert.equal(harness.countRequests('/weather'), 2);
+        assert.equal(lastPayload().flags & PAYLOAD_CURRENT, PAYLOAD_CURRENT);
+        done();
+      });
+    });
+  }, 50);
+};
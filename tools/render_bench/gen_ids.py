@@ -0,0 +1,60 @@
+#!/usr/bin/env python
+#
+# Generates the resource and message key ids of the render benchmark from package.json,
+# the way the Pebble SDK does for the watch build.
+#
+# Command line example: python ./gen_ids.py "../../package.json" "bench_ids.auto.h"
+
+import argparse
+import json
+import re
+
+
+def message_key_defines(message_keys, first_key=10000):
+    """
+    Numbers the message keys like the SDK: "Name[n]" reserves n consecutive keys
+    :param message_keys: the messageKeys list of package.json
+    :return: yields the #define lines
+    """
+    key = first_key
+    for entry in message_keys:
+        match = re.match(r'^(\w+)(?:\[(\d+)\])?$', entry)
+        name, count = match.group(1), int(match.group(2) or 1)
+        yield '#define MESSAGE_KEY_{} {}'.format(name, key)
+        key += count
+
+
+def generate(package_json, output):
+    with open(package_json) as f:
+        pebble = json.load(f)['pebble']
+
+    media = pebble['resources']['media']
+    lines = ['// generated from package.json by gen_ids.py, do not edit', '#pragma once', '']
+
+    # resource ids start at 1, the index in the table of resource files
+    for index, resource in enumerate(media):
+        lines.append('#define RESOURCE_ID_{} {}'.format(resource['name'], index + 1))
+
+    lines.append('')
+    lines.extend(message_key_defines(pebble['messageKeys']))
+
+    lines.append('')
+    lines.append('#ifdef SHIM_RESOURCE_FILES')
+    lines.append('static const char* const shim_resource_files[] = {')
+    lines.append('  NULL,')
+    for resource in media:
+        lines.append('  "{}",'.format(resource['file']))
+    lines.append('};')
+    lines.append('#endif')
+
+    with open(output, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Generate the render benchmark ids from package.json')
+    parser.add_argument('package_json')
+    parser.add_argument('output')
+    args = parser.parse_args()
+
+    generate(args.package_json, args.output)
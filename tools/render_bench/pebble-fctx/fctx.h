@@ -0,0 +1,72 @@
+#pragma once
+/*
+ * Host stand-in for the pebble-fctx API used by the watchface. Paths are
+ * recorded and filled without antialiasing, see shim_fctx.c
+ */
+#include <pebble.h>
+#include "ffont.h"
+
+typedef int32_t fixed_t;
+
+#define FIXED_POINT_SHIFT 4
+#define FIXED_POINT_SCALE 16
+#define INT_TO_FIXED(a) ((a) * FIXED_POINT_SCALE)
+#define FIXED_TO_INT(a) ((a) / FIXED_POINT_SCALE)
+#define FIXED_MULTIPLY(a, b) (((a) * (b)) / FIXED_POINT_SCALE)
+
+typedef struct FPoint {
+  fixed_t x;
+  fixed_t y;
+} FPoint;
+
+#define FPoint(x, y) ((FPoint){(x), (y)})
+#define FPointI(x, y) ((FPoint){INT_TO_FIXED(x), INT_TO_FIXED(y)})
+#define FPointZero FPoint(0, 0)
+#define FPointOne FPointI(1, 1)
+
+typedef enum {
+  FTextAnchorBaseline,
+  FTextAnchorMiddle,
+  FTextAnchorCapMiddle,
+  FTextAnchorTop,
+  FTextAnchorCapTop,
+  FTextAnchorBottom
+} FTextAnchor;
+
+typedef struct FContext {
+  GContext* gctx;
+  GColor fill_color;
+  FPoint transform_offset;
+  FPoint transform_scale_from;
+  FPoint transform_scale_to;
+
+  // the current path, in fixed point screen coordinates
+  FPoint* points;
+  uint16_t* contour_ends;
+  uint16_t point_count;
+  uint16_t point_capacity;
+  uint16_t contour_count;
+  uint16_t contour_capacity;
+} FContext;
+
+void fctx_enable_aa(bool enable);
+bool fctx_is_aa_enabled(void);
+
+void fctx_init_context(FContext* fctx, GContext* gctx);
+void fctx_deinit_context(FContext* fctx);
+
+void fctx_set_fill_color(FContext* fctx, GColor c);
+void fctx_set_offset(FContext* fctx, FPoint offset);
+void fctx_set_scale(FContext* fctx, FPoint scale_from, FPoint scale_to);
+
+void fctx_begin_fill(FContext* fctx);
+void fctx_move_to(FContext* fctx, FPoint p);
+void fctx_line_to(FContext* fctx, FPoint p);
+void fctx_quadratic_to(FContext* fctx, FPoint cp, FPoint p);
+void fctx_curve_to(FContext* fctx, FPoint cp0, FPoint cp1, FPoint p);
+void fctx_close_path(FContext* fctx);
+void fctx_end_fill(FContext* fctx);
+
+void fctx_set_text_em_height(FContext* fctx, FFont* font, int16_t pixels);
+fixed_t fctx_string_width(FContext* fctx, const char* text, FFont* font);
+void fctx_draw_string(FContext* fctx, const char* text, FFont* font, GTextAlignment alignment, FTextAnchor anchor);
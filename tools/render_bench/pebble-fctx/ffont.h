@@ -0,0 +1,10 @@
+#pragma once
+/*
+ * Host stand-in for the pebble-fctx font API, see shim_fctx.c
+ */
+#include <pebble.h>
+
+typedef struct FFont FFont;
+
+FFont* ffont_create_from_resource(uint32_t resource_id);
+void ffont_destroy(FFont* font);
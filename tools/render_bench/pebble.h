@@ -0,0 +1,489 @@
+#pragma once
+/*
+ * Host stand-in for the parts of the Pebble SDK used by the watchface, so that
+ * src/c can be built and rendered on a desktop machine by the render benchmark.
+ * Only declarations live here, see shim.c for the implementations.
+ *
+ * Like with the SDK, the platform comes from the compiler flags: PBL_COLOR and
+ * PBL_HEALTH are always expected, along with PBL_ROUND for chalk (basalt otherwise).
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <locale.h>
+#include "bench_ids.auto.h"
+
+// platform
+#if !defined(PBL_COLOR) || !defined(PBL_HEALTH)
+  #error "the render benchmark only emulates color watches with health"
+#endif
+
+#ifdef PBL_ROUND
+  #define PBL_DISPLAY_WIDTH  180
+  #define PBL_DISPLAY_HEIGHT 180
+  #define PBL_IF_ROUND_ELSE(if_true, if_false) (if_true)
+  #define PBL_IF_RECT_ELSE(if_true, if_false) (if_false)
+#else
+  #define PBL_RECT
+  #define PBL_DISPLAY_WIDTH  144
+  #define PBL_DISPLAY_HEIGHT 168
+  #define PBL_IF_ROUND_ELSE(if_true, if_false) (if_false)
+  #define PBL_IF_RECT_ELSE(if_true, if_false) (if_true)
+#endif
+
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_true)
+#define PBL_IF_BW_ELSE(if_true, if_false) (if_false)
+#define PBL_IF_HEALTH_ELSE(if_true, if_false) (if_true)
+
+#define ACTION_BAR_WIDTH PBL_IF_ROUND_ELSE(40, 30)
+
+// logging, compiled out so that it doesn't weigh on the measures
+#define APP_LOG_LEVEL_ERROR 1
+#define APP_LOG_LEVEL_WARNING 50
+#define APP_LOG_LEVEL_INFO 100
+#define APP_LOG_LEVEL_DEBUG 200
+#define APP_LOG(level, fmt, ...) do { if(0) { printf(fmt, ##__VA_ARGS__); } } while(0)
+
+#define ARRAY_LENGTH(array) (sizeof((array))/sizeof((array)[0]))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+#define TRIG_MAX_ANGLE 0x10000
+#define DEG_TO_TRIGANGLE(angle) (((angle) * TRIG_MAX_ANGLE) / 360)
+
+// colors
+typedef union GColor8 {
+  uint8_t argb;
+  struct {
+    uint8_t b:2;
+    uint8_t g:2;
+    uint8_t r:2;
+    uint8_t a:2;
+  };
+} GColor8;
+
+typedef GColor8 GColor;
+
+#define GColorFromRGB(red, green, blue) \
+  ((GColor8){.argb = (uint8_t)(0xC0 | (((red) >> 6) << 4) | (((green) >> 6) << 2) | ((blue) >> 6))})
+#define GColorFromHEX(v) GColorFromRGB(((v) >> 16) & 0xFF, ((v) >> 8) & 0xFF, (v) & 0xFF)
+
+#define GColorClearARGB8          0x00
+#define GColorBlackARGB8          0xC0
+#define GColorRedARGB8            0xF0
+#define GColorVividCeruleanARGB8  0xDB
+#define GColorLightGrayARGB8      0xEA
+#define GColorWhiteARGB8          0xFF
+
+#define GColorClear          ((GColor8){.argb = GColorClearARGB8})
+#define GColorBlack          ((GColor8){.argb = GColorBlackARGB8})
+#define GColorRed            ((GColor8){.argb = GColorRedARGB8})
+#define GColorVividCerulean  ((GColor8){.argb = GColorVividCeruleanARGB8})
+#define GColorLightGray      ((GColor8){.argb = GColorLightGrayARGB8})
+#define GColorWhite          ((GColor8){.argb = GColorWhiteARGB8})
+
+bool gcolor_equal(GColor8 x, GColor8 y);
+
+// geometry
+typedef struct GPoint {
+  int16_t x;
+  int16_t y;
+} GPoint;
+
+typedef struct GSize {
+  int16_t w;
+  int16_t h;
+} GSize;
+
+typedef struct GRect {
+  GPoint origin;
+  GSize size;
+} GRect;
+
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GPointZero GPoint(0, 0)
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GSizeZero GSize(0, 0)
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GRectZero GRect(0, 0, 0, 0)
+
+bool grect_equal(const GRect* const rect_a, const GRect* const rect_b);
+
+typedef enum {
+  GCornerNone = 0,
+  GCornerTopLeft = 1 << 0,
+  GCornerTopRight = 1 << 1,
+  GCornerBottomLeft = 1 << 2,
+  GCornerBottomRight = 1 << 3,
+  GCornersAll = 0x0F
+} GCornerMask;
+
+typedef enum {
+  GOvalScaleModeFitCircle,
+  GOvalScaleModeFillCircle
+} GOvalScaleMode;
+
+// bitmaps
+typedef enum {
+  GBitmapFormat1Bit = 0,
+  GBitmapFormat8Bit,
+  GBitmapFormat1BitPalette,
+  GBitmapFormat2BitPalette,
+  GBitmapFormat4BitPalette,
+  GBitmapFormat8BitCircular
+} GBitmapFormat;
+
+typedef enum {
+  GCompOpAssign,
+  GCompOpAssignInverted,
+  GCompOpOr,
+  GCompOpAnd,
+  GCompOpClear,
+  GCompOpSet
+} GCompOp;
+
+typedef struct GBitmap GBitmap;
+
+typedef struct {
+  uint8_t* data;
+  int16_t min_x;
+  int16_t max_x;
+} GBitmapDataRowInfo;
+
+GBitmap* gbitmap_create_blank(GSize size, GBitmapFormat format);
+void gbitmap_destroy(GBitmap* bitmap);
+uint8_t* gbitmap_get_data(const GBitmap* bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap* bitmap);
+GBitmapFormat gbitmap_get_format(const GBitmap* bitmap);
+GRect gbitmap_get_bounds(const GBitmap* bitmap);
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap* bitmap, uint16_t y);
+
+// graphics
+typedef struct GContext GContext;
+
+typedef enum {
+  GTextAlignmentLeft,
+  GTextAlignmentCenter,
+  GTextAlignmentRight
+} GTextAlignment;
+
+typedef enum {
+  GTextOverflowModeWordWrap,
+  GTextOverflowModeTrailingEllipsis,
+  GTextOverflowModeFill
+} GTextOverflowMode;
+
+typedef struct GTextAttributes GTextAttributes;
+typedef struct ShimFont* GFont;
+
+#define FONT_KEY_GOTHIC_14_BOLD "RESOURCE_ID_GOTHIC_14_BOLD"
+#define FONT_KEY_GOTHIC_18_BOLD "RESOURCE_ID_GOTHIC_18_BOLD"
+#define FONT_KEY_GOTHIC_24_BOLD "RESOURCE_ID_GOTHIC_24_BOLD"
+#define FONT_KEY_GOTHIC_28_BOLD "RESOURCE_ID_GOTHIC_28_BOLD"
+
+GFont fonts_get_system_font(const char* font_key);
+
+void graphics_context_set_fill_color(GContext* ctx, GColor color);
+void graphics_context_set_stroke_color(GContext* ctx, GColor color);
+void graphics_context_set_text_color(GContext* ctx, GColor color);
+void graphics_context_set_compositing_mode(GContext* ctx, GCompOp mode);
+void graphics_context_set_antialiased(GContext* ctx, bool enable);
+void graphics_context_set_stroke_width(GContext* ctx, uint8_t stroke_width);
+
+void graphics_fill_rect(GContext* ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_fill_radial(GContext* ctx, GRect rect, GOvalScaleMode scale_mode, uint16_t inset_thickness,
+                          int32_t angle_start, int32_t angle_end);
+void graphics_fill_circle(GContext* ctx, GPoint p, uint16_t radius);
+void graphics_draw_line(GContext* ctx, GPoint p0, GPoint p1);
+void graphics_draw_rect(GContext* ctx, GRect rect);
+void graphics_draw_bitmap_in_rect(GContext* ctx, const GBitmap* bitmap, GRect rect);
+void graphics_draw_text(GContext* ctx, const char* text, GFont const font, const GRect box,
+                        const GTextOverflowMode overflow_mode, const GTextAlignment alignment,
+                        GTextAttributes* text_attributes);
+GSize graphics_text_layout_get_content_size(const char* text, GFont const font, const GRect box,
+                                            const GTextOverflowMode overflow_mode, const GTextAlignment alignment);
+
+GBitmap* graphics_capture_frame_buffer(GContext* ctx);
+bool graphics_release_frame_buffer(GContext* ctx, GBitmap* buffer);
+
+// draw commands
+typedef struct GDrawCommand GDrawCommand;
+typedef struct GDrawCommandList GDrawCommandList;
+typedef struct GDrawCommandImage GDrawCommandImage;
+typedef bool (*GDrawCommandListIteratorCb)(GDrawCommand* command, uint32_t index, void* context);
+
+GDrawCommandImage* gdraw_command_image_create_with_resource(uint32_t resource_id);
+GDrawCommandImage* gdraw_command_image_clone(GDrawCommandImage* image);
+void gdraw_command_image_destroy(GDrawCommandImage* image);
+void gdraw_command_image_draw(GContext* ctx, GDrawCommandImage* image, GPoint offset);
+GSize gdraw_command_image_get_bounds_size(GDrawCommandImage* image);
+GDrawCommandList* gdraw_command_image_get_command_list(GDrawCommandImage* image);
+bool gdraw_command_list_iterate(GDrawCommandList* command_list, GDrawCommandListIteratorCb handle_command, void* callback_context);
+void gdraw_command_set_fill_color(GDrawCommand* command, GColor fill_color);
+void gdraw_command_set_stroke_color(GDrawCommand* command, GColor stroke_color);
+
+// layers and windows
+typedef struct Layer Layer;
+typedef struct Window Window;
+typedef void (*LayerUpdateProc)(struct Layer* layer, GContext* ctx);
+
+Layer* layer_create(GRect frame);
+Layer* layer_create_with_data(GRect frame, size_t data_size);
+void layer_destroy(Layer* layer);
+void* layer_get_data(const Layer* layer);
+void layer_set_update_proc(Layer* layer, LayerUpdateProc update_proc);
+void layer_mark_dirty(Layer* layer);
+void layer_add_child(Layer* parent, Layer* child);
+void layer_remove_from_parent(Layer* child);
+void layer_set_frame(Layer* layer, GRect frame);
+GRect layer_get_frame(const Layer* layer);
+void layer_set_bounds(Layer* layer, GRect bounds);
+GRect layer_get_bounds(const Layer* layer);
+GRect layer_get_unobstructed_bounds(const Layer* layer);
+void layer_set_hidden(Layer* layer, bool hidden);
+bool layer_get_hidden(const Layer* layer);
+GPoint layer_convert_point_to_screen(const Layer* layer, GPoint point);
+
+typedef void (*WindowHandler)(struct Window* window);
+
+typedef struct WindowHandlers {
+  WindowHandler load;
+  WindowHandler appear;
+  WindowHandler disappear;
+  WindowHandler unload;
+} WindowHandlers;
+
+Window* window_create(void);
+void window_destroy(Window* window);
+void window_set_window_handlers(Window* window, WindowHandlers handlers);
+void window_set_background_color(Window* window, GColor background_color);
+Layer* window_get_root_layer(const Window* window);
+void window_stack_push(Window* window, bool animated);
+
+// resources
+typedef struct ShimResource* ResHandle;
+
+ResHandle resource_get_handle(uint32_t resource_id);
+size_t resource_size(ResHandle h);
+size_t resource_load(ResHandle h, uint8_t* buffer, size_t max_length);
+
+// services
+typedef enum {
+  SECOND_UNIT = 1 << 0,
+  MINUTE_UNIT = 1 << 1,
+  HOUR_UNIT = 1 << 2,
+  DAY_UNIT = 1 << 3,
+  MONTH_UNIT = 1 << 4,
+  YEAR_UNIT = 1 << 5
+} TimeUnits;
+
+typedef void (*TickHandler)(struct tm* tick_time, TimeUnits units_changed);
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+
+typedef struct {
+  uint8_t charge_percent;
+  bool is_charging;
+  bool is_plugged;
+} BatteryChargeState;
+
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+
+BatteryChargeState battery_state_service_peek(void);
+void battery_state_service_subscribe(BatteryStateHandler handler);
+void battery_state_service_unsubscribe(void);
+
+typedef void (*BluetoothConnectionHandler)(bool connected);
+
+bool bluetooth_connection_service_peek(void);
+void bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler);
+void bluetooth_connection_service_unsubscribe(void);
+
+typedef int32_t AnimationProgress;
+typedef void (*UnobstructedAreaWillChangeHandler)(GRect final_unobstructed_screen_area, void* context);
+typedef void (*UnobstructedAreaChangeHandler)(AnimationProgress progress, void* context);
+typedef void (*UnobstructedAreaDidChangeHandler)(void* context);
+
+typedef struct UnobstructedAreaHandlers {
+  UnobstructedAreaWillChangeHandler will_change;
+  UnobstructedAreaChangeHandler change;
+  UnobstructedAreaDidChangeHandler did_change;
+} UnobstructedAreaHandlers;
+
+void unobstructed_area_service_subscribe(UnobstructedAreaHandlers handlers, void* context);
+void unobstructed_area_service_unsubscribe(void);
+
+typedef void (*AppFocusHandler)(bool in_focus);
+
+typedef struct {
+  AppFocusHandler will_focus;
+  AppFocusHandler did_focus;
+} AppFocusHandlers;
+
+void app_focus_service_subscribe_handlers(AppFocusHandlers handlers);
+void app_focus_service_unsubscribe(void);
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void* data);
+
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void* callback_data);
+bool app_timer_reschedule(AppTimer* timer_handle, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer* timer_handle);
+
+typedef struct {
+  const uint32_t* durations;
+  uint32_t num_segments;
+} VibePattern;
+
+void vibes_short_pulse(void);
+void vibes_double_pulse(void);
+void vibes_enqueue_custom_pattern(VibePattern pattern);
+
+// time, frozen so that every run draws the same digits, unless shim_run_until() advances it
+time_t shim_time(time_t* tloc);
+#define time(tloc) shim_time(tloc)
+
+#define SECONDS_PER_MINUTE 60
+#define SECONDS_PER_HOUR 3600
+#define SECONDS_PER_DAY 86400
+
+bool clock_is_24h_style(void);
+bool quiet_time_is_active(void);
+time_t time_start_of_today(void);
+uint16_t time_ms(time_t* tloc, uint16_t* out_ms);
+
+// memory
+size_t heap_bytes_free(void);
+size_t heap_bytes_used(void);
+
+// persistent storage, kept in memory
+#define PERSIST_DATA_MAX_LENGTH 256
+
+bool persist_exists(const uint32_t key);
+int32_t persist_read_int(const uint32_t key);
+int persist_read_data(const uint32_t key, void* buffer, const size_t buffer_size);
+int persist_write_int(const uint32_t key, const int32_t value);
+int persist_write_data(const uint32_t key, const void* data, const size_t size);
+int persist_delete(const uint32_t key);
+
+// app messages, nothing is ever received
+typedef enum {
+  TUPLE_BYTE_ARRAY = 0,
+  TUPLE_CSTRING = 1,
+  TUPLE_UINT = 2,
+  TUPLE_INT = 3
+} TupleType;
+
+typedef struct __attribute__((__packed__)) {
+  uint32_t key;
+  TupleType type:8;
+  uint16_t length;
+  union {
+    uint8_t data[0];
+    char cstring[0];
+    uint8_t uint8;
+    uint16_t uint16;
+    uint32_t uint32;
+    int8_t int8;
+    int16_t int16;
+    int32_t int32;
+  } value[];
+} Tuple;
+
+typedef struct DictionaryIterator DictionaryIterator;
+
+typedef enum {
+  DICT_OK = 0,
+  DICT_NOT_ENOUGH_STORAGE = 1 << 1,
+  DICT_INVALID_ARGS = 1 << 2
+} DictionaryResult;
+
+Tuple* dict_find(const DictionaryIterator* iter, const uint32_t key);
+Tuple* dict_read_first(DictionaryIterator* iter);
+Tuple* dict_read_next(DictionaryIterator* iter);
+uint32_t dict_size(DictionaryIterator* iter);
+DictionaryResult dict_write_uint8(DictionaryIterator* iter, const uint32_t key, const uint8_t value);
+DictionaryResult dict_write_uint32(DictionaryIterator* iter, const uint32_t key, const uint32_t value);
+DictionaryResult dict_write_int32(DictionaryIterator* iter, const uint32_t key, const int32_t value);
+DictionaryResult dict_write_cstring(DictionaryIterator* iter, const uint32_t key, const char* const cstring);
+DictionaryResult dict_write_data(DictionaryIterator* iter, const uint32_t key, const uint8_t* const data, const uint16_t size);
+
+typedef enum {
+  APP_MSG_OK = 0,
+  APP_MSG_SEND_TIMEOUT = 1 << 1,
+  APP_MSG_SEND_REJECTED = 1 << 2,
+  APP_MSG_NOT_CONNECTED = 1 << 3,
+  APP_MSG_APP_NOT_RUNNING = 1 << 4,
+  APP_MSG_INVALID_ARGS = 1 << 5,
+  APP_MSG_BUSY = 1 << 6,
+  APP_MSG_BUFFER_OVERFLOW = 1 << 7,
+  APP_MSG_OUT_OF_MEMORY = 1 << 10,
+  APP_MSG_CLOSED = 1 << 11,
+  APP_MSG_INTERNAL_ERROR = 1 << 12
+} AppMessageResult;
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator* iterator, void* context);
+typedef void (*AppMessageInboxDropped)(AppMessageResult reason, void* context);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator* iterator, void* context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator* iterator, AppMessageResult reason, void* context);
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback);
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback);
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback);
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+AppMessageResult app_message_outbox_begin(DictionaryIterator** iterator);
+AppMessageResult app_message_outbox_send(void);
+
+// health, with fixed values
+typedef int32_t HealthValue;
+
+typedef enum {
+  HealthMetricStepCount,
+  HealthMetricActiveSeconds,
+  HealthMetricWalkedDistanceMeters,
+  HealthMetricSleepSeconds,
+  HealthMetricSleepRestfulSeconds,
+  HealthMetricRestingKCalories,
+  HealthMetricActiveKCalories,
+  HealthMetricHeartRateBPM,
+  HealthMetricHeartRateRawBPM
+} HealthMetric;
+
+typedef enum {
+  HealthActivityNone = 0,
+  HealthActivitySleep = 1 << 0,
+  HealthActivityRestfulSleep = 1 << 1,
+  HealthActivityWalk = 1 << 2,
+  HealthActivityRun = 1 << 3,
+  HealthActivityOpenWorkout = 1 << 4
+} HealthActivity;
+
+typedef uint32_t HealthActivityMask;
+
+typedef enum {
+  HealthServiceAccessibilityMaskAvailable = 1 << 0,
+  HealthServiceAccessibilityMaskNoPermission = 1 << 1,
+  HealthServiceAccessibilityMaskNotSupported = 1 << 2,
+  HealthServiceAccessibilityMaskNotAvailable = 1 << 3
+} HealthServiceAccessibilityMask;
+
+typedef enum {
+  MeasurementSystemUnknown,
+  MeasurementSystemMetric,
+  MeasurementSystemImperial
+} MeasurementSystem;
+
+HealthServiceAccessibilityMask health_service_metric_accessible(HealthMetric metric, time_t time_start, time_t time_end);
+HealthValue health_service_sum_today(HealthMetric metric);
+HealthValue health_service_peek_current_value(HealthMetric metric);
+HealthActivityMask health_service_peek_current_activities(void);
+MeasurementSystem health_service_get_measurement_system_for_display(HealthMetric metric);
+
+// app
+void app_event_loop(void);
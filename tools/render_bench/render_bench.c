@@ -0,0 +1,174 @@
+/*
+ * Renders the watchface on the host with the SDK shim, for every sidebar
+ * location, clock font and sidebar widget, and reports what a frame costs.
+ *
+ * Built and run for basalt and chalk by the render_bench command of the wscript,
+ * once "pebble build" has configured the project:
+ *
+ *   waf render_bench --bench-frames=100
+ *
+ * or directly: render_bench [frames] [resource directory]
+ *
+ * With "ticks", the whole watchface runs for a while of simulated time instead,
+ * and what its ticks and timers redraw is reported, see tick_bench.c:
+ *
+ *   waf render_bench --bench-minutes=60
+ *   render_bench ticks [minutes] [resource directory]
+ */
+#include <pebble.h>
+#include "shim.h"
+#include "tick_bench.h"
+#include "../../src/c/clock_area.h"
+#include "../../src/c/settings.h"
+#include "../../src/c/weather.h"
+#include "../../src/c/sidebar.h"
+#include "../../src/c/time_date.h"
+#include "../../src/c/icon_pool.h"
+#include "../../src/c/storage.h"
+#ifdef PBL_HEALTH
+#include "../../src/c/health.h"
+#endif
+
+#define DEFAULT_FRAMES 100
+#define DEFAULT_MINUTES 60
+
+#ifndef RENDER_BENCH_RESOURCES
+#define RENDER_BENCH_RESOURCES "resources"
+#endif
+
+static const char* const locationNames[] = { "none", "left", "right", "bottom", "top" };
+
+static const char* const fontNames[] = { "avenir", "leco", "bold", "bold_h", "bold_m" };
+
+static const char* const widgetNames[] = {
+  "empty", "bluetooth", "battery", "alt_time_zone", "date", "seconds", "week_number",
+  "weather_current", "weather_forecast", "unused", "health", "beats", "heartrate", "sleep", "steps"
+};
+
+static Window* mainWindow;
+
+static void main_window_load(Window* window) {
+  Sidebar_init(window);
+  ClockArea_init(window);
+}
+
+static void main_window_unload(Window* window) {
+  ClockArea_deinit();
+  Sidebar_deinit();
+}
+
+// same as redrawScreen() and update_screen() in main.c, minus the services
+static void apply_settings(void) {
+  Settings_updateDynamicSettings();
+
+  window_set_background_color(mainWindow, globalSettings.timeBgColor);
+  Sidebar_set_layer();
+  ClockArea_update_fonts();
+  ClockArea_update_layout(false);
+
+  time_t now = time(NULL);
+  time_date_update_beats(now);
+
+  uint16_t changes = CHANGED_ALL | time_date_update(localtime(&now), TIME_DATE_ALL_UNITS);
+#ifdef PBL_HEALTH
+  changes |= Health_update();
+#endif
+
+  if(globalSettings.sidebarLocation != NONE) {
+    Sidebar_redraw_changes(changes);
+  }
+
+  ClockArea_redraw_changes(changes);
+}
+
+static void bench(BarLocationType location, uint8_t fontId, SidebarWidgetType widget, int frames) {
+  globalSettings.sidebarLocation = location;
+  globalSettings.clockFontId = fontId;
+
+  for(int i = 0; i < 4; i++) {
+    globalSettings.widgets[i] = widget;
+  }
+
+  apply_settings();
+
+  // the first frame fills the caches
+  shim_render(mainWindow);
+  shim_reset_counters();
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for(int i = 0; i < frames; i++) {
+    shim_render(mainWindow);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+
+  printf("%s,%s,%s,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+         locationNames[location], fontNames[fontId], (location == NONE) ? "-" : widgetNames[widget],
+         us / frames,
+         (double)shim_counters.calls / frames,
+         (double)shim_counters.points / frames,
+         (double)shim_counters.pixels / frames,
+         (double)shim_counters.textChars / frames);
+}
+
+int main(int argc, char** argv) {
+  if(argc > 1 && strcmp(argv[1], "ticks") == 0) {
+    shim_init((argc > 3) ? argv[3] : RENDER_BENCH_RESOURCES);
+    tick_bench_run((argc > 2) ? atoi(argv[2]) : DEFAULT_MINUTES);
+    shim_deinit();
+
+    return 0;
+  }
+
+  int frames = (argc > 1) ? atoi(argv[1]) : DEFAULT_FRAMES;
+
+  shim_init((argc > 2) ? argv[2] : RENDER_BENCH_RESOURCES);
+
+  Settings_init();
+  Weather_init();
+
+  // some weather to draw
+  Weather_weatherInfo.currentTemp = 21;
+  Weather_weatherForecast.highTemp = 24;
+  Weather_weatherForecast.lowTemp = 12;
+  Weather_setCurrentCondition(PARTLY_CLOUDY, time(NULL));
+  Weather_setForecastCondition(LIGHT_RAIN);
+
+  mainWindow = window_create();
+  window_set_window_handlers(mainWindow, (WindowHandlers) {
+    .load = main_window_load,
+    .unload = main_window_unload
+  });
+  window_stack_push(mainWindow, false);
+
+  printf("location,font,widget,us_per_frame,calls_per_frame,points_per_frame,pixels_per_frame,text_chars_per_frame\n");
+
+  for(int location = NONE; location <= TOP; location++) {
+    for(uint8_t fontId = 0; fontId < ARRAY_LENGTH(fontNames); fontId++) {
+      // without a sidebar the widgets don't matter
+      if(location == NONE) {
+        bench(location, fontId, EMPTY, frames);
+        continue;
+      }
+
+      for(int widget = EMPTY; widget < (int)ARRAY_LENGTH(widgetNames); widget++) {
+        if(widget != TIME_UNUSED) {
+          bench(location, fontId, widget, frames);
+        }
+      }
+    }
+  }
+
+  window_destroy(mainWindow);
+  Weather_deinit();
+  IconPool_deinit();
+  Settings_deinit();
+  Storage_deinit();
+  shim_deinit();
+
+  return 0;
+}
@@ -0,0 +1,878 @@
+// the file names of the resources, along with their ids
+#define SHIM_RESOURCE_FILES
+
+#include <pebble.h>
+#include <math.h>
+#include "shim.h"
+
+#define RESOURCE_COUNT (sizeof(shim_resource_files) / sizeof(shim_resource_files[0]))
+#define PERSIST_MAX_KEYS 64
+
+ShimCounters shim_counters;
+int16_t shim_obstruction_height;
+
+static const char* resourcePath;
+
+// "private" structures
+
+struct Layer {
+  GRect frame;
+  GRect bounds;
+  bool hidden;
+  LayerUpdateProc update_proc;
+
+  Layer* parent;
+  Layer* first_child;
+  Layer* next_sibling;
+
+  // data of layer_create_with_data()
+  uint8_t data[];
+};
+
+struct Window {
+  Layer* root_layer;
+  GColor background_color;
+  WindowHandlers handlers;
+};
+
+struct GBitmap {
+  GSize size;
+  GBitmapFormat format;
+  uint16_t row_size;
+  uint8_t* data;
+};
+
+struct AppTimer {
+  uint64_t fireTime;
+  AppTimerCallback callback;
+  void* data;
+  bool scheduled;
+
+  AppTimer* next;
+};
+
+struct ShimResource {
+  uint8_t* data;
+  size_t size;
+};
+
+struct ShimFont {
+  const char* key;
+  int16_t height;
+};
+
+typedef struct {
+  uint32_t key;
+  size_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} PersistEntry;
+
+static GBitmap frameBuffer;
+
+// the window on top of the stack, rendered by shim_run_until()
+static Window* topWindow;
+
+// set when a layer is marked dirty: PebbleOS then renders the whole window
+static bool renderScheduled;
+
+// simulated time, in milliseconds
+static uint64_t now;
+
+// every timer ever registered, so that stale handles stay valid
+static AppTimer* timers;
+
+static TimeUnits tickUnits;
+static TickHandler tickHandler;
+static struct ShimResource resources[RESOURCE_COUNT];
+static PersistEntry persistEntries[PERSIST_MAX_KEYS];
+static int persistCount;
+
+static struct ShimFont systemFonts[] = {
+  { FONT_KEY_GOTHIC_14_BOLD, 14 },
+  { FONT_KEY_GOTHIC_18_BOLD, 18 },
+  { FONT_KEY_GOTHIC_24_BOLD, 24 },
+  { FONT_KEY_GOTHIC_28_BOLD, 28 },
+};
+
+// "public" shim functions
+
+void shim_init(const char* resourceDirectory) {
+  resourcePath = resourceDirectory;
+
+  frameBuffer.size = GSize(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT);
+  frameBuffer.format = PBL_IF_ROUND_ELSE(GBitmapFormat8BitCircular, GBitmapFormat8Bit);
+  frameBuffer.row_size = PBL_DISPLAY_WIDTH;
+  frameBuffer.data = calloc(PBL_DISPLAY_WIDTH * PBL_DISPLAY_HEIGHT, 1);
+
+  // a wednesday morning, 10:08:42
+  struct tm frozen = {
+    .tm_year = 2024 - 1900,
+    .tm_mon = 4,
+    .tm_mday = 15,
+    .tm_hour = 10,
+    .tm_min = 8,
+    .tm_sec = 42,
+    .tm_isdst = -1
+  };
+
+  now = (uint64_t)mktime(&frozen) * 1000;
+}
+
+void shim_deinit(void) {
+  for(size_t i = 0; i < RESOURCE_COUNT; i++) {
+    free(resources[i].data);
+    resources[i].data = NULL;
+  }
+
+  free(frameBuffer.data);
+  frameBuffer.data = NULL;
+
+  while(timers) {
+    AppTimer* next = timers->next;
+
+    free(timers);
+    timers = next;
+  }
+}
+
+void shim_reset_counters(void) {
+  memset(&shim_counters, 0, sizeof(ShimCounters));
+}
+
+static GRect grect_intersection(GRect a, GRect b) {
+  int16_t left = MAX(a.origin.x, b.origin.x);
+  int16_t top = MAX(a.origin.y, b.origin.y);
+  int16_t right = MIN(a.origin.x + a.size.w, b.origin.x + b.size.w);
+  int16_t bottom = MIN(a.origin.y + a.size.h, b.origin.y + b.size.h);
+
+  if(right <= left || bottom <= top) {
+    return GRectZero;
+  }
+
+  return GRect(left, top, right - left, bottom - top);
+}
+
+static void render_layer(Layer* layer, GContext* ctx, GPoint parentOffset, GRect parentClip) {
+  if(layer->hidden) {
+    return;
+  }
+
+  GRect frame = layer->frame;
+
+  frame.origin.x += parentOffset.x;
+  frame.origin.y += parentOffset.y;
+
+  GRect clip = grect_intersection(parentClip, frame);
+  GPoint offset = GPoint(frame.origin.x + layer->bounds.origin.x, frame.origin.y + layer->bounds.origin.y);
+
+  if(layer->update_proc) {
+    // every layer starts with a fresh graphics context
+    ctx->fill_color = GColorBlack;
+    ctx->stroke_color = GColorBlack;
+    ctx->text_color = GColorBlack;
+    ctx->compositing_mode = GCompOpAssign;
+    ctx->stroke_width = 1;
+    ctx->antialiased = true;
+    ctx->offset = offset;
+    ctx->clip = clip;
+
+    layer->update_proc(layer, ctx);
+  }
+
+  for(Layer* child = layer->first_child; child; child = child->next_sibling) {
+    render_layer(child, ctx, offset, clip);
+  }
+}
+
+void shim_render(Window* window) {
+  GContext ctx;
+  GRect screen = GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT);
+
+  memset(&ctx, 0, sizeof(GContext));
+  ctx.frame_buffer = &frameBuffer;
+
+  // the window background
+  ctx.clip = screen;
+  graphics_context_set_fill_color(&ctx, window->background_color);
+  graphics_fill_rect(&ctx, screen, 0, GCornerNone);
+
+  render_layer(window->root_layer, &ctx, GPointZero, screen);
+
+  shim_counters.frames++;
+  renderScheduled = false;
+}
+
+// the earliest timer due, if any
+static AppTimer* next_timer(void) {
+  AppTimer* next = NULL;
+
+  for(AppTimer* timer = timers; timer; timer = timer->next) {
+    if(timer->scheduled && (!next || timer->fireTime < next->fireTime)) {
+      next = timer;
+    }
+  }
+
+  return next;
+}
+
+static TimeUnits units_changed(time_t before, time_t after) {
+  struct tm previous = *localtime(&before);
+  struct tm* current = localtime(&after);
+  TimeUnits units = SECOND_UNIT;
+
+  if(current->tm_min != previous.tm_min) {
+    units |= MINUTE_UNIT;
+  }
+
+  if(current->tm_hour != previous.tm_hour) {
+    units |= HOUR_UNIT;
+  }
+
+  if(current->tm_mday != previous.tm_mday) {
+    units |= DAY_UNIT;
+  }
+
+  if(current->tm_mon != previous.tm_mon) {
+    units |= MONTH_UNIT;
+  }
+
+  if(current->tm_year != previous.tm_year) {
+    units |= YEAR_UNIT;
+  }
+
+  return units;
+}
+
+void shim_run_until(time_t end) {
+  uint64_t endTime = (uint64_t)end * 1000;
+
+  while(now < endTime) {
+    uint64_t nextSecond = (now / 1000 + 1) * 1000;
+    AppTimer* timer = next_timer();
+
+    if(timer && timer->fireTime < nextSecond) {
+      now = MAX(now, timer->fireTime);
+      timer->scheduled = false;
+      timer->callback(timer->data);
+    } else {
+      time_t before = now / 1000;
+
+      now = nextSecond;
+
+      TimeUnits units = units_changed(before, now / 1000);
+
+      if(tickHandler && (units & tickUnits)) {
+        time_t seconds = now / 1000;
+
+        tickHandler(localtime(&seconds), units);
+      }
+    }
+
+    if(renderScheduled && topWindow) {
+      shim_render(topWindow);
+    }
+  }
+}
+
+// colors and geometry
+
+bool gcolor_equal(GColor8 x, GColor8 y) {
+  return x.argb == y.argb;
+}
+
+bool grect_equal(const GRect* const rect_a, const GRect* const rect_b) {
+  return rect_a->origin.x == rect_b->origin.x && rect_a->origin.y == rect_b->origin.y &&
+         rect_a->size.w == rect_b->size.w && rect_a->size.h == rect_b->size.h;
+}
+
+// layers
+
+Layer* layer_create_with_data(GRect frame, size_t data_size) {
+  Layer* layer = calloc(1, sizeof(Layer) + data_size);
+
+  layer->frame = frame;
+  layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+
+  return layer;
+}
+
+Layer* layer_create(GRect frame) {
+  return layer_create_with_data(frame, 0);
+}
+
+void layer_destroy(Layer* layer) {
+  if(layer) {
+    layer_remove_from_parent(layer);
+    free(layer);
+  }
+}
+
+void* layer_get_data(const Layer* layer) {
+  return (void*)layer->data;
+}
+
+void layer_set_update_proc(Layer* layer, LayerUpdateProc update_proc) {
+  layer->update_proc = update_proc;
+}
+
+void layer_mark_dirty(Layer* layer) {
+  renderScheduled = true;
+}
+
+void layer_add_child(Layer* parent, Layer* child) {
+  layer_remove_from_parent(child);
+  child->parent = parent;
+
+  Layer** last = &parent->first_child;
+
+  while(*last) {
+    last = &(*last)->next_sibling;
+  }
+
+  *last = child;
+  renderScheduled = true;
+}
+
+void layer_remove_from_parent(Layer* child) {
+  if(!child->parent) {
+    return;
+  }
+
+  for(Layer** sibling = &child->parent->first_child; *sibling; sibling = &(*sibling)->next_sibling) {
+    if(*sibling == child) {
+      *sibling = child->next_sibling;
+      break;
+    }
+  }
+
+  child->parent = NULL;
+  child->next_sibling = NULL;
+}
+
+void layer_set_frame(Layer* layer, GRect frame) {
+  if(!grect_equal(&layer->frame, &frame)) {
+    renderScheduled = true;
+  }
+
+  layer->frame = frame;
+  layer->bounds.size = frame.size;
+}
+
+GRect layer_get_frame(const Layer* layer) {
+  return layer->frame;
+}
+
+void layer_set_bounds(Layer* layer, GRect bounds) {
+  if(!grect_equal(&layer->bounds, &bounds)) {
+    renderScheduled = true;
+  }
+
+  layer->bounds = bounds;
+}
+
+GRect layer_get_bounds(const Layer* layer) {
+  return layer->bounds;
+}
+
+GPoint layer_convert_point_to_screen(const Layer* layer, GPoint point) {
+  for(const Layer* l = layer; l; l = l->parent) {
+    point.x += l->frame.origin.x + l->bounds.origin.x;
+    point.y += l->frame.origin.y + l->bounds.origin.y;
+  }
+
+  return point;
+}
+
+GRect layer_get_unobstructed_bounds(const Layer* layer) {
+  GPoint screenOrigin = layer_convert_point_to_screen(layer, layer->bounds.origin);
+  GRect screenBounds = GRect(screenOrigin.x, screenOrigin.y, layer->bounds.size.w, layer->bounds.size.h);
+  GRect unobstructed = grect_intersection(screenBounds,
+                                          GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT - shim_obstruction_height));
+
+  unobstructed.origin.x += layer->bounds.origin.x - screenOrigin.x;
+  unobstructed.origin.y += layer->bounds.origin.y - screenOrigin.y;
+
+  return unobstructed;
+}
+
+void layer_set_hidden(Layer* layer, bool hidden) {
+  if(layer->hidden != hidden) {
+    renderScheduled = true;
+  }
+
+  layer->hidden = hidden;
+}
+
+bool layer_get_hidden(const Layer* layer) {
+  return layer->hidden;
+}
+
+// windows
+
+Window* window_create(void) {
+  Window* window = calloc(1, sizeof(Window));
+
+  window->root_layer = layer_create(GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
+  window->background_color = GColorWhite;
+
+  return window;
+}
+
+void window_destroy(Window* window) {
+  if(topWindow == window) {
+    topWindow = NULL;
+  }
+
+  if(window->handlers.unload) {
+    window->handlers.unload(window);
+  }
+
+  layer_destroy(window->root_layer);
+  free(window);
+}
+
+void window_set_window_handlers(Window* window, WindowHandlers handlers) {
+  window->handlers = handlers;
+}
+
+void window_set_background_color(Window* window, GColor background_color) {
+  if(!gcolor_equal(window->background_color, background_color)) {
+    renderScheduled = true;
+  }
+
+  window->background_color = background_color;
+}
+
+Layer* window_get_root_layer(const Window* window) {
+  return window->root_layer;
+}
+
+void window_stack_push(Window* window, bool animated) {
+  topWindow = window;
+
+  if(window->handlers.load) {
+    window->handlers.load(window);
+  }
+
+  renderScheduled = true;
+}
+
+// bitmaps
+
+GBitmap* gbitmap_create_blank(GSize size, GBitmapFormat format) {
+  GBitmap* bitmap = malloc(sizeof(GBitmap));
+
+  bitmap->size = size;
+  bitmap->format = format;
+  bitmap->row_size = (format == GBitmapFormat1Bit) ? ((size.w + 31) / 32) * 4 : size.w;
+  bitmap->data = calloc(bitmap->row_size * size.h, 1);
+
+  return bitmap;
+}
+
+void gbitmap_destroy(GBitmap* bitmap) {
+  if(bitmap) {
+    free(bitmap->data);
+    free(bitmap);
+  }
+}
+
+uint8_t* gbitmap_get_data(const GBitmap* bitmap) {
+  return bitmap->data;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap* bitmap) {
+  return bitmap->row_size;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap* bitmap) {
+  return bitmap->format;
+}
+
+GRect gbitmap_get_bounds(const GBitmap* bitmap) {
+  return GRect(0, 0, bitmap->size.w, bitmap->size.h);
+}
+
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap* bitmap, uint16_t y) {
+  GBitmapDataRowInfo info = {
+    .data = bitmap->data + y * bitmap->row_size,
+    .min_x = 0,
+    .max_x = bitmap->size.w - 1
+  };
+
+  // only the pixels inside the circle exist on round displays
+  if(bitmap->format == GBitmapFormat8BitCircular) {
+    float radius = bitmap->size.w / 2.0f;
+    float dy = y + 0.5f - radius;
+    float halfWidth = sqrtf(MAX(radius * radius - dy * dy, 0));
+
+    info.min_x = (int16_t)floorf(radius - halfWidth);
+    info.max_x = (int16_t)ceilf(radius + halfWidth) - 1;
+  }
+
+  return info;
+}
+
+GBitmap* graphics_capture_frame_buffer(GContext* ctx) {
+  return ctx->frame_buffer;
+}
+
+bool graphics_release_frame_buffer(GContext* ctx, GBitmap* buffer) {
+  return true;
+}
+
+// fonts
+
+GFont fonts_get_system_font(const char* font_key) {
+  for(size_t i = 0; i < ARRAY_LENGTH(systemFonts); i++) {
+    if(strcmp(systemFonts[i].key, font_key) == 0) {
+      return &systemFonts[i];
+    }
+  }
+
+  return &systemFonts[0];
+}
+
+int16_t shim_font_height(GFont font) {
+  return font->height;
+}
+
+// resources
+
+ResHandle resource_get_handle(uint32_t resource_id) {
+  if(resource_id == 0 || resource_id >= RESOURCE_COUNT) {
+    return NULL;
+  }
+
+  struct ShimResource* resource = &resources[resource_id];
+
+  if(!resource->data) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", resourcePath, shim_resource_files[resource_id]);
+
+    FILE* file = fopen(path, "rb");
+
+    if(!file) {
+      fprintf(stderr, "can't open resource %s\n", path);
+      return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    resource->size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    resource->data = malloc(resource->size);
+    resource->size = fread(resource->data, 1, resource->size, file);
+    fclose(file);
+  }
+
+  return resource;
+}
+
+size_t resource_size(ResHandle h) {
+  return h ? h->size : 0;
+}
+
+size_t resource_load(ResHandle h, uint8_t* buffer, size_t max_length) {
+  if(!h) {
+    return 0;
+  }
+
+  size_t size = MIN(h->size, max_length);
+  memcpy(buffer, h->data, size);
+
+  return size;
+}
+
+// services: only the ticks and the timers happen, in shim_run_until()
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+  tickUnits = tick_units;
+  tickHandler = handler;
+}
+
+void tick_timer_service_unsubscribe(void) {
+  tickHandler = NULL;
+}
+
+BatteryChargeState battery_state_service_peek(void) {
+  return (BatteryChargeState) {
+    .charge_percent = 70,
+    .is_charging = false,
+    .is_plugged = false
+  };
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {}
+void battery_state_service_unsubscribe(void) {}
+
+bool bluetooth_connection_service_peek(void) {
+  return true;
+}
+
+void bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler) {}
+void bluetooth_connection_service_unsubscribe(void) {}
+
+void unobstructed_area_service_subscribe(UnobstructedAreaHandlers handlers, void* context) {}
+void unobstructed_area_service_unsubscribe(void) {}
+
+void app_focus_service_subscribe_handlers(AppFocusHandlers handlers) {}
+void app_focus_service_unsubscribe(void) {}
+
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void* callback_data) {
+  AppTimer* timer = malloc(sizeof(AppTimer));
+
+  timer->fireTime = now + timeout_ms;
+  timer->callback = callback;
+  timer->data = callback_data;
+  timer->scheduled = true;
+  timer->next = timers;
+  timers = timer;
+
+  return timer;
+}
+
+bool app_timer_reschedule(AppTimer* timer_handle, uint32_t new_timeout_ms) {
+  if(!timer_handle || !timer_handle->scheduled) {
+    return false;
+  }
+
+  timer_handle->fireTime = now + new_timeout_ms;
+
+  return true;
+}
+
+void app_timer_cancel(AppTimer* timer_handle) {
+  if(timer_handle) {
+    timer_handle->scheduled = false;
+  }
+}
+
+void vibes_short_pulse(void) {}
+void vibes_double_pulse(void) {}
+void vibes_enqueue_custom_pattern(VibePattern pattern) {}
+
+void app_event_loop(void) {}
+
+// time
+
+time_t shim_time(time_t* tloc) {
+  time_t seconds = now / 1000;
+
+  if(tloc) {
+    *tloc = seconds;
+  }
+
+  return seconds;
+}
+
+bool clock_is_24h_style(void) {
+  return true;
+}
+
+bool quiet_time_is_active(void) {
+  return false;
+}
+
+time_t time_start_of_today(void) {
+  time_t now = time(NULL);
+  struct tm* today = localtime(&now);
+
+  today->tm_hour = 0;
+  today->tm_min = 0;
+  today->tm_sec = 0;
+
+  return mktime(today);
+}
+
+uint16_t time_ms(time_t* tloc, uint16_t* out_ms) {
+  time(tloc);
+
+  if(out_ms) {
+    *out_ms = now % 1000;
+  }
+
+  return now % 1000;
+}
+
+// memory: report as much as the largest watch, so that nothing falls back
+
+size_t heap_bytes_free(void) {
+  return 64 * 1024;
+}
+
+size_t heap_bytes_used(void) {
+  return 0;
+}
+
+// persistent storage
+
+static PersistEntry* find_persist_entry(uint32_t key) {
+  for(int i = 0; i < persistCount; i++) {
+    if(persistEntries[i].key == key) {
+      return &persistEntries[i];
+    }
+  }
+
+  return NULL;
+}
+
+bool persist_exists(const uint32_t key) {
+  return find_persist_entry(key) != NULL;
+}
+
+int32_t persist_read_int(const uint32_t key) {
+  int32_t value = 0;
+  persist_read_data(key, &value, sizeof(value));
+
+  return value;
+}
+
+int persist_read_data(const uint32_t key, void* buffer, const size_t buffer_size) {
+  PersistEntry* entry = find_persist_entry(key);
+
+  if(!entry) {
+    return -1;
+  }
+
+  size_t size = MIN(entry->size, buffer_size);
+  memcpy(buffer, entry->data, size);
+
+  return size;
+}
+
+int persist_write_int(const uint32_t key, const int32_t value) {
+  return persist_write_data(key, &value, sizeof(value));
+}
+
+int persist_write_data(const uint32_t key, const void* data, const size_t size) {
+  PersistEntry* entry = find_persist_entry(key);
+
+  if(!entry) {
+    if(persistCount == PERSIST_MAX_KEYS) {
+      return -1;
+    }
+
+    entry = &persistEntries[persistCount++];
+    entry->key = key;
+  }
+
+  entry->size = MIN(size, PERSIST_DATA_MAX_LENGTH);
+  memcpy(entry->data, data, entry->size);
+
+  return entry->size;
+}
+
+int persist_delete(const uint32_t key) {
+  PersistEntry* entry = find_persist_entry(key);
+
+  if(entry) {
+    *entry = persistEntries[--persistCount];
+  }
+
+  return 0;
+}
+
+// app messages
+
+Tuple* dict_find(const DictionaryIterator* iter, const uint32_t key) {
+  return NULL;
+}
+
+Tuple* dict_read_first(DictionaryIterator* iter) {
+  return NULL;
+}
+
+Tuple* dict_read_next(DictionaryIterator* iter) {
+  return NULL;
+}
+
+uint32_t dict_size(DictionaryIterator* iter) {
+  return 0;
+}
+
+DictionaryResult dict_write_uint8(DictionaryIterator* iter, const uint32_t key, const uint8_t value) {
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_uint32(DictionaryIterator* iter, const uint32_t key, const uint32_t value) {
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_int32(DictionaryIterator* iter, const uint32_t key, const int32_t value) {
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_cstring(DictionaryIterator* iter, const uint32_t key, const char* const cstring) {
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator* iter, const uint32_t key, const uint8_t* const data,
+                                 const uint16_t size) {
+  return DICT_OK;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+  return NULL;
+}
+
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback) {
+  return NULL;
+}
+
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback) {
+  return NULL;
+}
+
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback) {
+  return NULL;
+}
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator** iterator) {
+  return APP_MSG_NOT_CONNECTED;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  return APP_MSG_NOT_CONNECTED;
+}
+
+// health
+
+HealthServiceAccessibilityMask health_service_metric_accessible(HealthMetric metric, time_t time_start, time_t time_end) {
+  return HealthServiceAccessibilityMaskAvailable;
+}
+
+HealthValue health_service_sum_today(HealthMetric metric) {
+  switch(metric) {
+    case HealthMetricStepCount:
+      return 8421;
+    case HealthMetricActiveSeconds:
+      return 3725;
+    case HealthMetricWalkedDistanceMeters:
+      return 6130;
+    case HealthMetricSleepSeconds:
+      return 27000;
+    case HealthMetricSleepRestfulSeconds:
+      return 9000;
+    case HealthMetricActiveKCalories:
+      return 412;
+    default:
+      return 0;
+  }
+}
+
+HealthValue health_service_peek_current_value(HealthMetric metric) {
+  return (metric == HealthMetricHeartRateBPM) ? 64 : 0;
+}
+
+HealthActivityMask health_service_peek_current_activities(void) {
+  return HealthActivityNone;
+}
+
+MeasurementSystem health_service_get_measurement_system_for_display(HealthMetric metric) {
+  return MeasurementSystemMetric;
+}
@@ -0,0 +1,85 @@
+#pragma once
+/*
+ * What the render benchmark driver needs from the SDK shim, on top of pebble.h:
+ * the recorded draw counters, and a way to render a window like PebbleOS does
+ */
+#include <pebble.h>
+
+typedef struct {
+  // every drawing primitive, including each command of a draw command image
+  uint32_t calls;
+
+  // points given to fctx paths and draw command paths
+  uint32_t points;
+
+  // pixels written to the frame buffer
+  uint32_t pixels;
+
+  // characters given to graphics_draw_text, whose pixels aren't counted
+  uint32_t textChars;
+
+  // renders of the whole window
+  uint32_t frames;
+} ShimCounters;
+
+extern ShimCounters shim_counters;
+
+// set by the driver to simulate the Timeline Quick View
+extern int16_t shim_obstruction_height;
+
+/*
+ * Loads the resources from the directory holding the files listed in package.json
+ */
+void shim_init(const char* resourceDirectory);
+void shim_deinit(void);
+
+void shim_reset_counters(void);
+
+/*
+ * Draws the whole layer tree of the window into the frame buffer: any dirty
+ * layer makes PebbleOS redraw everything, so this is what a frame costs
+ */
+void shim_render(Window* window);
+
+/*
+ * Advances the simulated time to end (the time starts frozen at shim_init()),
+ * calling the timers and the tick handler when they are due. After each of
+ * them, the window on top of the stack is rendered if a layer was marked
+ * dirty, moved or hidden, like PebbleOS does
+ */
+void shim_run_until(time_t end);
+
+/*
+ * Shared by the shim files
+ */
+struct GContext {
+  GColor fill_color;
+  GColor stroke_color;
+  GColor text_color;
+  GCompOp compositing_mode;
+  uint8_t stroke_width;
+  bool antialiased;
+
+  // screen position of the bounds origin of the layer being drawn, and its clip
+  GPoint offset;
+  GRect clip;
+
+  GBitmap* frame_buffer;
+};
+
+// the fixed point scale of fctx
+#define SHIM_FIXED_SCALE 16
+
+// fills the pixels whose center is inside the polygons (non-zero rule),
+// the points are in fixed point (1/16 pixel) screen coordinates
+typedef struct {
+  int32_t x;
+  int32_t y;
+} ShimPoint;
+
+void shim_fill_polygons(GContext* ctx, const ShimPoint* points, const uint16_t* contour_ends,
+                        uint16_t contour_count, GColor color);
+
+void shim_put_pixel(GContext* ctx, int x, int y, GColor color);
+
+int16_t shim_font_height(GFont font);
@@ -0,0 +1,363 @@
+#include <pebble.h>
+#include <pebble-fctx/fctx.h>
+#include <pebble-fctx/ffont.h>
+#include "shim.h"
+
+/*
+ * pebble-fctx stand-in of the SDK shim: paths are transformed like fctx does,
+ * curves are flattened, and the outline is filled by the shim rasterizer
+ * without antialiasing. Each fill counts as one call, with the points of its
+ * flattened outline
+ */
+
+// curves are split in this many lines
+#define CURVE_SEGMENTS 8
+
+// same layout as the ffont resources read by glyph_cache.c
+typedef struct __attribute__((__packed__)) {
+  uint16_t unitsPerEm;
+  int16_t ascent;
+  int16_t descent;
+  int16_t capHeight;
+  uint16_t rangeCount;
+  uint16_t glyphCount;
+} FontFileHeader;
+
+typedef struct __attribute__((__packed__)) {
+  uint16_t start;
+  uint16_t end;
+} FontFileRange;
+
+typedef struct __attribute__((__packed__)) {
+  uint16_t pathDataOffset;
+  uint16_t pathDataLength;
+  int16_t horizAdvX;
+} FontFileGlyph;
+
+struct FFont {
+  uint8_t* data;
+  size_t size;
+  const FontFileHeader* header;
+  const FontFileRange* ranges;
+  const FontFileGlyph* glyphs;
+  const uint8_t* pathData;
+};
+
+static bool aaEnabled = true;
+
+// fonts
+
+FFont* ffont_create_from_resource(uint32_t resource_id) {
+  ResHandle handle = resource_get_handle(resource_id);
+  size_t size = resource_size(handle);
+
+  if(size < sizeof(FontFileHeader)) {
+    return NULL;
+  }
+
+  FFont* font = malloc(sizeof(FFont));
+
+  font->data = malloc(size);
+  font->size = resource_load(handle, font->data, size);
+  font->header = (const FontFileHeader*)font->data;
+  font->ranges = (const FontFileRange*)(font->header + 1);
+  font->glyphs = (const FontFileGlyph*)(font->ranges + font->header->rangeCount);
+  font->pathData = (const uint8_t*)(font->glyphs + font->header->glyphCount);
+
+  return font;
+}
+
+void ffont_destroy(FFont* font) {
+  if(font) {
+    free(font->data);
+    free(font);
+  }
+}
+
+static const FontFileGlyph* find_glyph(const FFont* font, uint16_t codePoint) {
+  int glyphIndex = 0;
+
+  for(int i = 0; i < font->header->rangeCount; i++) {
+    if(codePoint >= font->ranges[i].start && codePoint < font->ranges[i].end) {
+      glyphIndex += codePoint - font->ranges[i].start;
+
+      return (glyphIndex < font->header->glyphCount) ? &font->glyphs[glyphIndex] : NULL;
+    }
+
+    glyphIndex += font->ranges[i].end - font->ranges[i].start;
+  }
+
+  return NULL;
+}
+
+// context
+
+void fctx_enable_aa(bool enable) {
+  aaEnabled = enable;
+}
+
+bool fctx_is_aa_enabled(void) {
+  return aaEnabled;
+}
+
+void fctx_init_context(FContext* fctx, GContext* gctx) {
+  memset(fctx, 0, sizeof(FContext));
+
+  fctx->gctx = gctx;
+  fctx->fill_color = GColorBlack;
+  fctx->transform_scale_from = FPointOne;
+  fctx->transform_scale_to = FPointOne;
+}
+
+void fctx_deinit_context(FContext* fctx) {
+  free(fctx->points);
+  free(fctx->contour_ends);
+  fctx->points = NULL;
+  fctx->contour_ends = NULL;
+}
+
+void fctx_set_fill_color(FContext* fctx, GColor c) {
+  fctx->fill_color = c;
+}
+
+void fctx_set_offset(FContext* fctx, FPoint offset) {
+  fctx->transform_offset = offset;
+}
+
+void fctx_set_scale(FContext* fctx, FPoint scale_from, FPoint scale_to) {
+  fctx->transform_scale_from = scale_from;
+  fctx->transform_scale_to = scale_to;
+}
+
+// paths
+
+static FPoint transform(const FContext* fctx, FPoint p) {
+  return FPoint(
+    (int64_t)p.x * fctx->transform_scale_to.x / fctx->transform_scale_from.x + fctx->transform_offset.x,
+    (int64_t)p.y * fctx->transform_scale_to.y / fctx->transform_scale_from.y + fctx->transform_offset.y);
+}
+
+static void add_point(FContext* fctx, FPoint p) {
+  if(fctx->point_count == fctx->point_capacity) {
+    fctx->point_capacity = fctx->point_capacity ? fctx->point_capacity * 2 : 64;
+    fctx->points = realloc(fctx->points, fctx->point_capacity * sizeof(FPoint));
+  }
+
+  fctx->points[fctx->point_count++] = p;
+}
+
+static void end_contour(FContext* fctx) {
+  uint16_t start = fctx->contour_count ? fctx->contour_ends[fctx->contour_count - 1] : 0;
+
+  if(fctx->point_count == start) {
+    return;
+  }
+
+  if(fctx->contour_count == fctx->contour_capacity) {
+    fctx->contour_capacity = fctx->contour_capacity ? fctx->contour_capacity * 2 : 8;
+    fctx->contour_ends = realloc(fctx->contour_ends, fctx->contour_capacity * sizeof(uint16_t));
+  }
+
+  fctx->contour_ends[fctx->contour_count++] = fctx->point_count;
+}
+
+void fctx_begin_fill(FContext* fctx) {
+  fctx->point_count = 0;
+  fctx->contour_count = 0;
+}
+
+void fctx_move_to(FContext* fctx, FPoint p) {
+  end_contour(fctx);
+  add_point(fctx, transform(fctx, p));
+}
+
+void fctx_line_to(FContext* fctx, FPoint p) {
+  add_point(fctx, transform(fctx, p));
+}
+
+void fctx_quadratic_to(FContext* fctx, FPoint cp, FPoint p) {
+  FPoint p0 = fctx->points[fctx->point_count - 1];
+  FPoint p1 = transform(fctx, cp);
+  FPoint p2 = transform(fctx, p);
+
+  for(int i = 1; i <= CURVE_SEGMENTS; i++) {
+    int32_t t = i, u = CURVE_SEGMENTS - i, n = CURVE_SEGMENTS * CURVE_SEGMENTS;
+
+    add_point(fctx, FPoint((u * u * p0.x + 2 * u * t * p1.x + t * t * p2.x) / n,
+                           (u * u * p0.y + 2 * u * t * p1.y + t * t * p2.y) / n));
+  }
+}
+
+void fctx_curve_to(FContext* fctx, FPoint cp0, FPoint cp1, FPoint p) {
+  FPoint p0 = fctx->points[fctx->point_count - 1];
+  FPoint p1 = transform(fctx, cp0);
+  FPoint p2 = transform(fctx, cp1);
+  FPoint p3 = transform(fctx, p);
+
+  for(int i = 1; i <= CURVE_SEGMENTS; i++) {
+    int64_t t = i, u = CURVE_SEGMENTS - i, n = CURVE_SEGMENTS * CURVE_SEGMENTS * CURVE_SEGMENTS;
+
+    add_point(fctx, FPoint((u * u * u * p0.x + 3 * u * u * t * p1.x + 3 * u * t * t * p2.x + t * t * t * p3.x) / n,
+                           (u * u * u * p0.y + 3 * u * u * t * p1.y + 3 * u * t * t * p2.y + t * t * t * p3.y) / n));
+  }
+}
+
+void fctx_close_path(FContext* fctx) {
+  end_contour(fctx);
+}
+
+void fctx_end_fill(FContext* fctx) {
+  end_contour(fctx);
+
+  if(fctx->contour_count == 0) {
+    return;
+  }
+
+  shim_counters.calls++;
+  shim_counters.points += fctx->point_count;
+
+  // fctx coordinates are relative to the layer being drawn
+  GPoint offset = fctx->gctx->offset;
+
+  for(uint16_t i = 0; i < fctx->point_count; i++) {
+    fctx->points[i].x += INT_TO_FIXED(offset.x);
+    fctx->points[i].y += INT_TO_FIXED(offset.y);
+  }
+
+  shim_fill_polygons(fctx->gctx, (const ShimPoint*)fctx->points, fctx->contour_ends, fctx->contour_count,
+                     fctx->fill_color);
+
+  fctx->point_count = 0;
+  fctx->contour_count = 0;
+}
+
+// text
+
+void fctx_set_text_em_height(FContext* fctx, FFont* font, int16_t pixels) {
+  // font units have y going up
+  fctx->transform_scale_from = FPoint(font->header->unitsPerEm, -font->header->unitsPerEm);
+  fctx->transform_scale_to = FPoint(pixels, pixels);
+}
+
+static int16_t read_int16(const uint8_t* data) {
+  return (int16_t)(data[0] | (data[1] << 8));
+}
+
+fixed_t fctx_string_width(FContext* fctx, const char* text, FFont* font) {
+  fixed_t width = 0;
+
+  for(const char* c = text; *c != '\0'; c++) {
+    const FontFileGlyph* glyph = find_glyph(font, (uint8_t)*c);
+
+    if(glyph) {
+      width += INT_TO_FIXED(glyph->horizAdvX);
+    }
+  }
+
+  return width;
+}
+
+static void draw_glyph(FContext* fctx, FFont* font, const FontFileGlyph* glyph, FPoint origin) {
+  const uint8_t* cmd = font->pathData + glyph->pathDataOffset;
+  const uint8_t* end = cmd + glyph->pathDataLength;
+  FPoint current = FPointZero;
+  FPoint control = FPointZero;
+  bool previousWasCurve = false;
+
+  while(cmd + 2 <= end) {
+    uint16_t code = (uint16_t)read_int16(cmd);
+    bool isCurve = false;
+
+    cmd += 2;
+
+    switch(code) {
+      case 'M':
+      case 'L':
+        current = FPointI(read_int16(cmd), read_int16(cmd + 2));
+        cmd += 4;
+
+        if(code == 'M') {
+          fctx_move_to(fctx, FPoint(origin.x + current.x, origin.y + current.y));
+        } else {
+          fctx_line_to(fctx, FPoint(origin.x + current.x, origin.y + current.y));
+        }
+        break;
+      case 'H':
+        current.x = INT_TO_FIXED(read_int16(cmd));
+        cmd += 2;
+        fctx_line_to(fctx, FPoint(origin.x + current.x, origin.y + current.y));
+        break;
+      case 'V':
+        current.y = INT_TO_FIXED(read_int16(cmd));
+        cmd += 2;
+        fctx_line_to(fctx, FPoint(origin.x + current.x, origin.y + current.y));
+        break;
+      case 'Q':
+      case 'T':
+        if(code == 'Q') {
+          control = FPointI(read_int16(cmd), read_int16(cmd + 2));
+          cmd += 4;
+        } else if(previousWasCurve) {
+          control = FPoint(2 * current.x - control.x, 2 * current.y - control.y);
+        } else {
+          control = current;
+        }
+
+        current = FPointI(read_int16(cmd), read_int16(cmd + 2));
+        cmd += 4;
+        isCurve = true;
+
+        fctx_quadratic_to(fctx, FPoint(origin.x + control.x, origin.y + control.y),
+                          FPoint(origin.x + current.x, origin.y + current.y));
+        break;
+      case 'Z':
+        fctx_close_path(fctx);
+        break;
+      default:
+        return;
+    }
+
+    previousWasCurve = isCurve;
+  }
+}
+
+void fctx_draw_string(FContext* fctx, const char* text, FFont* font, GTextAlignment alignment, FTextAnchor anchor) {
+  // in font units, with y going up
+  FPoint origin = FPointZero;
+  fixed_t width = fctx_string_width(fctx, text, font);
+
+  if(alignment == GTextAlignmentCenter) {
+    origin.x = -width / 2;
+  } else if(alignment == GTextAlignmentRight) {
+    origin.x = -width;
+  }
+
+  switch(anchor) {
+    case FTextAnchorTop:
+      origin.y = -INT_TO_FIXED(font->header->ascent);
+      break;
+    case FTextAnchorMiddle:
+      origin.y = -INT_TO_FIXED(font->header->ascent + font->header->descent) / 2;
+      break;
+    case FTextAnchorBottom:
+      origin.y = -INT_TO_FIXED(font->header->descent);
+      break;
+    case FTextAnchorCapTop:
+      origin.y = -INT_TO_FIXED(font->header->capHeight);
+      break;
+    case FTextAnchorCapMiddle:
+      origin.y = -INT_TO_FIXED(font->header->capHeight) / 2;
+      break;
+    default: // FTextAnchorBaseline
+      break;
+  }
+
+  for(const char* c = text; *c != '\0'; c++) {
+    const FontFileGlyph* glyph = find_glyph(font, (uint8_t)*c);
+
+    if(glyph) {
+      draw_glyph(fctx, font, glyph, origin);
+      origin.x += INT_TO_FIXED(glyph->horizAdvX);
+    }
+  }
+}
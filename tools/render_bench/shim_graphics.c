@@ -0,0 +1,506 @@
+#include <pebble.h>
+#include <math.h>
+#include "shim.h"
+
+/*
+ * Drawing primitives of the SDK shim. Everything is drawn without antialiasing
+ * into an 8 bit frame buffer (like the color watches), and each primitive
+ * counts as a call. Strokes are drawn as squares along the line, so their
+ * pixel counts are only estimates
+ */
+
+// the packed draw command format, as found in the .pdc resources
+typedef struct __attribute__((__packed__)) {
+  int16_t x;
+  int16_t y;
+} PackedPoint;
+
+struct __attribute__((__packed__)) GDrawCommand {
+  uint8_t type;
+  uint8_t flags;
+  GColor8 stroke_color;
+  uint8_t stroke_width;
+  GColor8 fill_color;
+  uint16_t path_open_radius;
+  uint16_t num_points;
+  PackedPoint points[];
+};
+
+struct __attribute__((__packed__)) GDrawCommandList {
+  uint16_t num_commands;
+  struct GDrawCommand commands[];
+};
+
+struct __attribute__((__packed__)) GDrawCommandImage {
+  uint8_t version;
+  uint8_t reserved;
+  GSize view_box;
+  struct GDrawCommandList command_list;
+};
+
+enum {
+  DRAW_COMMAND_PATH = 1,
+  DRAW_COMMAND_CIRCLE = 2,
+  DRAW_COMMAND_PRECISE_PATH = 3
+};
+
+#define DRAW_COMMAND_HIDDEN 0x01
+
+// "PDCI" followed by the size of the image
+#define PDC_HEADER_SIZE 8
+
+typedef struct {
+  int32_t x;
+  int8_t winding;
+} Crossing;
+
+// context
+
+void graphics_context_set_fill_color(GContext* ctx, GColor color) {
+  ctx->fill_color = color;
+}
+
+void graphics_context_set_stroke_color(GContext* ctx, GColor color) {
+  ctx->stroke_color = color;
+}
+
+void graphics_context_set_text_color(GContext* ctx, GColor color) {
+  ctx->text_color = color;
+}
+
+void graphics_context_set_compositing_mode(GContext* ctx, GCompOp mode) {
+  ctx->compositing_mode = mode;
+}
+
+void graphics_context_set_antialiased(GContext* ctx, bool enable) {
+  ctx->antialiased = enable;
+}
+
+void graphics_context_set_stroke_width(GContext* ctx, uint8_t stroke_width) {
+  ctx->stroke_width = stroke_width;
+}
+
+// pixels
+
+void shim_put_pixel(GContext* ctx, int x, int y, GColor color) {
+  GRect clip = ctx->clip;
+
+  if(x < clip.origin.x || x >= clip.origin.x + clip.size.w || y < clip.origin.y || y >= clip.origin.y + clip.size.h) {
+    return;
+  }
+
+  GBitmapDataRowInfo row = gbitmap_get_data_row_info(ctx->frame_buffer, y);
+
+  if(x < row.min_x || x > row.max_x) {
+    return;
+  }
+
+  row.data[x] = color.argb;
+  shim_counters.pixels++;
+}
+
+static int compare_crossings(const void* a, const void* b) {
+  return ((const Crossing*)a)->x - ((const Crossing*)b)->x;
+}
+
+void shim_fill_polygons(GContext* ctx, const ShimPoint* points, const uint16_t* contour_ends,
+                        uint16_t contour_count, GColor color) {
+  uint16_t point_count = contour_count ? contour_ends[contour_count - 1] : 0;
+
+  if(point_count < 3 || color.a == 0) {
+    return;
+  }
+
+  int32_t minY = points[0].y;
+  int32_t maxY = points[0].y;
+
+  for(uint16_t i = 1; i < point_count; i++) {
+    minY = MIN(minY, points[i].y);
+    maxY = MAX(maxY, points[i].y);
+  }
+
+  int top = MAX(minY / SHIM_FIXED_SCALE - 1, ctx->clip.origin.y);
+  int bottom = MIN(maxY / SHIM_FIXED_SCALE + 1, ctx->clip.origin.y + ctx->clip.size.h - 1);
+  Crossing* crossings = malloc(point_count * sizeof(Crossing));
+
+  for(int y = top; y <= bottom; y++) {
+    // sample at the center of the pixels
+    int32_t sampleY = y * SHIM_FIXED_SCALE + SHIM_FIXED_SCALE / 2;
+    int crossingCount = 0;
+    uint16_t start = 0;
+
+    for(uint16_t c = 0; c < contour_count; c++) {
+      uint16_t end = contour_ends[c];
+
+      for(uint16_t i = start; i < end; i++) {
+        ShimPoint p0 = points[i];
+        ShimPoint p1 = points[(i + 1 < end) ? i + 1 : start];
+
+        if((p0.y <= sampleY) == (p1.y <= sampleY)) {
+          continue;
+        }
+
+        crossings[crossingCount].x = p0.x + (int64_t)(sampleY - p0.y) * (p1.x - p0.x) / (p1.y - p0.y);
+        crossings[crossingCount].winding = (p1.y > p0.y) ? 1 : -1;
+        crossingCount++;
+      }
+
+      start = end;
+    }
+
+    qsort(crossings, crossingCount, sizeof(Crossing), compare_crossings);
+
+    int winding = 0;
+
+    for(int i = 0; i < crossingCount - 1; i++) {
+      winding += crossings[i].winding;
+
+      if(winding != 0) {
+        // pixels whose center is between the crossings
+        int left = (crossings[i].x + SHIM_FIXED_SCALE / 2 - 1) / SHIM_FIXED_SCALE;
+        int right = (crossings[i + 1].x + SHIM_FIXED_SCALE / 2 - 1) / SHIM_FIXED_SCALE;
+
+        for(int x = left; x < right; x++) {
+          shim_put_pixel(ctx, x, y, color);
+        }
+      }
+    }
+  }
+
+  free(crossings);
+}
+
+// primitives
+
+void graphics_fill_rect(GContext* ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+  shim_counters.calls++;
+
+  int left = ctx->offset.x + rect.origin.x;
+  int top = ctx->offset.y + rect.origin.y;
+
+  for(int y = top; y < top + rect.size.h; y++) {
+    for(int x = left; x < left + rect.size.w; x++) {
+      shim_put_pixel(ctx, x, y, ctx->fill_color);
+    }
+  }
+}
+
+void graphics_fill_radial(GContext* ctx, GRect rect, GOvalScaleMode scale_mode, uint16_t inset_thickness,
+                          int32_t angle_start, int32_t angle_end) {
+  shim_counters.calls++;
+
+  float outer = MIN(rect.size.w, rect.size.h) / 2.0f;
+  float inner = MAX(outer - inset_thickness, 0);
+  float centerX = ctx->offset.x + rect.origin.x + rect.size.w / 2.0f;
+  float centerY = ctx->offset.y + rect.origin.y + rect.size.h / 2.0f;
+  float start = angle_start * 2 * M_PI / TRIG_MAX_ANGLE;
+  float end = angle_end * 2 * M_PI / TRIG_MAX_ANGLE;
+
+  for(int y = (int)(centerY - outer); y < (int)ceilf(centerY + outer); y++) {
+    for(int x = (int)(centerX - outer); x < (int)ceilf(centerX + outer); x++) {
+      float dx = x + 0.5f - centerX;
+      float dy = y + 0.5f - centerY;
+      float distance = sqrtf(dx * dx + dy * dy);
+
+      if(distance > outer || distance < inner) {
+        continue;
+      }
+
+      // trig angles start at the top and go clockwise
+      float angle = atan2f(dx, -dy);
+
+      if(angle < 0) {
+        angle += 2 * M_PI;
+      }
+
+      if(angle >= start && angle <= end) {
+        shim_put_pixel(ctx, x, y, ctx->fill_color);
+      }
+    }
+  }
+}
+
+static void fill_circle(GContext* ctx, float centerX, float centerY, float radius, GColor color) {
+  for(int y = (int)floorf(centerY - radius); y <= (int)ceilf(centerY + radius); y++) {
+    for(int x = (int)floorf(centerX - radius); x <= (int)ceilf(centerX + radius); x++) {
+      float dx = x + 0.5f - centerX;
+      float dy = y + 0.5f - centerY;
+
+      if(dx * dx + dy * dy <= radius * radius) {
+        shim_put_pixel(ctx, x, y, color);
+      }
+    }
+  }
+}
+
+void graphics_fill_circle(GContext* ctx, GPoint p, uint16_t radius) {
+  shim_counters.calls++;
+  fill_circle(ctx, ctx->offset.x + p.x + 0.5f, ctx->offset.y + p.y + 0.5f, radius + 0.5f, ctx->fill_color);
+}
+
+// screen coordinates
+static void stroke_line(GContext* ctx, GPoint p0, GPoint p1, uint8_t width, GColor color) {
+  int dx = abs(p1.x - p0.x);
+  int dy = -abs(p1.y - p0.y);
+  int sx = (p0.x < p1.x) ? 1 : -1;
+  int sy = (p0.y < p1.y) ? 1 : -1;
+  int error = dx + dy;
+  int half = (width - 1) / 2;
+
+  for(;;) {
+    for(int y = p0.y - half; y < p0.y - half + MAX(width, 1); y++) {
+      for(int x = p0.x - half; x < p0.x - half + MAX(width, 1); x++) {
+        shim_put_pixel(ctx, x, y, color);
+      }
+    }
+
+    if(p0.x == p1.x && p0.y == p1.y) {
+      break;
+    }
+
+    int error2 = 2 * error;
+
+    if(error2 >= dy) {
+      error += dy;
+      p0.x += sx;
+    }
+
+    if(error2 <= dx) {
+      error += dx;
+      p0.y += sy;
+    }
+  }
+}
+
+void graphics_draw_line(GContext* ctx, GPoint p0, GPoint p1) {
+  shim_counters.calls++;
+  stroke_line(ctx, GPoint(ctx->offset.x + p0.x, ctx->offset.y + p0.y),
+              GPoint(ctx->offset.x + p1.x, ctx->offset.y + p1.y), ctx->stroke_width, ctx->stroke_color);
+}
+
+void graphics_draw_rect(GContext* ctx, GRect rect) {
+  int16_t right = rect.origin.x + rect.size.w - 1;
+  int16_t bottom = rect.origin.y + rect.size.h - 1;
+
+  graphics_draw_line(ctx, rect.origin, GPoint(right, rect.origin.y));
+  graphics_draw_line(ctx, GPoint(right, rect.origin.y), GPoint(right, bottom));
+  graphics_draw_line(ctx, GPoint(right, bottom), GPoint(rect.origin.x, bottom));
+  graphics_draw_line(ctx, GPoint(rect.origin.x, bottom), rect.origin);
+}
+
+void graphics_draw_bitmap_in_rect(GContext* ctx, const GBitmap* bitmap, GRect rect) {
+  shim_counters.calls++;
+
+  GRect bounds = gbitmap_get_bounds(bitmap);
+  GBitmapFormat format = gbitmap_get_format(bitmap);
+  int width = MIN(rect.size.w, bounds.size.w);
+  int height = MIN(rect.size.h, bounds.size.h);
+
+  for(int y = 0; y < height; y++) {
+    GBitmapDataRowInfo row = gbitmap_get_data_row_info(bitmap, y);
+
+    for(int x = 0; x < width; x++) {
+      GColor color;
+
+      if(format == GBitmapFormat1Bit) {
+        color = (row.data[x / 8] & (1 << (x % 8))) ? GColorWhite : GColorBlack;
+      } else {
+        color.argb = row.data[x];
+      }
+
+      // only GCompOpSet skips the transparent pixels
+      if(ctx->compositing_mode != GCompOpSet || color.a != 0) {
+        shim_put_pixel(ctx, ctx->offset.x + rect.origin.x + x, ctx->offset.y + rect.origin.y + y, color);
+      }
+    }
+  }
+}
+
+// text isn't rasterized, only counted
+
+void graphics_draw_text(GContext* ctx, const char* text, GFont const font, const GRect box,
+                        const GTextOverflowMode overflow_mode, const GTextAlignment alignment,
+                        GTextAttributes* text_attributes) {
+  shim_counters.calls++;
+  shim_counters.textChars += strlen(text);
+}
+
+GSize graphics_text_layout_get_content_size(const char* text, GFont const font, const GRect box,
+                                            const GTextOverflowMode overflow_mode, const GTextAlignment alignment) {
+  // a rough average for the gothic fonts
+  int16_t height = shim_font_height(font);
+  int16_t width = strlen(text) * height / 2;
+
+  return GSize(MIN(width, box.size.w), height);
+}
+
+// draw commands
+
+GDrawCommandImage* gdraw_command_image_create_with_resource(uint32_t resource_id) {
+  ResHandle handle = resource_get_handle(resource_id);
+  size_t size = resource_size(handle);
+
+  if(size <= PDC_HEADER_SIZE) {
+    return NULL;
+  }
+
+  uint8_t* data = malloc(size);
+  resource_load(handle, data, size);
+
+  GDrawCommandImage* image = malloc(size - PDC_HEADER_SIZE);
+  memcpy(image, data + PDC_HEADER_SIZE, size - PDC_HEADER_SIZE);
+  free(data);
+
+  return image;
+}
+
+static size_t command_size(const GDrawCommand* command) {
+  return sizeof(GDrawCommand) + command->num_points * sizeof(PackedPoint);
+}
+
+static size_t image_size(const GDrawCommandImage* image) {
+  const GDrawCommand* command = image->command_list.commands;
+
+  for(uint16_t i = 0; i < image->command_list.num_commands; i++) {
+    command = (const GDrawCommand*)((const uint8_t*)command + command_size(command));
+  }
+
+  return (const uint8_t*)command - (const uint8_t*)image;
+}
+
+GDrawCommandImage* gdraw_command_image_clone(GDrawCommandImage* image) {
+  size_t size = image_size(image);
+  GDrawCommandImage* clone = malloc(size);
+
+  memcpy(clone, image, size);
+
+  return clone;
+}
+
+void gdraw_command_image_destroy(GDrawCommandImage* image) {
+  free(image);
+}
+
+GSize gdraw_command_image_get_bounds_size(GDrawCommandImage* image) {
+  return image->view_box;
+}
+
+GDrawCommandList* gdraw_command_image_get_command_list(GDrawCommandImage* image) {
+  return &image->command_list;
+}
+
+bool gdraw_command_list_iterate(GDrawCommandList* command_list, GDrawCommandListIteratorCb handle_command,
+                                void* callback_context) {
+  GDrawCommand* command = command_list->commands;
+
+  for(uint16_t i = 0; i < command_list->num_commands; i++) {
+    if(!handle_command(command, i, callback_context)) {
+      return false;
+    }
+
+    command = (GDrawCommand*)((uint8_t*)command + command_size(command));
+  }
+
+  return true;
+}
+
+void gdraw_command_set_fill_color(GDrawCommand* command, GColor fill_color) {
+  command->fill_color = fill_color;
+}
+
+void gdraw_command_set_stroke_color(GDrawCommand* command, GColor stroke_color) {
+  command->stroke_color = stroke_color;
+}
+
+// path points are pixel centers, precise points are in 1/8 pixels
+static ShimPoint command_point(const GDrawCommand* command, uint16_t i, GPoint offset) {
+  PackedPoint p = command->points[i];
+
+  if(command->type == DRAW_COMMAND_PRECISE_PATH) {
+    return (ShimPoint) {
+      offset.x * SHIM_FIXED_SCALE + p.x * 2,
+      offset.y * SHIM_FIXED_SCALE + p.y * 2
+    };
+  }
+
+  return (ShimPoint) {
+    (offset.x + p.x) * SHIM_FIXED_SCALE + SHIM_FIXED_SCALE / 2,
+    (offset.y + p.y) * SHIM_FIXED_SCALE + SHIM_FIXED_SCALE / 2
+  };
+}
+
+static void draw_path(GContext* ctx, const GDrawCommand* command, GPoint offset) {
+  uint16_t count = command->num_points;
+  ShimPoint* points = malloc(MAX(count, 1) * sizeof(ShimPoint));
+
+  for(uint16_t i = 0; i < count; i++) {
+    points[i] = command_point(command, i, offset);
+  }
+
+  shim_fill_polygons(ctx, points, &count, 1, command->fill_color);
+
+  if(command->stroke_width > 0 && command->stroke_color.a != 0) {
+    bool open = command->path_open_radius != 0;
+
+    for(uint16_t i = 0; i + 1 < count + (open ? 0 : 1); i++) {
+      ShimPoint p0 = points[i];
+      ShimPoint p1 = points[(i + 1) % count];
+
+      stroke_line(ctx, GPoint(p0.x / SHIM_FIXED_SCALE, p0.y / SHIM_FIXED_SCALE),
+                  GPoint(p1.x / SHIM_FIXED_SCALE, p1.y / SHIM_FIXED_SCALE),
+                  command->stroke_width, command->stroke_color);
+    }
+  }
+
+  free(points);
+}
+
+static void draw_circle(GContext* ctx, const GDrawCommand* command, GPoint offset) {
+  float radius = command->path_open_radius;
+
+  for(uint16_t i = 0; i < command->num_points; i++) {
+    float centerX = offset.x + command->points[i].x + 0.5f;
+    float centerY = offset.y + command->points[i].y + 0.5f;
+
+    if(command->fill_color.a != 0) {
+      fill_circle(ctx, centerX, centerY, radius, command->fill_color);
+    }
+
+    if(command->stroke_width > 0 && command->stroke_color.a != 0) {
+      float half = command->stroke_width / 2.0f;
+
+      for(int y = (int)floorf(centerY - radius - half); y <= (int)ceilf(centerY + radius + half); y++) {
+        for(int x = (int)floorf(centerX - radius - half); x <= (int)ceilf(centerX + radius + half); x++) {
+          float dx = x + 0.5f - centerX;
+          float dy = y + 0.5f - centerY;
+
+          if(fabsf(sqrtf(dx * dx + dy * dy) - radius) <= half) {
+            shim_put_pixel(ctx, x, y, command->stroke_color);
+          }
+        }
+      }
+    }
+  }
+}
+
+void gdraw_command_image_draw(GContext* ctx, GDrawCommandImage* image, GPoint offset) {
+  GDrawCommand* command = image->command_list.commands;
+
+  offset.x += ctx->offset.x;
+  offset.y += ctx->offset.y;
+
+  for(uint16_t i = 0; i < image->command_list.num_commands; i++) {
+    if(!(command->flags & DRAW_COMMAND_HIDDEN)) {
+      shim_counters.calls++;
+      shim_counters.points += command->num_points;
+
+      if(command->type == DRAW_COMMAND_CIRCLE) {
+        draw_circle(ctx, command, offset);
+      } else {
+        draw_path(ctx, command, offset);
+      }
+    }
+
+    command = (GDrawCommand*)((uint8_t*)command + command_size(command));
+  }
+}
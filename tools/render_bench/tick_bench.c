@@ -0,0 +1,76 @@
+/*
+ * Runs the whole watchface, main.c included, for a while of simulated time, and
+ * reports how many frames its ticks and timers cause and what they cost. The
+ * shim renders the whole window whenever a layer was marked dirty, like
+ * PebbleOS, so this is what the watchface actually draws in a minute.
+ *
+ * main.c is compiled here, with its main() renamed, so that its static init(),
+ * redrawScreen() and deinit() can drive it
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wreturn-type"
+#define main watchface_main
+#include "../../src/c/main.c"
+#undef main
+#pragma GCC diagnostic pop
+
+#include "shim.h"
+#include "tick_bench.h"
+
+// the sidebar widgets of each scenario
+typedef struct {
+  const char* name;
+  BarLocationType location;
+  SidebarWidgetType widgets[3];
+} TickScenario;
+
+static const TickScenario scenarios[] = {
+  { "no_sidebar", NONE, { EMPTY, EMPTY, EMPTY } },
+  { "date_battery", LEFT, { DATE, EMPTY, BATTERY_METER } },
+  { "seconds", LEFT, { SECONDS, DATE, BATTERY_METER } },
+  { "beats", LEFT, { BEATS, DATE, BATTERY_METER } },
+};
+
+static void run_scenario(const TickScenario* scenario, int minutes) {
+  globalSettings.sidebarLocation = scenario->location;
+
+  for(int i = 0; i < 3; i++) {
+    globalSettings.widgets[i] = scenario->widgets[i];
+  }
+
+  Settings_updateDynamicSettings();
+  redrawScreen();
+
+  // the first minute settles the services and fills the caches
+  shim_run_until(time(NULL) + SECONDS_PER_MINUTE);
+  shim_reset_counters();
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  shim_run_until(time(NULL) + minutes * SECONDS_PER_MINUTE);
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+  uint32_t frames = shim_counters.frames;
+
+  printf("%s,%.1f,%.1f,%.0f,%.0f\n",
+         scenario->name,
+         (double)frames / minutes,
+         us / minutes,
+         (double)shim_counters.pixels / minutes,
+         frames ? (double)shim_counters.pixels / frames : 0);
+}
+
+void tick_bench_run(int minutes) {
+  init();
+
+  printf("scenario,frames_per_minute,us_per_minute,pixels_per_minute,pixels_per_frame\n");
+
+  for(size_t i = 0; i < ARRAY_LENGTH(scenarios); i++) {
+    run_scenario(&scenarios[i], minutes);
+  }
+
+  deinit();
+}
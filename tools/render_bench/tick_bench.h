@@ -0,0 +1,5 @@
+#pragma once
+/*
+ * Runs the watchface of main.c in simulated time, see tick_bench.c
+ */
+void tick_bench_run(int minutes);
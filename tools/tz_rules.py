@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+#
+# Generates the time zone table of the alternate clock from the IANA tz database
+# of the host, with the UTC offset changes of each zone over a range of years.
+#
+# Command line example: python3 ./tools/tz_rules.py --first-year 2026 --years 12
+#
+# Writes src/c/tz_rules.c and src/pkjs/tz_zones.js, the zone ID sent by the phone
+# is the index of the zone name in the list plus one.
+
+import argparse
+import os
+from datetime import datetime, timezone
+from zoneinfo import ZoneInfo
+
+# the zones offered by the alternate clock, new zones must be added at the end
+# so that the zone IDs saved on the watches stay valid
+ZONES = [
+    'UTC',
+    'Pacific/Honolulu',
+    'America/Anchorage',
+    'America/Los_Angeles',
+    'America/Denver',
+    'America/Phoenix',
+    'America/Chicago',
+    'America/Mexico_City',
+    'America/New_York',
+    'America/Halifax',
+    'America/St_Johns',
+    'America/Sao_Paulo',
+    'America/Argentina/Buenos_Aires',
+    'Atlantic/Azores',
+    'Europe/London',
+    'Europe/Dublin',
+    'Europe/Lisbon',
+    'Europe/Paris',
+    'Europe/Berlin',
+    'Europe/Madrid',
+    'Europe/Rome',
+    'Europe/Amsterdam',
+    'Europe/Stockholm',
+    'Europe/Warsaw',
+    'Europe/Athens',
+    'Europe/Helsinki',
+    'Europe/Kiev',
+    'Europe/Istanbul',
+    'Europe/Moscow',
+    'Africa/Lagos',
+    'Africa/Cairo',
+    'Africa/Johannesburg',
+    'Africa/Nairobi',
+    'Asia/Jerusalem',
+    'Asia/Tehran',
+    'Asia/Dubai',
+    'Asia/Kabul',
+    'Asia/Karachi',
+    'Asia/Kolkata',
+    'Asia/Kathmandu',
+    'Asia/Dhaka',
+    'Asia/Yangon',
+    'Asia/Bangkok',
+    'Asia/Shanghai',
+    'Asia/Hong_Kong',
+    'Asia/Singapore',
+    'Asia/Tokyo',
+    'Asia/Seoul',
+    'Australia/Perth',
+    'Australia/Eucla',
+    'Australia/Darwin',
+    'Australia/Adelaide',
+    'Australia/Brisbane',
+    'Australia/Sydney',
+    'Australia/Lord_Howe',
+    'Pacific/Noumea',
+    'Pacific/Auckland',
+    'Pacific/Chatham',
+    'Pacific/Tongatapu',
+    'Pacific/Kiritimati',
+]
+
+DAY = 24 * 60 * 60
+
+
+def get_offset_minutes(zone, utc_time):
+    offset = datetime.fromtimestamp(utc_time, timezone.utc).astimezone(zone).utcoffset()
+    return int(offset.total_seconds()) // 60
+
+
+def find_transitions(zone, start, end):
+    """ Returns the offset at start, and the (UTC time, new offset) pairs until end """
+    initial_offset = get_offset_minutes(zone, start)
+    transitions = []
+    offset = initial_offset
+    day = start
+
+    # offsets don't change twice a day, so each change is searched in the day it happened
+    while day < end:
+        next_day = min(day + DAY, end)
+        next_offset = get_offset_minutes(zone, next_day)
+
+        if next_offset != offset:
+            low, high = day, next_day
+
+            while high - low > 1:
+                middle = (low + high) // 2
+
+                if get_offset_minutes(zone, middle) == offset:
+                    low = middle
+                else:
+                    high = middle
+
+            transitions.append((high, next_offset))
+            offset = next_offset
+
+        day = next_day
+
+    return initial_offset, transitions
+
+
+def generate_c(zones, first_year, last_year):
+    lines = [
+        '// generated by tools/tz_rules.py from the IANA tz database, do not edit',
+        '// the UTC offset changes from {} to the end of {}'.format(first_year, last_year),
+        '#include <pebble.h>',
+        '#include "tz_rules.h"',
+        '',
+        'const TzTransition tz_transitions[] = {',
+    ]
+
+    # zones with the same changes share their transitions
+    shared = {}
+    zone_lines = []
+    transition_count = 0
+
+    for name, initial_offset, transitions in zones:
+        key = tuple(transitions)
+
+        if key not in shared:
+            shared[key] = transition_count
+
+            if transitions:
+                lines.append('  // {}'.format(name))
+
+            for utc_time, offset in transitions:
+                lines.append('  {{ {}, {} }},'.format(utc_time, offset))
+
+            transition_count += len(transitions)
+
+        zone_lines.append('  {{ {}, {}, {} }}, // {}'.format(initial_offset, shared[key], len(transitions), name))
+
+    if transition_count == 0:
+        lines.append('  { 0, 0 }')
+
+    lines += ['};', '', 'const TzZone tz_zones[] = {'] + zone_lines + ['};', '']
+    lines.append('const uint8_t tz_zone_count = ARRAY_LENGTH(tz_zones);')
+
+    return '\n'.join(lines) + '\n'
+
+
+def generate_js(zones):
+    lines = [
+        '// generated by tools/tz_rules.py, the zone ID of a zone is its index plus one',
+        'module.exports = [',
+    ]
+    lines += ["  '{}',".format(name) for name, _, _ in zones]
+    lines.append('];')
+
+    return '\n'.join(lines) + '\n'
+
+
+def main():
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+
+    parser = argparse.ArgumentParser(description='Generate the time zone table of the alternate clock')
+    parser.add_argument('--first-year', type=int, default=2026)
+    parser.add_argument('--years', type=int, default=12)
+    parser.add_argument('--c-output', default=os.path.join(root, 'src', 'c', 'tz_rules.c'))
+    parser.add_argument('--js-output', default=os.path.join(root, 'src', 'pkjs', 'tz_zones.js'))
+    args = parser.parse_args()
+
+    last_year = args.first_year + args.years - 1
+    start = int(datetime(args.first_year, 1, 1, tzinfo=timezone.utc).timestamp())
+    end = int(datetime(last_year + 1, 1, 1, tzinfo=timezone.utc).timestamp())
+
+    zones = []
+
+    for name in ZONES:
+        initial_offset, transitions = find_transitions(ZoneInfo(name), start, end)
+        zones.append((name, initial_offset, transitions))
+
+    with open(args.c_output, 'w') as f:
+        f.write(generate_c(zones, args.first_year, last_year))
+
+    with open(args.js_output, 'w') as f:
+        f.write(generate_js(zones))
+
+
+if __name__ == '__main__':
+    main()